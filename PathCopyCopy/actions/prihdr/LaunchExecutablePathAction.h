@@ -51,6 +51,9 @@ namespace PCC
             void                    Act(const std::wstring& p_Paths,
                                         HWND p_hWnd) const override;
 
+            static std::wstring     InsertFilesInArguments(const std::wstring& p_Arguments,
+                                                           const std::wstring& p_Files);
+
         private:
             const std::wstring      m_Executable;   // Name of executable to launch.
             const std::wstring      m_Arguments;    // Arguments to pass to the executable.
@@ -22,13 +22,34 @@
 #include <stdafx.h>
 #include <LaunchExecutablePathAction.h>
 
+#include <algorithm>
 #include <fstream>
-#include <regex>
+#include <string_view>
 
 
 namespace
 {
-    const wchar_t* const    FILES_ARGUMENT_PLACEHOLDER  = L"%FILES%";   // Placeholder where to put file paths in arguments.
+    constexpr std::wstring_view
+                            FILES_ARGUMENT_PLACEHOLDER  = L"%FILES%";   // Placeholder where to put file paths in arguments.
+
+    //
+    // Finds the files placeholder in arguments, ignoring case.
+    //
+    // @param p_Arguments Arguments to look into.
+    // @return Position of first placeholder, or std::wstring::npos if not found.
+    //
+    size_t FindFilesArgumentPlaceholder(const std::wstring& p_Arguments) noexcept
+    {
+        // Placeholder contains only uppercase ASCII letters and symbols,
+        // so lowercase ASCII letters are the only ones to convert.
+        const auto it = std::search(p_Arguments.cbegin(), p_Arguments.cend(),
+                                    FILES_ARGUMENT_PLACEHOLDER.cbegin(), FILES_ARGUMENT_PLACEHOLDER.cend(),
+                                    [](const wchar_t p_ArgumentChar, const wchar_t p_PlaceholderChar) noexcept {
+                                        const bool isLower = p_ArgumentChar >= L'a' && p_ArgumentChar <= L'z';
+                                        return (isLower ? p_ArgumentChar - (L'a' - L'A') : p_ArgumentChar) == p_PlaceholderChar;
+                                    });
+        return it != p_Arguments.cend() ? static_cast<size_t>(it - p_Arguments.cbegin()) : std::wstring::npos;
+    }
 
 } // anonymous namespace
 
@@ -95,19 +116,7 @@ namespace PCC
                 }
             }
 
-            // Look for files placeholder in arguments. If it's not there, append the files.
-            auto arguments{m_Arguments};
-            std::wregex placeholderRegex(FILES_ARGUMENT_PLACEHOLDER,
-                                         std::regex_constants::ECMAScript | std::regex_constants::icase);
-            std::wsmatch match;
-            if (std::regex_search(arguments, match, placeholderRegex)) {
-                arguments = match.prefix().str() + files + match.suffix().str();
-            } else {
-                if (arguments.empty() || arguments.back() != L' ') {
-                    arguments += L' ';
-                }
-                arguments += files;
-            }
+            const auto arguments = InsertFilesInArguments(m_Arguments, files);
 
             // Need reinterpret_cast here because of legacy Win32 API
             [[gsl::suppress(type.1)]]
@@ -124,6 +133,32 @@ namespace PCC
             }
         }
 
+        //
+        // Inserts files in the arguments to pass to an executable. If arguments
+        // contain the files placeholder, it is replaced by the files (only the
+        // first one is replaced); otherwise, files are appended to arguments.
+        //
+        // @param p_Arguments Arguments to pass to the executable.
+        // @param p_Files File or files to insert, pre-bundled in a single string.
+        // @return Arguments containing the files.
+        //
+        std::wstring LaunchExecutablePathAction::InsertFilesInArguments(const std::wstring& p_Arguments,
+                                                                        const std::wstring& p_Files)
+        {
+            // Look for files placeholder in arguments. If it's not there, append the files.
+            auto arguments{p_Arguments};
+            const auto placeholderPos = FindFilesArgumentPlaceholder(arguments);
+            if (placeholderPos != std::wstring::npos) {
+                arguments.replace(placeholderPos, FILES_ARGUMENT_PLACEHOLDER.size(), p_Files);
+            } else {
+                if (arguments.empty() || arguments.back() != L' ') {
+                    arguments += L' ';
+                }
+                arguments += p_Files;
+            }
+            return arguments;
+        }
+
         //
         // Returns a textual description of the exception.
         //
@@ -57,12 +57,14 @@
 #define IDS_INVALIDPIPELINE_LOOP_DETECTED 152
 #define IDS_INVALIDPIPELINE_POSSIBLE_DOWNGRADE 153
 #define IDS_INVALIDPIPELINE_BASE_COMMAND_NOT_FOUND 154
+#define IDS_INVALIDPIPELINE_INVALID_REGEX 155
+#define IDS_INVALIDPIPELINE_PREFIX_MAP_FILE 156
 
 // Next default values for new objects
 // 
 #ifdef APSTUDIO_INVOKED
 #ifndef APSTUDIO_READONLY_SYMBOLS
-#define _APS_NEXT_RESOURCE_VALUE        155
+#define _APS_NEXT_RESOURCE_VALUE        157
 #define _APS_NEXT_COMMAND_VALUE         40001
 #define _APS_NEXT_CONTROL_VALUE         1001
 #define _APS_NEXT_SYMED_VALUE           104
@@ -23,6 +23,7 @@
 
 #include <PathCopyCopyPrivateTypes.h>
 #include <Plugin.h>
+#include <PluginPipeline.h>
 
 #include <optional>
 
@@ -45,6 +46,9 @@ namespace PCC
                                                        const std::wstring& p_PluginIconFile,
                                                        bool p_UseDefaultIcon,
                                                        const std::wstring& p_EncodedElements);
+                                        PipelinePlugin(const GUID& p_PluginId,
+                                                       const std::wstring& p_PluginDescription,
+                                                       const PipelineSP& p_spPipeline);
                                         PipelinePlugin(const PipelinePlugin&) = delete;
             PipelinePlugin&             operator=(const PipelinePlugin&) = delete;
 
@@ -60,6 +64,7 @@ namespace PCC
                                                 const std::wstring& p_File) const override;
 
             std::wstring                GetPath(const std::wstring& p_File) const override;
+            void                        GetPaths(gsl::span<std::wstring> p_Files) const override;
             std::wstring                PathsSeparator() const override;
             bool                        CopyPathsRecursively() const override;
 
@@ -70,15 +75,21 @@ namespace PCC
             bool                        ShowForFiles() const noexcept(false) override;
             bool                        ShowForFolders() const noexcept(false) override;
 
+            void                        SetPluginProvider(const PluginProvider* p_pPluginProvider) noexcept override;
+
         private:
             const GUID                  m_Id;               // Plugin ID.
             const std::wstring          m_Description;      // Plugin description.
             const std::wstring          m_IconFile;         // Plugin icon file.
             const bool                  m_UseDefaultIcon;   // Whether to use default icon for plugin.
             const std::wstring          m_EncodedElements;  // Pipeline encoded elements.
+            const PipelineSP            m_spPrebuiltPipeline; // Pre-built pipeline to use instead of decoding elements, if any.
             mutable std::optional<PipelineSP>
                                         m_spPipeline;       // Pipeline to execute on each path received.
             mutable std::string         m_PipelineError;    // If pipeline failed to load, can contain the error message.
+            mutable PipelineOptions     m_PipelineOptions;  // Pipeline options, computed when pipeline is loaded.
+
+            const PipelineOptions*      GetPipelineOptions() const;
         };
 
     } // namespace Plugins
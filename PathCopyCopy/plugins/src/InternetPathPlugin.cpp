@@ -22,9 +22,7 @@
 
 #include <stdafx.h>
 #include <InternetPathPlugin.h>
-
-#include <algorithm>
-#include <sstream>
+#include <StringUtils.h>
 
 
 namespace
@@ -32,8 +30,6 @@ namespace
     const wchar_t* const NETWORK_SHARE_PREFIX       = L"\\\\";      // Prefix of string for network share paths
     const wchar_t* const FILE_URI_PREFIX            = L"file:///";  // Prefix of file URI paths
     const wchar_t* const NETWORK_FILE_URI_PREFIX    = L"file://";   // Prefix of network file URI paths
-    const wchar_t* const WHITESPACE_TO_ESCAPE       = L"\t\r ";     // Whitespace to escape in internet paths
-    const wchar_t* const WHITESPACE_ESCAPE_SEQ      = L"%20";       // Escape sequence to use instead of whitespace
 
     // Plugin unique ID: {8F2ADCCC-9693-407d-9300-FCCB9A12B982}
     const GUID INTERNET_PATH_PLUGIN_ID = { 0x8f2adccc, 0x9693, 0x407d, { 0x93, 0x0, 0xfc, 0xcb, 0x9a, 0x12, 0xb9, 0x82 } };
@@ -100,20 +96,10 @@ namespace PCC
             }
 
             // Now switch backslashes to slashes.
-            std::replace(path.begin(), path.end(), L'\\', L'/');
-
-            // Switch whitespace for %20.
-            std::wstringstream newPathSS;
-            std::wstring::size_type oldPos = 0, whitespacePos = path.find_first_of(WHITESPACE_TO_ESCAPE);
-            while (whitespacePos != std::wstring::npos) {
-                newPathSS << path.substr(oldPos, whitespacePos - oldPos) << WHITESPACE_ESCAPE_SEQ;
-                oldPos = whitespacePos + 1;
-                whitespacePos = path.find_first_of(WHITESPACE_TO_ESCAPE, oldPos);
-            }
-            if (oldPos < path.size()) {
-                newPathSS << path.substr(oldPos, path.size() - oldPos);
-            }
-            path = newPathSS.str();
+            StringUtils::ReplaceChar(path, L'\\', L'/');
+
+            // Percent-encode characters that are not allowed in URIs (including whitespace).
+            StringUtils::EncodeURICharacters(path, StringUtils::EncodeParam::RFC3986);
 
             return path;
         }
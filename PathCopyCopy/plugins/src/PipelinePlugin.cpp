@@ -25,6 +25,7 @@
 #include <PluginPipelineDecoder.h>
 #include <LaunchExecutablePathAction.h>
 
+#include <algorithm>
 #include <assert.h>
 
 
@@ -52,8 +53,34 @@ namespace PCC
               m_IconFile(p_PluginIconFile),
               m_UseDefaultIcon(p_UseDefaultIcon),
               m_EncodedElements(p_EncodedElements),
+              m_spPrebuiltPipeline(),
               m_spPipeline(),
-              m_PipelineError()
+              m_PipelineError(),
+              m_PipelineOptions()
+        {
+        }
+
+        //
+        // Constructor with a pre-built pipeline. Used to run pipelines
+        // that are not encoded in the settings, like in tests.
+        //
+        // @param p_PluginId ID of this pipeline plugin.
+        // @param p_PluginDescription Description of the pipeline plugin.
+        // @param p_spPipeline Pipeline to execute on each path received.
+        //
+        PipelinePlugin::PipelinePlugin(const GUID& p_PluginId,
+                                       const std::wstring& p_PluginDescription,
+                                       const PipelineSP& p_spPipeline)
+            : Plugin(),
+              m_Id(p_PluginId),
+              m_Description(p_PluginDescription),
+              m_IconFile(),
+              m_UseDefaultIcon(false),
+              m_EncodedElements(),
+              m_spPrebuiltPipeline(p_spPipeline),
+              m_spPipeline(),
+              m_PipelineError(),
+              m_PipelineOptions()
         {
         }
 
@@ -70,7 +97,9 @@ namespace PCC
         {
             if (!m_spPipeline.has_value()) {
                 try {
-                    PipelineSP spPipeline = std::make_shared<Pipeline>(m_EncodedElements);
+                    PipelineSP spPipeline = m_spPrebuiltPipeline != nullptr
+                        ? m_spPrebuiltPipeline
+                        : std::make_shared<Pipeline>(m_EncodedElements, m_Id);
 
                     // Make sure pipeline is valid.
                     GUIDS sSeenPluginIds;
@@ -80,16 +109,35 @@ namespace PCC
                     }
                     spPipeline->Validate(m_pPluginProvider, rsSeenPluginIds);
 
+                    // Pipeline options cannot change, so compute them once.
+                    PipelineOptions options;
+                    spPipeline->ModifyOptions(options);
+                    m_PipelineOptions = std::move(options);
+
                     m_spPipeline = spPipeline;
                     m_PipelineError.clear();
                 } catch (const std::exception& e) {
                     m_spPipeline = std::make_optional<PipelineSP>(nullptr);
                     m_PipelineError = e.what();
                 }
+            } else if (m_spPipeline.value() != nullptr) {
+                // Our plugin provider might have changed since pipeline was validated.
+                m_spPipeline.value()->BindPlugins(m_pPluginProvider);
             }
             return m_spPipeline.value().get();
         }
 
+        //
+        // Returns the options of the pipeline we're using. They are computed
+        // once when the pipeline is initialized.
+        //
+        // @return Pointer to pipeline options, or nullptr if our pipeline is invalid.
+        //
+        const PipelineOptions* PipelinePlugin::GetPipelineOptions() const
+        {
+            return GetPipeline() != nullptr ? &m_PipelineOptions : nullptr;
+        }
+
         //
         // Returns any error message retrieved when this plugin's pipeline
         // has been loaded. Call this if GetPipeline returns nullptr to
@@ -177,6 +225,23 @@ namespace PCC
             return modifiedPath;
         }
 
+        //
+        // Modifies a batch of paths using all elements in our pipeline.
+        // The pipeline is fetched once and applied to all paths in one call.
+        //
+        // @param p_Files Paths of files to modify. Will be modified in-place.
+        //
+        void PipelinePlugin::GetPaths(const gsl::span<std::wstring> p_Files) const
+        {
+            const Pipeline* pPipeline = GetPipeline();
+            if (pPipeline != nullptr) {
+                pPipeline->ModifyPaths(p_Files, m_pPluginProvider);
+            } else if (!m_PipelineError.empty()) {
+                const std::wstring error = ATL::CStringW(m_PipelineError.c_str()).GetString();
+                std::fill(p_Files.begin(), p_Files.end(), error);
+            }
+        }
+
         //
         // Returns the separator to use between each path when using this plugin.
         // The default value is the empty string, which instructs PCC to use the
@@ -188,11 +253,9 @@ namespace PCC
         {
             // This is stored in pipeline options.
             std::wstring separator;
-            const Pipeline* pPipeline = GetPipeline();
-            if (pPipeline != nullptr) {
-                PipelineOptions options;
-                pPipeline->ModifyOptions(options);
-                separator = options.GetPathsSeparator();
+            const PipelineOptions* pOptions = GetPipelineOptions();
+            if (pOptions != nullptr) {
+                separator = pOptions->GetPathsSeparator();
             }
             return separator;
         }
@@ -207,11 +270,9 @@ namespace PCC
         {
             // This is stored in pipeline options.
             bool recursively = Plugin::CopyPathsRecursively();
-            const Pipeline* pPipeline = GetPipeline();
-            if (pPipeline != nullptr) {
-                PipelineOptions options;
-                pPipeline->ModifyOptions(options);
-                recursively = options.GetCopyPathsRecursively();
+            const PipelineOptions* pOptions = GetPipelineOptions();
+            if (pOptions != nullptr) {
+                recursively = pOptions->GetCopyPathsRecursively();
             }
             return recursively;
         }
@@ -226,13 +287,11 @@ namespace PCC
             // Pipeline options can modify the behavior.
             std::wstring executable, arguments;
             bool useFilelist = false;
-            const Pipeline* pPipeline = GetPipeline();
-            if (pPipeline != nullptr) {
-                PipelineOptions options;
-                pPipeline->ModifyOptions(options);
-                executable = options.GetExecutable();
-                arguments = options.GetArguments();
-                useFilelist = options.GetUseFilelist();
+            const PipelineOptions* pOptions = GetPipelineOptions();
+            if (pOptions != nullptr) {
+                executable = pOptions->GetExecutable();
+                arguments = pOptions->GetArguments();
+                useFilelist = pOptions->GetUseFilelist();
             }
             
             PCC::PathActionSP spAction;
@@ -270,11 +329,9 @@ namespace PCC
         {
             // This is stored in pipeline options.
             bool showForFiles = Plugin::ShowForFiles();
-            const Pipeline* pPipeline = GetPipeline();
-            if (pPipeline != nullptr) {
-                PipelineOptions options;
-                pPipeline->ModifyOptions(options);
-                showForFiles = options.GetShowForFiles();
+            const PipelineOptions* pOptions = GetPipelineOptions();
+            if (pOptions != nullptr) {
+                showForFiles = pOptions->GetShowForFiles();
             }
             return showForFiles;
         }
@@ -288,15 +345,28 @@ namespace PCC
         {
             // This is stored in pipeline options.
             bool showForFolders = Plugin::ShowForFolders();
-            const Pipeline* pPipeline = GetPipeline();
-            if (pPipeline != nullptr) {
-                PipelineOptions options;
-                pPipeline->ModifyOptions(options);
-                showForFolders = options.GetShowForFolders();
+            const PipelineOptions* pOptions = GetPipelineOptions();
+            if (pOptions != nullptr) {
+                showForFolders = pOptions->GetShowForFolders();
             }
             return showForFolders;
         }
 
+        //
+        // Sets the object used to access other plugins. Since our pipeline
+        // keeps plugins it applies bound to the previous provider, we need
+        // to unbind them; pipeline will be re-bound when it is next used.
+        //
+        // @param p_pPluginProvider Object to access other plugins.
+        //
+        void PipelinePlugin::SetPluginProvider(const PluginProvider* const p_pPluginProvider) noexcept
+        {
+            Plugin::SetPluginProvider(p_pPluginProvider);
+            if (m_spPipeline.has_value() && m_spPipeline.value() != nullptr) {
+                m_spPipeline.value()->UnbindPlugins();
+            }
+        }
+
     } // namespace Plugins
 
 } // namespace PCC
@@ -21,8 +21,7 @@
 
 #include <stdafx.h>
 #include <UnixPathPlugin.h>
-
-#include <algorithm>
+#include <StringUtils.h>
 
 
 namespace
@@ -67,7 +66,7 @@ namespace PCC
             std::wstring path = LongPathPlugin::GetPath(p_File);
 
             // Replace all backslashes with forward slashes and return the path.
-            std::replace(path.begin(), path.end(), L'\\', L'/');
+            StringUtils::ReplaceChar(path, L'\\', L'/');
             return path;
         }
 
@@ -0,0 +1,81 @@
+// CachedFileSystem.h
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include "FileSystem.h"
+#include "ReparsePointCache.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace PCC
+{
+    //
+    // CachedFileSystem
+    //
+    // File system wrapper that remembers the attributes returned by another
+    // file system. During a single menu operation, the same paths (selected
+    // files and their parents) are looked at many times: to know if files or
+    // folders are selected, by plugins appending separators to folders, while
+    // looking for symlinks, etc. Installing a cached file system for the
+    // duration of the operation (see StCurrentFileSystem) hits the actual
+    // file system only once per path.
+    //
+    // Symlinks are followed through a ReparsePointCache, so that selecting
+    // many files in the same folder checks the folder's parents only once.
+    //
+    // Since files can change between operations, the cache should be cleared
+    // at the beginning of each operation. Folder contents are not cached,
+    // since they are only needed once per operation.
+    //
+    class CachedFileSystem final : public FileSystem
+    {
+    public:
+        explicit        CachedFileSystem(const FileSystem& p_FileSystem);
+
+        void            Clear() noexcept;
+
+        const ReparsePointCache::Stats&
+                        GetReparsePointStats() const noexcept;
+
+        virtual DWORD   GetAttributes(const std::wstring& p_Path) const override;
+        virtual bool    GetFinalPath(const std::wstring& p_Path,
+                                     std::wstring& p_rFinalPath) const override;
+        virtual void    EnumerateFolder(const std::wstring& p_FolderPath,
+                                        std::vector<std::wstring>& p_rvNames) const override;
+        virtual bool    FollowSymlinks(const std::wstring& p_Path,
+                                       std::wstring& p_rFinalPath) const override;
+
+    private:
+        typedef std::unordered_map<std::wstring, DWORD> AttributesM;
+
+        const FileSystem&
+                        m_FileSystem;           // File system whose results we cache.
+        mutable AttributesM
+                        m_mAttributes;          // Cached attributes, by path.
+        mutable ReparsePointCache
+                        m_ReparsePoints;        // Cached reparse points and their targets.
+    };
+
+} // namespace PCC
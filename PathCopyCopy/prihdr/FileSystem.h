@@ -0,0 +1,96 @@
+// FileSystem.h
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <windows.h>
+
+
+namespace PCC
+{
+    //
+    // FileSystem
+    //
+    // Interface for an object that can query the file system. Code looking
+    // at files (plugins, pipeline elements, etc.) should go through the file
+    // system returned by FileSystem::Current instead of calling Win32 directly;
+    // this way, a menu operation can install a caching file system for its
+    // duration (see CachedFileSystem and StCurrentFileSystem) and tests can
+    // install a fake one (see FakeFileSystem in PathCopyCopyTests).
+    //
+    class FileSystem
+    {
+    public:
+                        FileSystem() = default;
+                        FileSystem(const FileSystem&) = delete;
+                        FileSystem(FileSystem&&) = delete;
+        FileSystem&     operator=(const FileSystem&) = delete;
+        FileSystem&     operator=(FileSystem&&) = delete;
+        virtual         ~FileSystem() = default;
+
+                        //
+                        // Returns the attributes of a file or folder, like GetFileAttributesW.
+                        //
+                        // @param p_Path Path of file or folder.
+                        // @return Attributes of file or folder, or INVALID_FILE_ATTRIBUTES
+                        //         if it does not exist or cannot be accessed.
+                        //
+        virtual DWORD   GetAttributes(const std::wstring& p_Path) const = 0;
+
+                        //
+                        // Returns the final path of a file or folder, once all symlinks
+                        // in the path have been followed. The path is returned in the
+                        // same form as GetFinalPathNameByHandleW would, e.g. "\\?\C:\Foo".
+                        //
+                        // @param p_Path Path of file or folder.
+                        // @param p_rFinalPath Where to store the final path.
+                        // @return true if the final path could be determined.
+                        //
+        virtual bool    GetFinalPath(const std::wstring& p_Path,
+                                     std::wstring& p_rFinalPath) const = 0;
+
+                        //
+                        // Lists the names of the files and folders contained in a folder,
+                        // except for the "." and ".." entries.
+                        //
+                        // @param p_FolderPath Path of folder.
+                        // @param p_rvNames Where to add the names of the folder's content.
+                        //
+        virtual void    EnumerateFolder(const std::wstring& p_FolderPath,
+                                        std::vector<std::wstring>& p_rvNames) const = 0;
+
+        virtual bool    FollowSymlinks(const std::wstring& p_Path,
+                                       std::wstring& p_rFinalPath) const;
+
+        bool            Exists(const std::wstring& p_Path) const;
+        bool            IsDirectory(const std::wstring& p_Path) const;
+        bool            IsReparsePoint(const std::wstring& p_Path) const;
+
+        static FileSystem&
+                        Current() noexcept;
+        static FileSystem*
+                        SetCurrent(FileSystem* p_pFileSystem) noexcept;
+    };
+
+} // namespace PCC
@@ -0,0 +1,118 @@
+// NetworkShareIndex.h
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <StHandle.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <atlbase.h>
+#include <windows.h>
+
+
+namespace PCC
+{
+    //
+    // NetworkShareIndex
+    //
+    // Index of the network shares of a computer, used to find the share
+    // containing a local path. Share paths are compiled into a
+    // case-insensitive trie, so the cost of looking up a path depends on
+    // its length and not on the number of shares.
+    //
+    // The index of the local computer's shares is built from the registry
+    // and kept in memory until the registry reports that shares changed;
+    // see GetLocalShares.
+    //
+    class NetworkShareIndex final
+    {
+    public:
+        // Info about a network share.
+        struct Share {
+            std::wstring    m_Name;             // Name of share, like "Docs" in \\computer\Docs.
+            std::wstring    m_Path;             // Local path of share, like "C:\Docs".
+            bool            m_Hidden = false;   // Whether share is hidden (its name ends with '$').
+
+                            Share() = default;
+                            Share(std::wstring p_Name,
+                                  std::wstring p_Path);
+        };
+        typedef std::vector<Share> ShareV;
+
+                        NetworkShareIndex() = default;
+        explicit        NetworkShareIndex(ShareV p_vShares);
+                        NetworkShareIndex(const NetworkShareIndex&) = delete;
+        NetworkShareIndex&
+                        operator=(const NetworkShareIndex&) = delete;
+
+        size_t          GetNumShares() const noexcept;
+        const Share*    Find(std::wstring_view p_Path,
+                             bool p_UseHiddenShares) const noexcept;
+
+        static std::shared_ptr<const NetworkShareIndex>
+                        GetLocalShares();
+
+    private:
+        //
+        // Node of the trie. Each node represents a prefix of one or more
+        // share paths. Transitions of all nodes are stored together,
+        // sorted by character for each node.
+        //
+        struct Node {
+            uint32_t    m_FirstTransition = 0;          // Index of node's first transition.
+            uint32_t    m_NumTransitions = 0;           // Number of transitions of node.
+            uint32_t    m_Share = NO_SHARE;             // Index of first share with this path, or NO_SHARE.
+            uint32_t    m_VisibleShare = NO_SHARE;      // Index of first non-hidden share with this path, or NO_SHARE.
+        };
+
+        static constexpr uint32_t
+                        NO_SHARE = UINT32_MAX;      // Value used for nodes that are not share paths.
+
+        ShareV          m_vShares;                  // Shares in the index.
+        std::vector<Node>
+                        m_vNodes;                   // Nodes of the trie. First node is the root.
+        std::wstring    m_TransitionChars;          // Uppercase character of each transition.
+        std::vector<uint32_t>
+                        m_vTransitionNodes;         // Target node of each transition.
+
+        static std::mutex
+                        s_LocalSharesLock;          // Mutex held while loading the local shares index.
+        static std::shared_ptr<const NetworkShareIndex>
+                        s_spLocalShares;            // Index of local shares, if loaded. Accessed atomically.
+        static ATL::CRegKey
+                        s_LocalSharesKey;           // Registry key storing shares, kept open to be notified of changes.
+        static StHandle s_LocalSharesChangedEvent;  // Event signaled by the registry when shares change.
+        static std::atomic<bool>
+                        s_LocalSharesWatched;       // Whether s_LocalSharesChangedEvent is registered for changes.
+
+        static bool     LocalSharesChanged() noexcept;
+        static bool     WatchLocalShares() noexcept;
+        static ShareV   LoadLocalShares(ATL::CRegKey& p_rSharesKey);
+    };
+
+} // namespace PCC
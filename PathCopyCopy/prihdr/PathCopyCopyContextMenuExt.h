@@ -22,6 +22,7 @@
 #pragma once
 
 #include <PathCopyCopy_i.h>
+#include "CachedFileSystem.h"
 #include "PathCopyCopyPrivateTypes.h"
 #include "Plugin.h"
 #include "resource.h"
@@ -134,6 +135,8 @@ private:
     PCC::FilesV         m_vFiles;                   // Files selected in Shell.
     bool                m_FilesSelected;            // Whether files have been selected.
     bool                m_FoldersSelected;          // Whether folders have been selected.
+    PCC::CachedFileSystem
+                        m_FileSystem;               // File system caching file attributes during a menu operation.
 
     std::optional<UINT_PTR>
                         m_FirstCmdId;               // ID of first command menu item.
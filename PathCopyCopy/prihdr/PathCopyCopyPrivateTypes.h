@@ -77,6 +77,9 @@ namespace PCC
     typedef std::shared_ptr<Settings>           SettingsSP;             // Shared pointer to a settings object.
 
     typedef std::vector<std::wstring>           WStringV;               // Vector of strings.
+    typedef std::pair<std::wstring, std::wstring>
+                                                WStringPair;            // Pair of strings.
+    typedef std::vector<WStringPair>            WStringPairV;           // Vector of pairs of strings.
     typedef std::vector<GUID>                   GUIDV;                  // Vector of GUIDs.
     typedef std::set<GUID, GUIDLess>            GUIDS;                  // Set of GUIDs.
     typedef GUIDV                               CLSIDV;                 // Vector of class IDs (e.g. GUIDs).
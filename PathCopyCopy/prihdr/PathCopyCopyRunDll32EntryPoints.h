@@ -46,4 +46,8 @@ extern "C"
                                       HINSTANCE p_hDllInstance,
                                       LPWSTR p_pCmdLine,
                                       int p_ShowCmd);
+    void CALLBACK ProfilePipelinePluginW(HWND p_hWnd,
+                                         HINSTANCE p_hDllInstance,
+                                         LPWSTR p_pCmdLine,
+                                         int p_ShowCmd);
 };
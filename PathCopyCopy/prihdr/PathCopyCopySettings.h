@@ -76,6 +76,7 @@ namespace PCC
         bool            GetCopyPathsRecursively() const;
         std::wstring    GetPathsSeparator() const;
         bool            GetTrueLnkPaths() const;
+        bool            GetPreserveSelectionOrder() const;
         std::wstring    GetWSLPathPrefix() const;
         bool            GetCtrlKeyPlugin(GUID& p_rPluginId) const;
         bool            GetMainMenuPluginDisplayOrder(GUIDV& p_rvPluginIds) const;
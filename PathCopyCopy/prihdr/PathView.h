@@ -0,0 +1,219 @@
+// PathView.h
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+namespace PCC
+{
+    //
+    // PathView
+    //
+    // Index of the structure of a path: its root, its parts (the non-empty
+    // strings between separators), its parents and its file extension.
+    // The path is parsed once, after which all parts of its structure can
+    // be looked up in constant time. Both backslashes and forward slashes
+    // are considered separators.
+    //
+    // A PathView refers to the path it parsed; the path must remain alive
+    // and unmodified while the view is used. See PathViewCache.
+    //
+    class PathView final
+    {
+    public:
+        // Kinds of root a path can have
+        enum class RootKind {
+            Relative,   // No root, like "foo\bar"
+            Drive,      // Drive letter, like "C:" or "C:\"
+            Rooted,     // Single separator, for paths relative to the current drive
+            UNC,        // UNC server and share, like "\\server\share\"
+            Prefixed,   // "\\?\" or "\\.\" prefix, like "\\?\C:\" or "\\?\UNC\server\share\"
+        };
+
+        //
+        // Lazy range of the parents of a path, from the closest to the
+        // farthest, like PathView::Parent returns them. Parents are views
+        // on the beginning of the path, found as the range is iterated
+        // without parsing the whole path or copying it. The path must
+        // remain alive while the range is used.
+        //
+        class ParentRange final
+        {
+        public:
+            class Iterator final
+            {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type        = std::wstring_view;
+                using difference_type   = std::ptrdiff_t;
+                using pointer           = const std::wstring_view*;
+                using reference         = std::wstring_view;
+
+                        Iterator() noexcept = default;
+                explicit Iterator(const std::wstring_view p_Path) noexcept
+                            : m_Path(p_Path),
+                              m_Size(p_Path.size())
+                        {
+                            Advance();
+                        }
+
+                std::wstring_view
+                        operator*() const noexcept
+                        {
+                            return m_Path.substr(0, m_Size);
+                        }
+                Iterator&
+                        operator++() noexcept
+                        {
+                            Advance();
+                            return *this;
+                        }
+                Iterator
+                        operator++(int) noexcept
+                        {
+                            Iterator prev(*this);
+                            ++*this;
+                            return prev;
+                        }
+
+                bool    operator==(const Iterator& p_Other) const noexcept
+                        {
+                            return m_Size == p_Other.m_Size;
+                        }
+                bool    operator!=(const Iterator& p_Other) const noexcept
+                        {
+                            return !(*this == p_Other);
+                        }
+
+            private:
+                std::wstring_view
+                        m_Path;                                 // Path whose parents to iterate.
+                size_t  m_Size = std::wstring_view::npos;       // Size of current parent, or npos at end of range.
+
+                void    Advance() noexcept
+                        {
+                            // Truncate at the last separator, like PluginUtils::ExtractFolderFromPath;
+                            // stop once truncating does not change the parent anymore.
+                            const size_t separatorPos = m_Size > 0 ? m_Path.find_last_of(L"\\/", m_Size - 1) : std::wstring_view::npos;
+                            const size_t parentSize = separatorPos != std::wstring_view::npos ? GetParentSize(separatorPos) : m_Size;
+                            m_Size = parentSize != m_Size ? parentSize : std::wstring_view::npos;
+                        }
+            };
+
+            explicit    ParentRange(const std::wstring_view p_Path) noexcept
+                            : m_Path(p_Path)
+                        {
+                        }
+
+            Iterator    begin() const noexcept
+                        {
+                            return Iterator(m_Path);
+                        }
+            Iterator    end() const noexcept
+                        {
+                            return Iterator();
+                        }
+
+        private:
+            std::wstring_view
+                        m_Path;         // Path whose parents to iterate.
+        };
+
+                        PathView() noexcept = default;
+        explicit        PathView(std::wstring_view p_Path);
+                        PathView(const PathView&) = default;
+        PathView&       operator=(const PathView&) = default;
+
+        void            Parse(std::wstring_view p_Path);
+
+        std::wstring_view
+                        Path() const noexcept;
+        RootKind        GetRootKind() const noexcept;
+        size_t          RootSize() const noexcept;
+        wchar_t         FirstSeparator() const noexcept;
+
+        size_t          NumParts() const noexcept;
+        std::wstring_view
+                        Part(size_t p_Index) const noexcept;
+        std::wstring_view
+                        SeparatorsBefore(size_t p_Index) const noexcept;
+
+        size_t          NumParents() const noexcept;
+        std::wstring_view
+                        Parent(size_t p_Index) const noexcept;
+
+        size_t          ExtensionPos() const noexcept;
+
+        static ParentRange
+                        Parents(std::wstring_view p_Path) noexcept;
+        static bool     IsSeparator(wchar_t p_Char) noexcept;
+        static size_t   GetRootSize(std::wstring_view p_Path) noexcept;
+        static size_t   GetParentSize(size_t p_SeparatorPos) noexcept;
+
+    private:
+        std::wstring_view
+                        m_Path;                     // Path that was parsed.
+        RootKind        m_RootKind = RootKind::Relative;    // Kind of path root.
+        size_t          m_RootSize = 0;             // Size of root, including separator following it.
+        wchar_t         m_FirstSeparator = L'\0';   // First separator found in path, or L'\0' if there are none.
+        std::vector<std::pair<size_t, size_t>>
+                        m_vParts;                   // Beginning and end of each part.
+        std::vector<size_t>
+                        m_vParentSizes;             // Size of each parent, closest parent first.
+        size_t          m_ExtensionPos = std::wstring_view::npos;   // Position of extension's dot, or npos.
+
+        static RootKind ParseRoot(std::wstring_view p_Path,
+                                  size_t& p_rRootSize) noexcept;
+    };
+
+    //
+    // PathViewCache
+    //
+    // Keeps the PathView of the last path that was looked up, so that
+    // elements of a pipeline looking at the structure of the same path
+    // only parse it once. The view refers to the path itself; whoever
+    // modifies the path must call Invalidate, since the cache only checks
+    // that the path's data and size are the same. Views returned remain
+    // valid until the path is modified or the next call to Get.
+    //
+    class PathViewCache final
+    {
+    public:
+                        PathViewCache() = default;
+                        PathViewCache(const PathViewCache&) = delete;
+        PathViewCache&  operator=(const PathViewCache&) = delete;
+
+        const PathView& Get(const std::wstring& p_Path);
+        void            Invalidate() noexcept;
+
+    private:
+        PathView        m_View;             // View of path that was parsed.
+        bool            m_Valid = false;    // Whether m_View is up-to-date.
+    };
+
+} // namespace PCC
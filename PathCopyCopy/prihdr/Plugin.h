@@ -30,6 +30,8 @@
 #include <vector>
 #include <utility>
 
+#include <gsl/span>
+
 #include <windows.h>
 
 
@@ -82,6 +84,7 @@ namespace PCC
                                     // @return Path of the file according to plugin.
                                     //
         virtual std::wstring        GetPath(const std::wstring& p_File) const = 0;
+        virtual void                GetPaths(gsl::span<std::wstring> p_Files) const;
         virtual std::wstring        PathsSeparator() const;
         virtual bool                CopyPathsRecursively() const noexcept(false);
 
@@ -94,7 +97,7 @@ namespace PCC
         virtual bool                ShowForFolders() const noexcept(false);
 
         void                        SetSettings(const Settings* p_pSettings) noexcept;
-        void                        SetPluginProvider(const PluginProvider* p_pPluginProvider) noexcept;
+        virtual void                SetPluginProvider(const PluginProvider* p_pPluginProvider) noexcept;
 
     protected:
         const Settings*             m_pSettings = nullptr;          // Optional object to access PCC settings.
@@ -22,12 +22,17 @@
 #pragma once
 
 #include "PathCopyCopyPrivateTypes.h"
+#include "PluginPipelineProgram.h"
+#include "PluginPipelineStack.h"
 #include "PluginProvider.h"
 
+#include <atomic>
+#include <cstdint>
 #include <exception>
-#include <stack>
 #include <string>
 
+#include <gsl/span>
+
 
 namespace PCC
 {
@@ -85,23 +90,49 @@ namespace PCC
     {
     public:
         explicit        Pipeline(const PipelineElementSPV& p_vspElements);
-        explicit        Pipeline(const std::wstring& p_EncodedElements);
+        explicit        Pipeline(const std::wstring& p_EncodedElements,
+                                 const GUID& p_PluginId = GUID_NULL);
                         Pipeline(const Pipeline&) = delete;
         Pipeline&       operator=(const Pipeline&) = delete;
 
         void            Validate(const PluginProvider* p_pPluginProvider,
                                  GUIDS& p_rsSeenPluginIds) const;
+        void            BindPlugins(const PluginProvider* p_pPluginProvider) const;
+        void            UnbindPlugins() const noexcept;
 
         void            ModifyPath(std::wstring& p_rPath,
                                    const PluginProvider* p_pPluginProvider) const;
+        void            ModifyPaths(gsl::span<std::wstring> p_Paths,
+                                    const PluginProvider* p_pPluginProvider) const;
         void            ModifyOptions(PipelineOptions& p_rOptions) const;
         bool            ShouldBeEnabledFor(const std::wstring& p_ParentPath,
                                            const std::wstring& p_File,
                                            const PluginProvider* p_pPluginProvider) const;
 
+        const PipelineProgram&
+                        GetProgram() const noexcept;
+
+        static bool     GetVerificationMode() noexcept;
+        static void     SetVerificationMode(bool p_Verify) noexcept;
+        static uint64_t GetNumVerificationFailures() noexcept;
+
     private:
+        static std::atomic<bool>
+                        s_VerificationMode;     // Whether to verify optimized pipelines.
+        static std::atomic<uint64_t>
+                        s_NumVerificationFailures; // Number of paths for which verification failed.
+
         const PipelineElementSPV
-                        m_vspElements;      // Elements in the pipeline.
+                        m_vspElements;          // Elements in the pipeline.
+        const GUID      m_PluginId;             // ID of plugin owning the pipeline, if any. Used for profiling.
+        const PipelineProgram
+                        m_Program;              // Optimized elements compiled into a program, used to modify paths.
+
+        void            VerifyPath(const std::wstring& p_OriginalPath,
+                                   std::wstring& p_rPath,
+                                   const PluginProvider* p_pPluginProvider) const;
+        void            ProfilePaths(gsl::span<std::wstring> p_Paths,
+                                     const PluginProvider* p_pPluginProvider) const;
     };
 
     //
@@ -123,7 +154,7 @@ namespace PCC
                                  GUIDS& p_rsSeenPluginIds) const noexcept(false);
 
         virtual void    ModifyPath(std::wstring& p_rPath,
-                                   std::stack<std::wstring>& p_rStack,
+                                   PipelineStack& p_rStack,
                                    const PluginProvider* p_pPluginProvider) const noexcept(false);
         virtual void    ModifyPath(std::wstring& p_rPath,
                                    const PluginProvider* p_pPluginProvider) const noexcept(false);
@@ -131,6 +162,8 @@ namespace PCC
         virtual bool    ShouldBeEnabledFor(const std::wstring& p_ParentPath,
                                            const std::wstring& p_File,
                                            const PluginProvider* p_pPluginProvider) const noexcept(false);
+
+        virtual void    Compile(PipelineCompiler& p_rCompiler) const;
     };
 
     //
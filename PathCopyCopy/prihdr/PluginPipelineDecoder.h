@@ -23,7 +23,13 @@
 
 #include "PathCopyCopyPrivateTypes.h"
 
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <vector>
 
 
 namespace PCC
@@ -43,34 +49,71 @@ namespace PCC
         static auto     DecodePipeline(const std::wstring& p_EncodedElements) -> PipelineElementSPV;
 
     private:
+        //
+        // File read while decoding a pipeline (like a prefix map's table).
+        //
+        struct SourceFile {
+            std::wstring    m_Path;                 // Path of file.
+            std::filesystem::file_time_type
+                            m_LastWriteTime;        // Last write time of file before it was read.
+        };
+        typedef std::vector<SourceFile> SourceFileV;
+
         //
         // Utility class that can be used to decode data from an encoded elements stream.
-        // Keeps track of how much data remains in the stream to validate data.
+        // Keeps track of how much data remains in the stream to validate data, as well
+        // as the files read by elements while decoding.
         //
         class EncodedElementsStream final
         {
         public:
-            explicit    EncodedElementsStream(const std::wstring& p_EncodedElements);
+            explicit    EncodedElementsStream(std::wstring_view p_EncodedElements) noexcept;
                         EncodedElementsStream(const EncodedElementsStream&) = delete;
             EncodedElementsStream&
                         operator=(const EncodedElementsStream&) = delete;
 
-            auto        ReadData(std::wstring::size_type p_DataSize) -> std::wstring;
+            auto        ReadData(std::wstring_view::size_type p_DataSize) -> std::wstring_view;
             auto        ReadElementCount() -> size_t;
             auto        ReadLong() -> long;
             auto        ReadString() -> std::wstring;
             auto        ReadBool() -> bool;
 
+            void        AddSourceFile(const std::wstring& p_FilePath);
+            auto        GetSourceFiles() noexcept -> SourceFileV&;
+
         private:
-            const std::wstring
-                        m_EncodedElements;      // The pipeline's encoded string.
-            std::wstring::size_type
+            const std::wstring_view
+                        m_EncodedElements;      // The pipeline's encoded string (not owned).
+            std::wstring_view::size_type
                         m_CurIndex;             // Position of read marker.
+            SourceFileV m_vSourceFiles;         // Files read while decoding elements.
         };
 
+        //
+        // Pipeline kept in the decoded pipelines cache.
+        //
+        struct DecodedPipeline {
+            PipelineElementSPV
+                        m_vspElements;              // Decoded pipeline elements.
+            SourceFileV m_vSourceFiles;             // Files read while decoding; pipeline is decoded again if one changes.
+            uint64_t    m_LastUse = 0;              // Value of s_CacheClock when pipeline was last returned.
+        };
+        typedef std::map<std::wstring, DecodedPipeline, std::less<>> DecodedPipelineM;
+
+        static std::mutex
+                        s_DecodedPipelinesLock;     // Lock protecting access to decoded pipelines cache.
+        static DecodedPipelineM
+                        s_DecodedPipelines;         // Cache of decoded pipelines, keyed by encoded string.
+        static uint64_t s_CacheClock;               // Incremented every time a pipeline is returned from cache.
+
+        static auto     DecodePipelineElements(std::wstring_view p_EncodedElements,
+                                               SourceFileV& p_rvSourceFiles) -> PipelineElementSPV;
+        static bool     SourceFilesChanged(const SourceFileV& p_vSourceFiles);
         static auto     DecodePipelineElement(EncodedElementsStream& p_rStream) -> PipelineElementSP;
 
         static auto     DecodeFindReplaceElement(EncodedElementsStream& p_rStream) -> PipelineElementSP;
+        static auto     DecodeMultiFindReplaceElement(EncodedElementsStream& p_rStream) -> PipelineElementSP;
+        static auto     DecodePrefixMapElement(EncodedElementsStream& p_rStream) -> PipelineElementSP;
         static auto     DecodeRegexElement(EncodedElementsStream& p_rStream) -> PipelineElementSP;
         static auto     DecodeCopyNPathPartsElement(EncodedElementsStream& p_rStream) -> PipelineElementSP;
         static auto     DecodeApplyPluginElement(wchar_t p_Code,
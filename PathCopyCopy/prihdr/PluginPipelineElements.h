@@ -21,11 +21,16 @@
 
 #pragma once
 
+#include <PathView.h>
 #include <PluginPipeline.h>
+#include <RegexBackend.h>
+#include <StringUtils.h>
 
+#include <cstdint>
 #include <memory>
-#include <regex>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include <windows.h>
 
@@ -62,6 +67,33 @@ namespace PCC
         Nowhere = 6,    // Simply pop and drop the value
     };
 
+    //
+    // PipelineRegex
+    //
+    // Regular expression used by a pipeline element. The regex is compiled
+    // once when the element is created and can then be used concurrently
+    // by any number of paths. An invalid regex is reported by Validate.
+    //
+    class PipelineRegex final
+    {
+    public:
+                        PipelineRegex() = default;
+                        PipelineRegex(const std::wstring& p_Regex,
+                                      bool p_IgnoreCase);
+                        PipelineRegex(const PipelineRegex&) = delete;
+        PipelineRegex&  operator=(const PipelineRegex&) = delete;
+
+        const RegexBackend*
+                        Get() const noexcept;
+        bool            IsValid() const noexcept;
+        void            Validate() const;
+
+    private:
+        std::unique_ptr<const RegexBackend>
+                        m_upRegex;              // Compiled regex, or nullptr if regex is empty or invalid.
+        bool            m_Valid = true;         // Whether regex compiled successfully (an empty regex is valid).
+    };
+
     //
     // FollowSymlinkPipelineElement
     //
@@ -95,6 +127,7 @@ namespace PCC
 
         void            ModifyPath(std::wstring& p_rPath,
                                    const PluginProvider* p_pPluginProvider) const override;
+        void            Compile(PipelineCompiler& p_rCompiler) const override;
     };
 
     //
@@ -113,6 +146,7 @@ namespace PCC
 
         void            ModifyPath(std::wstring& p_rPath,
                                    const PluginProvider* p_pPluginProvider) const override;
+        void            Compile(PipelineCompiler& p_rCompiler) const override;
     };
 
     //
@@ -131,6 +165,7 @@ namespace PCC
 
         void            ModifyPath(std::wstring& p_rPath,
                                    const PluginProvider* p_pPluginProvider) const override;
+        void            Compile(PipelineCompiler& p_rCompiler) const override;
     };
 
     //
@@ -185,6 +220,7 @@ namespace PCC
 
         void            ModifyPath(std::wstring& p_rPath,
                                    const PluginProvider* p_pPluginProvider) const override;
+        void            Compile(PipelineCompiler& p_rCompiler) const override;
     };
 
     //
@@ -203,6 +239,7 @@ namespace PCC
 
         void            ModifyPath(std::wstring& p_rPath,
                                    const PluginProvider* p_pPluginProvider) const override;
+        void            Compile(PipelineCompiler& p_rCompiler) const override;
     };
 
     //
@@ -219,7 +256,14 @@ namespace PCC
                         operator=(const RemoveFileExtPipelineElement&) = delete;
 
         void            ModifyPath(std::wstring& p_rPath,
+                                   PipelineStack& p_rStack,
                                    const PluginProvider* p_pPluginProvider) const override;
+        void            ModifyPath(std::wstring& p_rPath,
+                                   const PluginProvider* p_pPluginProvider) const override;
+
+    private:
+        void            ModifyPath(std::wstring& p_rPath,
+                                   const PathView& p_PathView) const;
     };
 
     //
@@ -239,12 +283,124 @@ namespace PCC
 
         void            ModifyPath(std::wstring& p_rPath,
                                    const PluginProvider* p_pPluginProvider) const override;
+        void            Compile(PipelineCompiler& p_rCompiler) const override;
 
     private:
+        const StringUtils::Searcher
+                        m_OldValueSearcher; // Searcher for value to replace.
         const std::wstring
-                        m_OldValue;     // Value to replace.
-        const std::wstring
-                        m_NewValue;     // Replacement value.
+                        m_NewValue;         // Replacement value.
+    };
+
+    //
+    // MultiFindReplacePipelineElement
+    //
+    // Pipeline element that performs multiple find/replace operations
+    // in a single pass. Values to find are compiled into an Aho-Corasick
+    // automaton when the element is created.
+    //
+    // Matches are chosen using the leftmost-longest rule: the path is
+    // scanned from left to right and when values to find overlap, the one
+    // that starts first is replaced; if many start at the same position,
+    // the longest one is replaced. Scanning then resumes after the replaced
+    // text, so replacement values are never scanned. For example, with
+    // values "ab", "abc" and "bcd", "abcd" becomes the replacement of "abc"
+    // followed by "d". Values are compared case-sensitively; if a value
+    // appears more than once, its first replacement is used.
+    //
+    class MultiFindReplacePipelineElement : public PipelineElement
+    {
+    public:
+        explicit        MultiFindReplacePipelineElement(const WStringPairV& p_vFindReplacePairs);
+                        MultiFindReplacePipelineElement(const MultiFindReplacePipelineElement&) = delete;
+        MultiFindReplacePipelineElement&
+                        operator=(const MultiFindReplacePipelineElement&) = delete;
+
+        void            ModifyPath(std::wstring& p_rPath,
+                                   const PluginProvider* p_pPluginProvider) const override;
+
+    private:
+        //
+        // Node of the automaton. Each node represents a prefix of values to find.
+        //
+        struct Node {
+            std::vector<std::pair<wchar_t, uint32_t>>
+                        m_vTransitions;             // Child nodes, sorted by character.
+            uint32_t    m_Failure = 0;              // Node of longest proper suffix that is also a prefix.
+            uint32_t    m_Output = NO_NODE;         // Node of longest value to find that is a suffix, or NO_NODE.
+            uint32_t    m_Depth = 0;                // Length of prefix represented by node.
+            uint32_t    m_Replacement = NO_NODE;    // Index of replacement value if node is a value to find, or NO_NODE.
+        };
+
+        static constexpr uint32_t
+                        NO_NODE = UINT32_MAX;       // Value used for missing nodes or replacements.
+
+        std::vector<Node>
+                        m_vNodes;                   // Nodes of the automaton. First node is the root.
+        WStringV        m_vReplacements;            // Replacement values.
+        StringUtils::CharClass
+                        m_FirstChars;               // Class containing first characters of all values to find.
+
+        uint32_t        GetTransition(uint32_t p_Node,
+                                      wchar_t p_Char) const noexcept;
+        uint32_t        Step(uint32_t p_Node,
+                             wchar_t p_Char) const noexcept;
+    };
+
+    //
+    // PrefixMapPipelineElement
+    //
+    // Pipeline element that rewrites the beginning of a path using a table
+    // of prefixes and their replacement. Prefixes are compiled into a
+    // case-insensitive trie when the element is created, so the cost of
+    // looking up a path depends on its length and not on the table's size.
+    //
+    // Only the longest prefix matching the path is replaced. Prefixes only
+    // match entire path parts, so a prefix of "D:\Projects\X" does not
+    // match "D:\Projects\Xyz". Forward slashes and backslashes are
+    // considered equal.
+    //
+    // When the table is stored in a file, it is read when the pipeline is
+    // decoded. Decoded pipelines are cached, but PipelineDecoder checks the
+    // file's last write time when reusing one: after the file is modified,
+    // the table is read again the next time the pipeline is decoded (e.g.
+    // the next time the contextual menu is shown).
+    //
+    class PrefixMapPipelineElement : public PipelineElement
+    {
+    public:
+        explicit        PrefixMapPipelineElement(const WStringPairV& p_vPrefixReplacementPairs);
+                        PrefixMapPipelineElement(const PrefixMapPipelineElement&) = delete;
+        PrefixMapPipelineElement&
+                        operator=(const PrefixMapPipelineElement&) = delete;
+
+        static WStringPairV
+                        LoadTable(const std::wstring& p_FilePath);
+
+        void            ModifyPath(std::wstring& p_rPath,
+                                   const PluginProvider* p_pPluginProvider) const override;
+
+    private:
+        //
+        // Node of the trie. Each node represents a prefix of one or more
+        // entries in the table. Transitions of all nodes are stored
+        // together, sorted by character for each node.
+        //
+        struct Node {
+            uint32_t    m_FirstTransition = 0;      // Index of node's first transition.
+            uint32_t    m_NumTransitions = 0;       // Number of transitions of node.
+            uint32_t    m_Replacement = NO_REPLACEMENT; // Index of replacement value if node is a prefix in table, or NO_REPLACEMENT.
+        };
+
+        static constexpr uint32_t
+                        NO_REPLACEMENT = UINT32_MAX; // Value used for nodes that are not prefixes in table.
+
+        std::vector<Node>
+                        m_vNodes;                   // Nodes of the trie. First node is the root.
+        std::wstring    m_TransitionChars;          // Folded character of each transition (see FoldPrefixChar).
+        std::vector<uint32_t>
+                        m_vTransitionNodes;         // Target node of each transition.
+        WStringV        m_vReplacements;            // Replacement values.
     };
 
     //
@@ -263,23 +419,21 @@ namespace PCC
         RegexPipelineElement&
                         operator=(const RegexPipelineElement&) = delete;
 
+        void            Validate(const PluginProvider* p_pPluginProvider,
+                                 GUIDS& p_rsSeenPluginIds) const override;
+
         void            ModifyPath(std::wstring& p_rPath,
                                    const PluginProvider* p_pPluginProvider) const override;
         bool            ShouldBeEnabledFor(const std::wstring& p_ParentPath,
                                            const std::wstring& p_File,
                                            const PluginProvider* p_pPluginProvider) const override;
+        void            Compile(PipelineCompiler& p_rCompiler) const override;
 
     private:
-        const std::wstring
+        const PipelineRegex
                         m_Regex;        // Regex to use to find matches.
         const std::wstring
                         m_Format;       // Format of replacement string.
-        const bool      m_IgnoreCase;   // Whether to ignore case when looking for matches.
-        mutable std::unique_ptr<std::wregex>
-                        m_upRegex;      // Regex object to use to perform lookups.
-        mutable bool    m_RegexTested;  // true if we tried to create m_upRegex.
-
-        void            InitRegex() const;
     };
 
     //
@@ -314,8 +468,15 @@ namespace PCC
         InjectDriveLabelPipelineElement&
                         operator=(const InjectDriveLabelPipelineElement&) = delete;
 
+        void            ModifyPath(std::wstring& p_rPath,
+                                   PipelineStack& p_rStack,
+                                   const PluginProvider* p_pPluginProvider) const override;
         void            ModifyPath(std::wstring& p_rPath,
                                    const PluginProvider* p_pPluginProvider) const override;
+
+    private:
+        void            ModifyPath(std::wstring& p_rPath,
+                                   const PathView& p_PathView) const;
     };
 
     //
@@ -332,12 +493,39 @@ namespace PCC
         CopyNPathPartsPipelineElement&
                         operator=(const CopyNPathPartsPipelineElement&) = delete;
 
+        void            ModifyPath(std::wstring& p_rPath,
+                                   PipelineStack& p_rStack,
+                                   const PluginProvider* p_pPluginProvider) const override;
         void            ModifyPath(std::wstring& p_rPath,
                                    const PluginProvider* p_pPluginProvider) const override;
 
     private:
         const size_t    m_NumParts;     // Number of path parts to copy.
         const bool      m_First;        // Whether to copy the first (true) or last (false) path parts.
+
+        void            ModifyPath(std::wstring& p_rPath,
+                                   const PathView& p_PathView) const;
+    };
+
+    //
+    // NormalizePathPipelineElement
+    //
+    // Pipeline element that normalizes a path by removing "." parts,
+    // resolving ".." parts and removing duplicate and trailing separators.
+    // The path's root (drive, UNC server and share, or "\\?\" and "\\.\"
+    // prefixes) is kept as-is and ".." parts never go above it.
+    // All separators are converted to the first one found in the path.
+    //
+    class NormalizePathPipelineElement : public PipelineElement
+    {
+    public:
+                        NormalizePathPipelineElement() = default;
+                        NormalizePathPipelineElement(const NormalizePathPipelineElement&) = delete;
+        NormalizePathPipelineElement&
+                        operator=(const NormalizePathPipelineElement&) = delete;
+
+        void            ModifyPath(std::wstring& p_rPath,
+                                   const PluginProvider* p_pPluginProvider) const override;
     };
 
     //
@@ -363,6 +551,8 @@ namespace PCC
                                            const std::wstring& p_File,
                                            const PluginProvider* p_pPluginProvider) const override;
 
+        void            Compile(PipelineCompiler& p_rCompiler) const override;
+
     protected:
         const GUID      m_PluginId;     // ID of plugin to apply.
     };
@@ -406,23 +596,32 @@ namespace PCC
         PushToStackPipelineElement&
                         operator=(const PushToStackPipelineElement&) = delete;
 
+        void            Validate(const PluginProvider* p_pPluginProvider,
+                                 GUIDS& p_rsSeenPluginIds) const override;
+
         void            ModifyPath(std::wstring& p_rPath,
-                                   std::stack<std::wstring>& p_rStack,
+                                   PipelineStack& p_rStack,
                                    const PluginProvider* p_pPluginProvider) const override;
+        void            Compile(PipelineCompiler& p_rCompiler) const override;
+
+        PushToStackMethod
+                        GetMethod() const noexcept;
+        const std::wstring&
+                        GetFixedString() const noexcept;
 
     private:
         const PushToStackMethod
                         m_Method;               // How to find the part of the path to push.
         const size_t    m_Begin = 0;            // Start of the range to push to the stack (if m_Method is Range).
         const size_t    m_End = 0;              // End of the range to push to the stack (if m_Method is Range).
-        const std::wstring
+        const PipelineRegex
                         m_Regex{};              // Regex to use to find the part of the path to push (if m_Method is Regex).
-        const bool      m_IgnoreCase = false;   // Whether to ignore case in regex (if m_Method is Regex).
         const size_t    m_Group = 0;            // Index of regex group to push to the stack (if m_Method is Regex).
         const std::wstring
                         m_FixedString{};        // Fixed string to push to the stack (if m_Method is Fixed).
 
-        std::wstring    PartToPush(const std::wstring& p_Path) const;
+        std::wstring_view
+                        PartToPush(const std::wstring& p_Path) const;
     };
 
     //
@@ -446,18 +645,24 @@ namespace PCC
         PopFromStackPipelineElement&
                         operator=(const PopFromStackPipelineElement&) = delete;
 
+        void            Validate(const PluginProvider* p_pPluginProvider,
+                                 GUIDS& p_rsSeenPluginIds) const override;
+
         void            ModifyPath(std::wstring& p_rPath,
-                                   std::stack<std::wstring>& p_rStack,
+                                   PipelineStack& p_rStack,
                                    const PluginProvider* p_pPluginProvider) const override;
+        void            Compile(PipelineCompiler& p_rCompiler) const override;
+
+        PopFromStackLocation
+                        GetLocation() const noexcept;
 
     private:
         const PopFromStackLocation
                         m_Location;             // Where to store the popped value.
         const size_t    m_Begin = 0;            // Start of range to replace with the popped value (if m_Location is Range).
         const size_t    m_End = 0;              // End of range to replace with the popped value (if m_Location is Range).
-        const std::wstring
+        const PipelineRegex
                         m_Regex{};              // Regex to replace with the popped value (if m_Location is Regex).
-        const bool      m_IgnoreCase = false;   // Whether to ignore case in regex (if m_Location is Regex).
     };
 
     //
@@ -476,8 +681,9 @@ namespace PCC
                         operator=(const SwapStackValuesPipelineElement&) = delete;
 
         void            ModifyPath(std::wstring& p_rPath,
-                                   std::stack<std::wstring>& p_rStack,
+                                   PipelineStack& p_rStack,
                                    const PluginProvider* p_pPluginProvider) const override;
+        void            Compile(PipelineCompiler& p_rCompiler) const override;
     };
 
     //
@@ -496,8 +702,9 @@ namespace PCC
                         operator=(const DuplicateStackValuePipelineElement&) = delete;
 
         void            ModifyPath(std::wstring& p_rPath,
-                                   std::stack<std::wstring>& p_rStack,
+                                   PipelineStack& p_rStack,
                                    const PluginProvider* p_pPluginProvider) const override;
+        void            Compile(PipelineCompiler& p_rCompiler) const override;
     };
 
     //
@@ -517,6 +724,7 @@ namespace PCC
         void            ModifyPath(std::wstring& p_rPath,
                                    const PluginProvider* p_pPluginProvider) const noexcept(false) override;
         void            ModifyOptions(PipelineOptions& p_rOptions) const override;
+        void            Compile(PipelineCompiler& p_rCompiler) const override;
 
     private:
         const std::wstring
@@ -538,6 +746,7 @@ namespace PCC
                         operator=(const RecursiveCopyPipelineElement&) = delete;
 
         void            ModifyOptions(PipelineOptions& p_rOptions) const override;
+        void            Compile(PipelineCompiler& p_rCompiler) const override;
     };
 
     //
@@ -558,6 +767,7 @@ namespace PCC
         void            ModifyPath(std::wstring& p_rPath,
                                    const PluginProvider* p_pPluginProvider) const noexcept(false) override;
         void            ModifyOptions(PipelineOptions& p_rOptions) const override;
+        void            Compile(PipelineCompiler& p_rCompiler) const override;
 
     private:
         const std::wstring
@@ -624,10 +834,73 @@ namespace PCC
                         operator=(const DisplayForSelectionPipelineElement&) = delete;
 
         void            ModifyOptions(PipelineOptions& p_rOptions) const override;
+        void            Compile(PipelineCompiler& p_rCompiler) const override;
 
     private:
         bool            m_ShowForFiles;     // Whether the plugin should be displayed when files are selected.
         bool            m_ShowForFolders;   // Whether the plugin should be displayed when folders are selected.
     };
 
+    //
+    // SurroundPipelineElement
+    //
+    // Pipeline element that surrounds the path with a prefix and a suffix,
+    // optionally only if the path contains spaces. This element has no
+    // encoding; it is produced by PipelineOptimizer when fusing elements.
+    //
+    class SurroundPipelineElement : public PipelineElement
+    {
+    public:
+                        SurroundPipelineElement(const std::wstring& p_Prefix,
+                                                const std::wstring& p_Suffix,
+                                                bool p_OnlyIfSpaces);
+                        SurroundPipelineElement(const SurroundPipelineElement&) = delete;
+        SurroundPipelineElement&
+                        operator=(const SurroundPipelineElement&) = delete;
+
+        void            ModifyPath(std::wstring& p_rPath,
+                                   const PluginProvider* p_pPluginProvider) const override;
+        void            Compile(PipelineCompiler& p_rCompiler) const override;
+
+        const std::wstring&
+                        GetPrefix() const noexcept;
+        const std::wstring&
+                        GetSuffix() const noexcept;
+        bool            GetOnlyIfSpaces() const noexcept;
+
+    private:
+        const std::wstring
+                        m_Prefix;           // String to insert at start of path.
+        const std::wstring
+                        m_Suffix;           // String to append at end of path.
+        const bool      m_OnlyIfSpaces;     // Whether to surround path only if it contains spaces.
+    };
+
+    //
+    // SetPathPipelineElement
+    //
+    // Pipeline element that replaces the path with a constant value.
+    // This element has no encoding; it is produced by PipelineOptimizer
+    // when the result of a sequence of elements can be computed in advance.
+    //
+    class SetPathPipelineElement : public PipelineElement
+    {
+    public:
+        explicit        SetPathPipelineElement(const std::wstring& p_Value);
+                        SetPathPipelineElement(const SetPathPipelineElement&) = delete;
+        SetPathPipelineElement&
+                        operator=(const SetPathPipelineElement&) = delete;
+
+        void            ModifyPath(std::wstring& p_rPath,
+                                   const PluginProvider* p_pPluginProvider) const override;
+        void            Compile(PipelineCompiler& p_rCompiler) const override;
+
+        const std::wstring&
+                        GetValue() const noexcept;
+
+    private:
+        const std::wstring
+                        m_Value;            // Value to replace path with.
+    };
+
 } // namespace PCC
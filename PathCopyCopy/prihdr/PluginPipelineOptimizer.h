@@ -0,0 +1,56 @@
+// PluginPipelineOptimizer.h
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include "PathCopyCopyPrivateTypes.h"
+
+
+namespace PCC
+{
+    //
+    // PipelineOptimizer
+    //
+    // Utility class that performs peephole optimizations on a list of
+    // pipeline elements. Redundant sequences of elements are removed or
+    // fused together and results that do not depend on the path are
+    // computed in advance. The optimized elements modify paths exactly
+    // like the original ones; however, they do not modify pipeline
+    // options, so they should only be used to modify paths.
+    //
+    class PipelineOptimizer final
+    {
+    public:
+                        PipelineOptimizer() = delete;
+                        ~PipelineOptimizer() = delete;
+
+        static auto     Optimize(const PipelineElementSPV& p_vspElements) -> PipelineElementSPV;
+
+    private:
+        static bool     Combine(const PipelineElementSP& p_spFirst,
+                                const PipelineElementSP& p_spSecond,
+                                PipelineElementSPV& p_rvspCombined);
+        static auto     Normalize(const PipelineElementSP& p_spElement) -> PipelineElementSP;
+        static bool     ModifiesPath(const PipelineElement& p_Element) noexcept;
+        static bool     IsPure(const PipelineElement& p_Element) noexcept;
+    };
+
+} // namespace PCC
@@ -0,0 +1,97 @@
+// PluginPipelineProfiler.h
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include "PathCopyCopyPrivateTypes.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace PCC
+{
+    //
+    // PipelineElementProfile
+    //
+    // Counters recorded for one element of a pipeline while profiling.
+    //
+    struct PipelineElementProfile {
+        uint64_t        m_Invocations = 0;      // Number of times element was called.
+        std::chrono::nanoseconds
+                        m_TotalTime {};         // Cumulative time spent in element.
+        std::chrono::nanoseconds
+                        m_MaxTime {};           // Longest time spent in a single call.
+        uint64_t        m_BytesIn = 0;          // Cumulative size of paths passed to element.
+        uint64_t        m_BytesOut = 0;         // Cumulative size of paths returned by element.
+
+        void            Add(std::chrono::nanoseconds p_Time,
+                            size_t p_BytesIn,
+                            size_t p_BytesOut) noexcept;
+        void            Merge(const PipelineElementProfile& p_Other) noexcept;
+    };
+    typedef std::vector<PipelineElementProfile> PipelineElementProfileV;
+
+    //
+    // PipelineProfiler
+    //
+    // Utility class that keeps profiling counters for the elements of
+    // pipelines, keyed by the ID of the plugin owning the pipeline and
+    // indexed by element position. Profiling is disabled by default; when
+    // it is, pipelines only pay for a single check of Enabled per batch
+    // of paths. See Pipeline::ModifyPaths.
+    //
+    class PipelineProfiler final
+    {
+    public:
+        typedef std::map<GUID, PipelineElementProfileV, GUIDLess> ProfileM;
+
+                        PipelineProfiler() = delete;
+                        ~PipelineProfiler() = delete;
+
+        // Inline so that checking costs a single predictable branch.
+        static bool     Enabled() noexcept {
+            return s_Enabled.load(std::memory_order_relaxed);
+        }
+        static void     SetEnabled(bool p_Enabled) noexcept;
+
+        static void     Record(const GUID& p_PluginId,
+                               const PipelineElementProfileV& p_vProfiles);
+        static ProfileM GetProfiles();
+        static void     Reset();
+
+        static std::wstring
+                        Report();
+
+    private:
+        static std::atomic<bool>
+                        s_Enabled;      // Whether profiling is enabled.
+        static std::mutex
+                        s_Lock;         // Lock protecting s_Profiles.
+        static ProfileM s_Profiles;     // Counters for each profiled pipeline.
+    };
+
+} // namespace PCC
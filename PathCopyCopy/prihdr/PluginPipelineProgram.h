@@ -0,0 +1,178 @@
+// PluginPipelineProgram.h
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include "PathCopyCopyPrivateTypes.h"
+#include "PluginPipelineStack.h"
+#include "RegexBackend.h"
+#include "StringUtils.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace PCC
+{
+    //
+    // PipelineOpcode
+    //
+    // Enum of the instructions that can be found in a compiled pipeline program.
+    // Each instruction has two operands whose meaning depends on the opcode.
+    //
+    enum class PipelineOpcode : uint8_t
+    {
+        CallElement,            // Call element's ModifyPath. Operand 1: index of element
+        Quotes,                 // Surround path with quotes
+        OptionalQuotes,         // Surround path with quotes if it contains spaces
+        EmailLinks,             // Surround path with < and >
+        BackToForwardSlashes,   // Replace all backslashes with forward slashes
+        ForwardToBackslashes,   // Replace all forward slashes with backslashes
+        FindReplace,            // Replace all instances of a string. Operands: index of searcher, index of new string
+        RegexReplace,           // Regex find/replace. Operands: index of regex, index of format string
+        PushEntire,             // Push entire path to the stack
+        PushRange,              // Push a range of the path to the stack. Operands: begin and end of range
+        PushRegex,              // Push regex match to the stack. Operands: index of regex, group number
+        PushFixed,              // Push a fixed string to the stack. Operand 1: index of string
+        PopEntire,              // Pop value and replace path with it
+        PopRange,               // Pop value and replace a range of the path with it. Operands: begin and end of range
+        PopRegex,               // Pop value and replace a regex match with it. Operand 1: index of regex
+        PopStart,               // Pop value and insert it at start of path
+        PopEnd,                 // Pop value and insert it at end of path
+        PopNowhere,             // Pop value and drop it
+        SwapStackValues,        // Swap the two top values on the stack
+        DuplicateStackValue,    // Duplicate the top value on the stack
+        Surround,               // Surround path with strings. Operands: index of prefix and suffix strings
+        SurroundIfSpaces,       // Surround path with strings if it contains spaces. Operands: same as Surround
+        SetPath,                // Replace path with a string. Operand 1: index of string
+        ApplyPlugin,            // Replace path with result of another plugin. Operand 1: index of plugin ID
+        EnterFrame,             // Start a new stack frame, hiding values already on the stack
+        LeaveFrame,             // Drop values pushed in the current stack frame and return to previous frame
+    };
+
+    //
+    // PipelineInstruction
+    //
+    // A single instruction in a compiled pipeline program.
+    //
+    struct PipelineInstruction {
+        PipelineOpcode  m_Opcode;       // Instruction to execute.
+        size_t          m_Operand1;     // First operand; meaning depends on opcode.
+        size_t          m_Operand2;     // Second operand; meaning depends on opcode.
+    };
+    typedef std::vector<PipelineInstruction> PipelineInstructionV;
+
+    //
+    // PipelineProgram
+    //
+    // Compiled form of a list of pipeline elements. Elements are lowered into
+    // a flat array of instructions with a pool of constants (strings, compiled
+    // regexes and substring searchers) and run by a single interpreter loop, without having
+    // to go through virtual calls for each element.
+    //
+    // Elements that do not know how to compile themselves are called through
+    // a CallElement instruction, so the element classes remain the reference
+    // implementation of each operation.
+    //
+    // Plugins applied by the program are looked up once when the program is
+    // bound to a plugin provider (see Bind) instead of for each path. When
+    // binding, pipeline plugins are inlined in the bound code so that nested
+    // pipelines run in the same interpreter loop, each in its own stack frame.
+    //
+    class PipelineProgram final
+    {
+    public:
+        explicit        PipelineProgram(const PipelineElementSPV& p_vspElements);
+                        PipelineProgram(const PipelineProgram&) = delete;
+        PipelineProgram& operator=(const PipelineProgram&) = delete;
+
+        void            Run(std::wstring& p_rPath,
+                            PipelineStack& p_rStack,
+                            const PluginProvider* p_pPluginProvider) const;
+
+        void            Bind(const PluginProvider* p_pPluginProvider) const;
+        void            Unbind() const noexcept;
+
+    private:
+        friend class PipelineCompiler;
+
+        //
+        // Instructions of a program, along with the constants they use.
+        //
+        struct Code {
+            PipelineInstructionV
+                            m_vInstructions;        // Instructions to run.
+            WStringV        m_vStrings;             // Pool of string constants.
+            std::vector<const RegexBackend*>
+                            m_vpRegexes;            // Pool of compiled regexes. Owned by elements.
+            std::vector<const StringUtils::Searcher*>
+                            m_vpSearchers;          // Pool of substring searchers. Owned by elements.
+            std::vector<const PipelineElement*>
+                            m_vpElements;           // Elements called by CallElement instructions.
+            GUIDV           m_vPluginIds;           // IDs of plugins applied by ApplyPlugin instructions.
+            std::vector<const Plugin*>
+                            m_vpPlugins;            // Plugins bound to plugin IDs, or empty if code is not bound.
+            PipelineElementSPV
+                            m_vspInlinedElements;   // Elements of inlined pipelines. Keeps their constants alive.
+        };
+
+        const PipelineElementSPV
+                        m_vspElements;          // Elements that were compiled. Keeps constants alive.
+        Code            m_Code;                 // Code compiled from elements.
+        mutable Code    m_BoundCode;            // Code bound to plugin provider, with pipeline plugins inlined.
+        mutable const PluginProvider*
+                        m_pBoundPluginProvider; // Provider used to bind code, or nullptr if not bound.
+
+        void            Link(const PluginProvider* p_pPluginProvider,
+                             Code& p_rBoundCode) const;
+        static void     AppendCode(Code& p_rCode,
+                                   const Code& p_Source);
+    };
+
+    //
+    // PipelineCompiler
+    //
+    // Object passed to pipeline elements to allow them to compile
+    // themselves into instructions of a PipelineProgram.
+    //
+    class PipelineCompiler final
+    {
+    public:
+        explicit        PipelineCompiler(PipelineProgram& p_rProgram) noexcept;
+                        PipelineCompiler(const PipelineCompiler&) = delete;
+        PipelineCompiler& operator=(const PipelineCompiler&) = delete;
+
+        void            Emit(PipelineOpcode p_Opcode,
+                             size_t p_Operand1 = 0,
+                             size_t p_Operand2 = 0);
+        void            EmitCallElement(const PipelineElement& p_Element);
+
+        size_t          AddString(const std::wstring& p_String);
+        size_t          AddRegex(const RegexBackend& p_Regex);
+        size_t          AddSearcher(const StringUtils::Searcher& p_Searcher);
+        size_t          AddPluginId(const GUID& p_PluginId);
+
+    private:
+        PipelineProgram& m_rProgram;        // Program being compiled.
+    };
+
+} // namespace PCC
@@ -0,0 +1,93 @@
+// PluginPipelineStack.h
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include "PathView.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace PCC
+{
+    //
+    // PipelineStack
+    //
+    // Stack of string values used by stack pipeline elements. Values are
+    // stored as slices of an append-only buffer, so swapping or duplicating
+    // values never copies strings. Clearing the stack keeps the memory
+    // allocated, so a stack reused for many paths stops allocating once
+    // its buffer is large enough.
+    //
+    // Views returned by Top remain valid until the next call to Push or Clear.
+    //
+    // The stack can be split in frames: values pushed before a call to
+    // EnterFrame are hidden until the matching call to LeaveFrame. This is
+    // used to run nested pipelines as if they had their own stack.
+    //
+    // Since a stack is used for a single pipeline run at a time, it also
+    // caches the structure of the path being modified (see GetPathView),
+    // so that elements looking at the same path do not all parse it.
+    // Code modifying the path during a run must call PathModified.
+    //
+    class PipelineStack final
+    {
+    public:
+                        PipelineStack() = default;
+                        PipelineStack(const PipelineStack&) = delete;
+        PipelineStack&  operator=(const PipelineStack&) = delete;
+
+        bool            Empty() const noexcept;
+        size_t          Size() const noexcept;
+        std::wstring_view
+                        Top() const noexcept;
+
+        void            Push(std::wstring_view p_Value);
+        void            Pop() noexcept;
+        void            Swap() noexcept;
+        void            Duplicate();
+        void            Clear() noexcept;
+
+        void            EnterFrame();
+        void            LeaveFrame() noexcept;
+
+        const PathView& GetPathView(const std::wstring& p_Path);
+        void            PathModified() noexcept;
+
+    private:
+        // Location of a value in the stack's buffer.
+        struct Slice {
+            size_t      m_Offset;       // Offset of value in buffer.
+            size_t      m_Length;       // Length of value.
+        };
+        typedef std::vector<Slice> SliceV;
+
+        std::wstring    m_Buffer;       // Buffer containing all values pushed since last Clear.
+        SliceV          m_vSlices;      // Values on the stack, top value last.
+        size_t          m_FrameBase = 0;    // Number of values hidden by current frame.
+        std::vector<size_t>
+                        m_vFrameBases;  // Bases of enclosing frames, innermost last.
+        PathViewCache   m_PathViewCache;    // Cache of the structure of the path being modified.
+    };
+
+} // namespace PCC
@@ -25,8 +25,8 @@
 #include "RegKey.h"
 
 #include <mutex>
-#include <regex>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <windows.h>
@@ -45,11 +45,11 @@ namespace PCC
                         PluginUtils() = delete;
                         ~PluginUtils() = delete;
 
-        static bool     IsDirectory(const std::wstring& p_Path) noexcept;
+        static bool     IsDirectory(const std::wstring& p_Path);
 
         static bool     ExtractFolderFromPath(std::wstring& p_rPath);
         static std::vector<std::wstring>
-                        EnumerateParents(std::wstring p_Path);
+                        EnumerateParents(std::wstring_view p_Path);
         static bool     FollowSymlinkIfRequired(std::wstring& p_rPath);
 
         static bool     IsUNCPath(const std::wstring& p_FilePath) noexcept;
@@ -68,9 +68,9 @@ namespace PCC
         static std::wstring
                         GetMultiStringLineBeginningWith(const std::wstring& p_MultiStringValue,
                                                         const std::wstring& p_Prefix);
-        static GUIDV    StringToPluginIds(std::wstring p_PluginIdsAsString,
+        static GUIDV    StringToPluginIds(std::wstring_view p_PluginIdsAsString,
                                           wchar_t p_Separator);
-        static UInt32V  StringToUInt32s(std::wstring p_UInt32sAsString,
+        static UInt32V  StringToUInt32s(std::wstring_view p_UInt32sAsString,
                                         wchar_t p_Separator);
         static std::wstring
                         PluginIdsToString(const GUIDV& p_vPluginIds,
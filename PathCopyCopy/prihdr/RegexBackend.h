@@ -0,0 +1,98 @@
+// RegexBackend.h
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <regex>
+#include <string>
+#include <vector>
+
+
+namespace PCC
+{
+    //
+    // RegexMatch
+    //
+    // Result of a regex search. Stores the position of each group,
+    // group 0 being the entire match.
+    //
+    struct RegexMatch {
+        std::vector<size_t>
+                        m_vSlots;       // Beginning and end of each group, or std::wstring::npos for groups that did not participate.
+
+        bool            Matched(size_t p_Group) const noexcept;
+        size_t          Position(size_t p_Group) const noexcept;
+        size_t          Length(size_t p_Group) const noexcept;
+    };
+
+    //
+    // RegexBackend
+    //
+    // Interface of engines used to run regexes of pipeline elements.
+    // Regexes use the ECMAScript syntax of std::regex, and results must
+    // be the same as std::regex_search and std::regex_replace.
+    //
+    // Use Create to get the backend to use for a regex.
+    //
+    class RegexBackend
+    {
+    public:
+                        RegexBackend() noexcept = default;
+                        RegexBackend(const RegexBackend&) = delete;
+        RegexBackend&   operator=(const RegexBackend&) = delete;
+        virtual         ~RegexBackend() = default;
+
+        static std::unique_ptr<const RegexBackend>
+                        Create(const std::wstring& p_Regex,
+                               bool p_IgnoreCase);
+
+        virtual bool    Search(const std::wstring& p_String,
+                               RegexMatch& p_rMatch) const = 0;
+        virtual std::wstring
+                        Replace(const std::wstring& p_String,
+                                const std::wstring& p_Format) const = 0;
+    };
+
+    //
+    // StdRegexBackend
+    //
+    // Regex backend that uses std::wregex. Supports all features
+    // of ECMAScript regexes.
+    //
+    class StdRegexBackend final : public RegexBackend
+    {
+    public:
+                        StdRegexBackend(const std::wstring& p_Regex,
+                                        bool p_IgnoreCase);
+
+        bool            Search(const std::wstring& p_String,
+                               RegexMatch& p_rMatch) const override;
+        std::wstring    Replace(const std::wstring& p_String,
+                                const std::wstring& p_Format) const override;
+
+    private:
+        const std::wregex
+                        m_Regex;        // Compiled regex.
+    };
+
+} // namespace PCC
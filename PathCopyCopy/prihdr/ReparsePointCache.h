@@ -0,0 +1,116 @@
+// ReparsePointCache.h
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+
+namespace PCC
+{
+    class FileSystem;
+
+    //
+    // ReparsePointCache
+    //
+    // Remembers which folders are reparse points (symlinks, junctions, etc.)
+    // and where they point, in order to follow symlinks in many paths sharing
+    // the same parents. Folders are stored in a trie with one node per path
+    // part, so following a path only queries the file system for the parents
+    // not seen before. If a path is under a known reparse point, its final
+    // path is the final path of the reparse point followed by the rest of
+    // the path, so the reparse point does not need to be opened again.
+    //
+    // Like on Windows, path parts are compared case-insensitively.
+    // Results are kept until Clear is called, so a cache should only be
+    // used for the duration of a single operation.
+    //
+    class ReparsePointCache final
+    {
+    public:
+        // Counters of cache hits and misses.
+        struct Stats {
+            size_t      m_NumPartHits = 0;          // Parents whose status was known.
+            size_t      m_NumPartMisses = 0;        // Parents whose status had to be queried.
+            size_t      m_NumTargetHits = 0;        // Reparse point targets that were known.
+            size_t      m_NumTargetMisses = 0;      // Reparse point targets that had to be resolved.
+
+            double      GetPartHitRate() const noexcept;
+            double      GetTargetHitRate() const noexcept;
+        };
+
+                        ReparsePointCache();
+                        ReparsePointCache(const ReparsePointCache&) = delete;
+        ReparsePointCache&
+                        operator=(const ReparsePointCache&) = delete;
+
+        bool            FollowSymlinks(const FileSystem& p_FileSystem,
+                                       const std::wstring& p_Path,
+                                       std::wstring& p_rFinalPath);
+        void            Clear() noexcept;
+
+        const Stats&    GetStats() const noexcept;
+
+    private:
+        // What we know about a folder.
+        enum class Status {
+            Unknown,        // Not queried yet.
+            Missing,        // Does not exist.
+            Regular,        // Not a reparse point.
+            ReparsePoint,   // Reparse point; see Node::m_Target.
+        };
+
+        // Node of the trie, for a folder.
+        struct Node {
+            Status          m_Status = Status::Unknown;     // What we know about the folder.
+            bool            m_HasTarget = false;            // Whether m_Target has been resolved.
+            std::wstring    m_Target;                       // For reparse points, final path; empty if it could not be resolved.
+        };
+        typedef std::vector<Node> NodeV;
+
+        // Link from a node to one of its children.
+        struct Edge {
+            size_t          m_ParentIndex = 0;              // Index of parent node.
+            std::wstring    m_Part;                         // Path part leading to child, in uppercase.
+
+            bool            operator==(const Edge& p_Other) const noexcept;
+        };
+        struct EdgeHash {
+            size_t          operator()(const Edge& p_Edge) const noexcept;
+        };
+        typedef std::unordered_map<Edge, size_t, EdgeHash> EdgeM;
+
+        NodeV           m_vNodes;                   // Nodes of the trie. First node is the root.
+        EdgeM           m_mChildren;                // Index of child nodes, by parent and path part.
+        Stats           m_Stats;                    // Hit and miss counters.
+        std::vector<size_t>
+                        m_vParentSizes;             // Sizes of the parents of the path being followed; kept to reuse memory.
+        std::wstring    m_Prefix;                   // Buffer used to query the file system; kept to reuse memory.
+        Edge            m_Edge;                     // Buffer used to look up children; kept to reuse memory.
+
+        size_t          GetChild(size_t p_NodeIndex,
+                                 std::wstring_view p_Part);
+    };
+
+} // namespace PCC
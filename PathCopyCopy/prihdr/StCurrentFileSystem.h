@@ -0,0 +1,74 @@
+// StCurrentFileSystem.h
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include "FileSystem.h"
+
+
+namespace PCC
+{
+    //
+    // StCurrentFileSystem
+    //
+    // Stack-based class to change the current file system (see
+    // FileSystem::Current) in a block of code. Destructor will
+    // restore the file system that was used before.
+    //
+    class StCurrentFileSystem final
+    {
+    public:
+                        //
+                        // Constructor. Installs the given file system as the
+                        // current one for the calling thread.
+                        //
+                        // @param p_rFileSystem File system to use. Must remain
+                        //                      alive while this object exists.
+                        //
+        explicit        StCurrentFileSystem(FileSystem& p_rFileSystem) noexcept
+                            : m_pPrevious(FileSystem::SetCurrent(&p_rFileSystem))
+                        {
+                        }
+
+                        //
+                        // Copying/moving not supported.
+                        //
+                        StCurrentFileSystem(const StCurrentFileSystem&) = delete;
+                        StCurrentFileSystem(StCurrentFileSystem&&) = delete;
+        StCurrentFileSystem&
+                        operator=(const StCurrentFileSystem&) = delete;
+        StCurrentFileSystem&
+                        operator=(StCurrentFileSystem&&) = delete;
+
+                        //
+                        // Destructor. Restores the previous file system.
+                        //
+                        ~StCurrentFileSystem()
+                        {
+                            FileSystem::SetCurrent(m_pPrevious);
+                        }
+
+    private:
+        FileSystem* const
+                        m_pPrevious;    // File system used before this object was created.
+    };
+
+} // namespace PCC
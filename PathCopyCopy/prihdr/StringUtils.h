@@ -23,7 +23,12 @@
 
 #include "PathCopyCopyPrivateTypes.h"
 
+#include <atomic>
+#include <cstdint>
+#include <iterator>
 #include <string>
+#include <string_view>
+#include <type_traits>
 
 
 //
@@ -37,21 +42,220 @@ public:
         None,           // No encoding
         Whitespace,     // Encode only whitespace characters
         All,            // Encode all invalid URI characters
+        RFC3986,        // Encode all characters not allowed in an URI path, using UTF-8 for non-ASCII characters
+    };
+
+    // Instruction sets that can be used by vectorized kernels.
+    enum class SimdLevel {
+        Scalar,     // No vector instructions
+        SSE2,       // 128-bit vectors
+        AVX2,       // 256-bit vectors
+    };
+
+    //
+    // Class of characters that can be searched for with FindFirstOf.
+    // ASCII characters are stored in a pair of nibble tables that can be
+    // used by vectorized code; non-ASCII characters are either all part
+    // of the class or all excluded from it.
+    //
+    class CharClass final
+    {
+    public:
+        explicit        CharClass(std::wstring_view p_ASCIIChars,
+                                  bool p_IncludeNonASCII = false) noexcept;
+
+        bool            Contains(wchar_t p_Char) const noexcept;
+
+    private:
+        friend class StringUtils;
+
+        uint8_t         m_LowNibbles[16];   // For each low nibble, bit set of high nibbles in class.
+        uint8_t         m_HighNibbles[16];  // For each high nibble, bit to test in m_LowNibbles.
+        bool            m_IncludeNonASCII;  // Whether non-ASCII characters are part of the class.
+    };
+
+    //
+    // Substring searcher using the Boyer-Moore-Horspool algorithm.
+    // Preprocessing the pattern is done once at construction, so a searcher
+    // can be kept and reused to look for the same pattern in many strings.
+    //
+    class Searcher final
+    {
+    public:
+        explicit        Searcher(std::wstring p_Pattern) noexcept;
+
+        const std::wstring&
+                        Pattern() const noexcept;
+
+        size_t          Find(std::wstring_view p_String,
+                             size_t p_Pos = 0) const noexcept;
+
+    private:
+        std::wstring    m_Pattern;          // Pattern to look for.
+        size_t          m_Shifts[256];      // Shift to use for each possible low byte of last character in window.
+    };
+
+    //
+    // Part of a string returned by SplitParts, along with the separators
+    // found before it. Both are views on the string that was split,
+    // so the position of separators can be computed if needed.
+    //
+    struct SplitPart {
+        std::wstring_view m_Separators;     // Separators found before part; empty for a first part not preceded by separators.
+        std::wstring_view m_Part;           // Part of string, never empty.
+    };
+
+    //
+    // Lazy range of the parts of a string split using separators.
+    // Parts are found as the range is iterated, without copying the string.
+    // Like Split, empty parts are skipped. The string that was split must
+    // remain alive while the range is used.
+    //
+    // @param Value Type of range values: either std::wstring_view or SplitPart.
+    //
+    template<typename Value>
+    class SplitRange final
+    {
+        static_assert(std::is_same_v<Value, std::wstring_view> || std::is_same_v<Value, SplitPart>,
+                      "SplitRange values must be string views or SplitPart");
+
+    public:
+        class Iterator final
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type        = Value;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = const Value*;
+            using reference         = Value;
+
+                        Iterator() noexcept = default;
+                        Iterator(const SplitRange& p_Range,
+                                 const size_t p_Pos) noexcept
+                            : m_pRange(&p_Range)
+                        {
+                            Advance(p_Pos);
+                        }
+
+            Value       operator*() const noexcept
+                        {
+                            const std::wstring_view part = m_pRange->m_String.substr(m_PartBegin, m_PartEnd - m_PartBegin);
+                            if constexpr (std::is_same_v<Value, SplitPart>) {
+                                return { m_pRange->m_String.substr(m_SeparatorsBegin, m_PartBegin - m_SeparatorsBegin), part };
+                            } else {
+                                return part;
+                            }
+                        }
+            Iterator&   operator++() noexcept
+                        {
+                            Advance(m_PartEnd);
+                            return *this;
+                        }
+            Iterator    operator++(int) noexcept
+                        {
+                            Iterator prev(*this);
+                            ++*this;
+                            return prev;
+                        }
+
+            bool        operator==(const Iterator& p_Other) const noexcept
+                        {
+                            return m_PartBegin == p_Other.m_PartBegin;
+                        }
+            bool        operator!=(const Iterator& p_Other) const noexcept
+                        {
+                            return !(*this == p_Other);
+                        }
+
+        private:
+            const SplitRange*
+                        m_pRange = nullptr;                         // Range being iterated.
+            size_t      m_SeparatorsBegin = std::wstring_view::npos; // Start of separators before current part.
+            size_t      m_PartBegin = std::wstring_view::npos;      // Start of current part, or npos at end of range.
+            size_t      m_PartEnd = std::wstring_view::npos;        // End of current part.
+
+            void        Advance(const size_t p_Pos) noexcept
+                        {
+                            m_SeparatorsBegin = p_Pos;
+                            m_PartBegin = p_Pos < m_pRange->m_String.size()
+                                ? m_pRange->m_String.find_first_not_of(m_pRange->m_Separators, p_Pos)
+                                : std::wstring_view::npos;
+                            if (m_PartBegin != std::wstring_view::npos) {
+                                m_PartEnd = StringUtils::FindFirstOf(m_pRange->m_String, m_pRange->m_Separators, m_PartBegin);
+                                if (m_PartEnd == std::wstring_view::npos) {
+                                    m_PartEnd = m_pRange->m_String.size();
+                                }
+                            } else {
+                                m_SeparatorsBegin = std::wstring_view::npos;
+                                m_PartEnd = std::wstring_view::npos;
+                            }
+                        }
+        };
+
+                        SplitRange(const std::wstring_view p_String,
+                                   const std::wstring_view p_Separators) noexcept
+                            : m_String(p_String),
+                              m_Separators(p_Separators)
+                        {
+                        }
+
+        Iterator        begin() const noexcept
+                        {
+                            return Iterator(*this, 0);
+                        }
+        Iterator        end() const noexcept
+                        {
+                            return Iterator();
+                        }
+
+    private:
+        std::wstring_view
+                        m_String;       // String to split.
+        std::wstring_view
+                        m_Separators;   // Separators to use for splitting.
     };
 
                         StringUtils() = delete;
                         ~StringUtils() = delete;
 
+    static SimdLevel    GetSimdLevel() noexcept;
+    static void         SetMaxSimdLevel(SimdLevel p_MaxLevel) noexcept;
+
+    static wchar_t      ToUppercase(wchar_t p_Char) noexcept;
     static std::wstring ToUppercase(std::wstring p_String);
+    static void         SortCaseInsensitively(PCC::WStringV& p_rvStrings);
+
+    static void         ReplaceChar(std::wstring& p_rString,
+                                    wchar_t p_OldChar,
+                                    wchar_t p_NewChar) noexcept;
+    static size_t       FindFirstOf(std::wstring_view p_String,
+                                    std::wstring_view p_Chars,
+                                    size_t p_Pos = 0) noexcept;
+    static size_t       FindFirstOf(std::wstring_view p_String,
+                                    const CharClass& p_CharClass,
+                                    size_t p_Pos = 0) noexcept;
 
     static void         ReplaceAll(std::wstring& p_rString,
                                    const std::wstring& p_OldValue,
                                    const std::wstring& p_NewValue);
-    static PCC::WStringV Split(std::wstring p_String,
-                               const std::wstring& p_Separators);
-    static PCC::WStringV Split(std::wstring p_String,
+    static void         ReplaceAll(std::wstring& p_rString,
+                                   const Searcher& p_OldValueSearcher,
+                                   std::wstring_view p_NewValue);
+    static PCC::WStringV Split(std::wstring_view p_String,
+                               std::wstring_view p_Separators);
+    static PCC::WStringV Split(std::wstring_view p_String,
                                wchar_t p_Separator);
+    static SplitRange<std::wstring_view>
+                        SplitView(std::wstring_view p_String,
+                                  std::wstring_view p_Separators) noexcept;
+    static SplitRange<SplitPart>
+                        SplitParts(std::wstring_view p_String,
+                                   std::wstring_view p_Separators) noexcept;
 
     static void         EncodeURICharacters(std::wstring& p_rString,
                                             EncodeParam p_EncodeParam);
+
+private:
+    static std::atomic<SimdLevel>
+                        s_MaxSimdLevel;     // Best instruction set vectorized kernels are allowed to use.
 };
@@ -0,0 +1,51 @@
+// Win32FileSystem.h
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include "FileSystem.h"
+
+
+namespace PCC
+{
+    //
+    // Win32FileSystem
+    //
+    // File system implementation that queries the actual file system
+    // through the Win32 API. Holds no state, so the same instance
+    // (see Instance) can be used by all threads.
+    //
+    class Win32FileSystem final : public FileSystem
+    {
+    public:
+                        Win32FileSystem() = default;
+
+        virtual DWORD   GetAttributes(const std::wstring& p_Path) const override;
+        virtual bool    GetFinalPath(const std::wstring& p_Path,
+                                     std::wstring& p_rFinalPath) const override;
+        virtual void    EnumerateFolder(const std::wstring& p_FolderPath,
+                                        std::vector<std::wstring>& p_rvNames) const override;
+
+        static Win32FileSystem&
+                        Instance() noexcept;
+    };
+
+} // namespace PCC
@@ -0,0 +1,121 @@
+// CachedFileSystem.cpp
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdafx.h>
+#include <CachedFileSystem.h>
+
+
+namespace PCC
+{
+    //
+    // Constructor.
+    //
+    // @param p_FileSystem File system whose results to cache. Must
+    //                     remain alive while this object is used.
+    //
+    CachedFileSystem::CachedFileSystem(const FileSystem& p_FileSystem)
+        : FileSystem(),
+          m_FileSystem(p_FileSystem),
+          m_mAttributes(),
+          m_ReparsePoints()
+    {
+    }
+
+    //
+    // Forgets all cached results. Should be called at the beginning
+    // of each operation, since files might have changed since then.
+    //
+    void CachedFileSystem::Clear() noexcept
+    {
+        m_mAttributes.clear();
+        m_ReparsePoints.Clear();
+    }
+
+    //
+    // Returns counters of hits and misses of the cache used to follow symlinks.
+    // Counters are reset when Clear is called.
+    //
+    // @return Reparse point cache statistics.
+    //
+    const ReparsePointCache::Stats& CachedFileSystem::GetReparsePointStats() const noexcept
+    {
+        return m_ReparsePoints.GetStats();
+    }
+
+    //
+    // Returns the attributes of a file or folder. Will query the wrapped
+    // file system only the first time a path is looked at.
+    //
+    // @param p_Path Path of file or folder.
+    // @return Attributes of file or folder, or INVALID_FILE_ATTRIBUTES.
+    //
+    DWORD CachedFileSystem::GetAttributes(const std::wstring& p_Path) const
+    {
+        auto it = m_mAttributes.find(p_Path);
+        if (it == m_mAttributes.end()) {
+            it = m_mAttributes.emplace(p_Path, m_FileSystem.GetAttributes(p_Path)).first;
+        }
+        return it->second;
+    }
+
+    //
+    // Returns the final path of a file or folder. Not cached.
+    //
+    // @param p_Path Path of file or folder.
+    // @param p_rFinalPath Where to store the final path.
+    // @return true if the final path could be determined.
+    //
+    bool CachedFileSystem::GetFinalPath(const std::wstring& p_Path,
+                                        std::wstring& p_rFinalPath) const
+    {
+        return m_FileSystem.GetFinalPath(p_Path, p_rFinalPath);
+    }
+
+    //
+    // Lists the names of the files and folders contained in a folder. Not cached.
+    //
+    // @param p_FolderPath Path of folder.
+    // @param p_rvNames Where to add the names of the folder's content.
+    //
+    void CachedFileSystem::EnumerateFolder(const std::wstring& p_FolderPath,
+                                           std::vector<std::wstring>& p_rvNames) const
+    {
+        m_FileSystem.EnumerateFolder(p_FolderPath, p_rvNames);
+    }
+
+    //
+    // Checks if a path or one of its parents is a reparse point and, if so,
+    // returns the path's final path. Parents already seen during this
+    // operation are not checked again, and paths under a known reparse
+    // point reuse its final path.
+    //
+    // @param p_Path Path to check.
+    // @param p_rFinalPath Where to store the final path; set to an empty
+    //                     string if it cannot be determined.
+    // @return true if p_Path or one of its parents is a reparse point.
+    //
+    bool CachedFileSystem::FollowSymlinks(const std::wstring& p_Path,
+                                          std::wstring& p_rFinalPath) const
+    {
+        return m_ReparsePoints.FollowSymlinks(*this, p_Path, p_rFinalPath);
+    }
+
+} // namespace PCC
@@ -0,0 +1,134 @@
+// FileSystem.cpp
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdafx.h>
+#include <FileSystem.h>
+#include <PathView.h>
+#include <Win32FileSystem.h>
+
+
+namespace
+{
+    // File system used by the current thread, if not the default one.
+    thread_local PCC::FileSystem* t_pCurrentFileSystem = nullptr;
+
+} // anonymous namespace
+
+namespace PCC
+{
+    //
+    // Checks if a path or one of its parents is a reparse point (like a symlink)
+    // and, if so, returns the path's final path. The default implementation
+    // checks each parent, then calls GetFinalPath on the entire path.
+    //
+    // @param p_Path Path to check.
+    // @param p_rFinalPath Where to store the final path, in the form returned
+    //                     by GetFinalPath. Set to an empty string if the
+    //                     final path cannot be determined.
+    // @return true if p_Path or one of its parents is a reparse point.
+    //
+    bool FileSystem::FollowSymlinks(const std::wstring& p_Path,
+                                    std::wstring& p_rFinalPath) const
+    {
+        bool found = IsReparsePoint(p_Path);
+        if (!found) {
+            // Parents are prefixes of the path, from the longest to the shortest,
+            // so a single copy of the path can be truncated to each of them in turn.
+            std::wstring parent(p_Path);
+            for (const std::wstring_view parentView : PathView::Parents(p_Path)) {
+                parent.resize(parentView.size());
+                if (IsReparsePoint(parent)) {
+                    found = true;
+                    break;
+                }
+            }
+        }
+        p_rFinalPath.clear();
+        if (found && !GetFinalPath(p_Path, p_rFinalPath)) {
+            p_rFinalPath.clear();
+        }
+        return found;
+    }
+
+    //
+    // Checks if a file or folder exists.
+    //
+    // @param p_Path Path of file or folder.
+    // @return true if p_Path exists.
+    //
+    bool FileSystem::Exists(const std::wstring& p_Path) const
+    {
+        return GetAttributes(p_Path) != INVALID_FILE_ATTRIBUTES;
+    }
+
+    //
+    // Checks if a path points to a directory.
+    //
+    // @param p_Path Path to check.
+    // @return true if p_Path exists and is a directory.
+    //
+    bool FileSystem::IsDirectory(const std::wstring& p_Path) const
+    {
+        const DWORD attributes = GetAttributes(p_Path);
+        return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+    }
+
+    //
+    // Checks if a path points to a reparse point, like a symlink or junction.
+    //
+    // @param p_Path Path to check.
+    // @return true if p_Path exists and is a reparse point.
+    //
+    bool FileSystem::IsReparsePoint(const std::wstring& p_Path) const
+    {
+        const DWORD attributes = GetAttributes(p_Path);
+        return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0;
+    }
+
+    //
+    // Returns the file system to use in the current thread. This is the
+    // one last installed through SetCurrent or, if none has been installed,
+    // the Win32 file system.
+    //
+    // @return Current file system.
+    //
+    FileSystem& FileSystem::Current() noexcept
+    {
+        return t_pCurrentFileSystem != nullptr ? *t_pCurrentFileSystem : Win32FileSystem::Instance();
+    }
+
+    //
+    // Changes the file system to use in the current thread.
+    // Usually called through StCurrentFileSystem.
+    //
+    // @param p_pFileSystem File system to use. If nullptr, the Win32
+    //                      file system will be used.
+    // @return File system that was previously installed, or nullptr
+    //         if the Win32 file system was used.
+    //
+    FileSystem* FileSystem::SetCurrent(FileSystem* const p_pFileSystem) noexcept
+    {
+        FileSystem* const pPrevious = t_pCurrentFileSystem;
+        t_pCurrentFileSystem = p_pFileSystem;
+        return pPrevious;
+    }
+
+} // namespace PCC
@@ -0,0 +1,315 @@
+// NetworkShareIndex.cpp
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdafx.h>
+#include <NetworkShareIndex.h>
+#include <PluginUtils.h>
+#include <StringUtils.h>
+
+#include <algorithm>
+#include <utility>
+
+
+namespace
+{
+    constexpr DWORD         INITIAL_BUFFER_SIZE         = 1024;     // Initial size of buffer used to fetch share info.
+    constexpr DWORD         MAX_REG_KEY_NAME_SIZE       = 255;      // Max size of a registry key's name.
+
+    const wchar_t* const    SHARES_KEY_NAME             = L"SYSTEM\\CurrentControlSet\\Services\\Lanmanserver\\Shares"; // Name of key storing network shares
+    const wchar_t* const    SHARE_PATH_VALUE            = L"Path=";     // Part of a share key's value containing the share path.
+    constexpr wchar_t       HIDDEN_SHARE_SUFFIX         = L'$';         // Suffix used for hidden shares.
+
+    constexpr DWORD         SHARES_NOTIFY_FILTER        = REG_NOTIFY_CHANGE_NAME | REG_NOTIFY_CHANGE_LAST_SET;  // Changes to shares key to be notified of.
+    constexpr DWORD         NOTIFY_THREAD_AGNOSTIC      = 0x10000000L;  // REG_NOTIFY_THREAD_AGNOSTIC, only defined when targeting Windows 8 and later.
+
+    //
+    // Checks if a character is a path separator.
+    //
+    // @param p_Char Character to check.
+    // @return true if p_Char is '\' or '/'.
+    //
+    bool IsSeparator(const wchar_t p_Char) noexcept
+    {
+        return p_Char == L'\\' || p_Char == L'/';
+    }
+
+} // anonymous namespace
+
+namespace PCC
+{
+    // Static members of NetworkShareIndex
+
+#pragma warning(push)
+#pragma warning(disable: 26426)
+
+    std::mutex                                  NetworkShareIndex::s_LocalSharesLock;
+    std::shared_ptr<const NetworkShareIndex>    NetworkShareIndex::s_spLocalShares;
+    ATL::CRegKey                                NetworkShareIndex::s_LocalSharesKey;
+    StHandle                                    NetworkShareIndex::s_LocalSharesChangedEvent;
+    std::atomic<bool>                           NetworkShareIndex::s_LocalSharesWatched(false);
+
+#pragma warning(pop)
+
+    //
+    // Constructor.
+    //
+    // @param p_Name Name of share. If it ends with '$', share is hidden.
+    // @param p_Path Local path of share.
+    //
+    NetworkShareIndex::Share::Share(std::wstring p_Name,
+                                    std::wstring p_Path)
+        : m_Name(std::move(p_Name)),
+          m_Path(std::move(p_Path)),
+          m_Hidden(!m_Name.empty() && m_Name.back() == HIDDEN_SHARE_SUFFIX)
+    {
+    }
+
+    //
+    // Constructor. Compiles share paths into a case-insensitive trie.
+    //
+    // @param p_vShares Shares to index. Shares with an empty path are
+    //                  ignored; if more than one share has the same path
+    //                  (ignoring case), the first one is used.
+    //
+    NetworkShareIndex::NetworkShareIndex(ShareV p_vShares)
+        : m_vShares(std::move(p_vShares)),
+          m_vNodes(),
+          m_TransitionChars(),
+          m_vTransitionNodes()
+    {
+        // First build the trie using separate transitions for each node.
+        std::vector<std::vector<std::pair<wchar_t, uint32_t>>> vvNodeTransitions(1);
+        std::vector<Node> vNodes(1);
+        for (size_t i = 0; i < m_vShares.size(); ++i) {
+            const Share& share = m_vShares[i];
+            uint32_t node = 0;
+            for (const wchar_t c : share.m_Path) {
+                const wchar_t upperC = StringUtils::ToUppercase(c);
+                auto& vTransitions = vvNodeTransitions[node];
+                auto it = std::lower_bound(vTransitions.begin(), vTransitions.end(), upperC,
+                                           [](const auto& p_Transition, const wchar_t p_Char) noexcept {
+                                               return p_Transition.first < p_Char;
+                                           });
+                if (it == vTransitions.end() || it->first != upperC) {
+                    const auto child = static_cast<uint32_t>(vvNodeTransitions.size());
+                    vTransitions.emplace(it, upperC, child);
+                    vvNodeTransitions.emplace_back();
+                    vNodes.emplace_back();
+                    node = child;
+                } else {
+                    node = it->second;
+                }
+            }
+            if (node != 0) {
+                if (vNodes[node].m_Share == NO_SHARE) {
+                    vNodes[node].m_Share = static_cast<uint32_t>(i);
+                }
+                if (!share.m_Hidden && vNodes[node].m_VisibleShare == NO_SHARE) {
+                    vNodes[node].m_VisibleShare = static_cast<uint32_t>(i);
+                }
+            }
+        }
+
+        // Now store all transitions together so that servers with
+        // many shares do not need one allocation per node.
+        m_vNodes = std::move(vNodes);
+        m_TransitionChars.reserve(vvNodeTransitions.size() - 1);
+        m_vTransitionNodes.reserve(vvNodeTransitions.size() - 1);
+        for (size_t i = 0; i < vvNodeTransitions.size(); ++i) {
+            Node& node = m_vNodes[i];
+            node.m_FirstTransition = static_cast<uint32_t>(m_vTransitionNodes.size());
+            node.m_NumTransitions = static_cast<uint32_t>(vvNodeTransitions[i].size());
+            for (const auto& transition : vvNodeTransitions[i]) {
+                m_TransitionChars.push_back(transition.first);
+                m_vTransitionNodes.push_back(transition.second);
+            }
+        }
+    }
+
+    //
+    // Returns the number of shares in the index.
+    //
+    // @return Number of shares, including hidden ones.
+    //
+    size_t NetworkShareIndex::GetNumShares() const noexcept
+    {
+        return m_vShares.size();
+    }
+
+    //
+    // Finds the share containing a path. If more than one share contains
+    // the path, the one with the longest path is returned. Share paths are
+    // compared case-insensitively and must match entire path parts, so
+    // that a share of "C:\Foo" does not contain "C:\FooBar".
+    //
+    // @param p_Path Local path to look for.
+    // @param p_UseHiddenShares Whether to consider hidden shares.
+    // @return Share containing p_Path, or nullptr if no share contains it.
+    //
+    auto NetworkShareIndex::Find(const std::wstring_view p_Path,
+                                 const bool p_UseHiddenShares) const noexcept -> const Share*
+    {
+        if (m_vNodes.empty()) {
+            return nullptr;
+        }
+
+        uint32_t node = 0;
+        uint32_t share = NO_SHARE;
+        for (size_t i = 0; i < p_Path.size(); ++i) {
+            const Node& curNode = m_vNodes[node];
+            const auto transitionsBegin = m_TransitionChars.cbegin() + curNode.m_FirstTransition;
+            const auto transitionsEnd = transitionsBegin + curNode.m_NumTransitions;
+            const wchar_t upperC = StringUtils::ToUppercase(p_Path[i]);
+            const auto it = std::lower_bound(transitionsBegin, transitionsEnd, upperC);
+            if (it == transitionsEnd || *it != upperC) {
+                break;
+            }
+            node = m_vTransitionNodes[it - m_TransitionChars.cbegin()];
+            const uint32_t nodeShare = p_UseHiddenShares ? m_vNodes[node].m_Share : m_vNodes[node].m_VisibleShare;
+            const bool atPartEnd = i + 1 == p_Path.size() || IsSeparator(p_Path[i]) || IsSeparator(p_Path[i + 1]);
+            if (nodeShare != NO_SHARE && atPartEnd) {
+                share = nodeShare;
+            }
+        }
+        return share != NO_SHARE ? &m_vShares[share] : nullptr;
+    }
+
+    //
+    // Returns the index of the local computer's network shares. The index
+    // is loaded from the registry the first time and kept in memory; it is
+    // loaded again only after the registry signals that the key storing
+    // shares has been modified (see WatchLocalShares). Until then, no lock
+    // is taken and the registry is not accessed.
+    //
+    // @return Index of local shares. Will be empty if shares cannot be read.
+    //
+    std::shared_ptr<const NetworkShareIndex> NetworkShareIndex::GetLocalShares()
+    {
+        auto spLocalShares = std::atomic_load(&s_spLocalShares);
+        if (spLocalShares != nullptr && !LocalSharesChanged()) {
+            return spLocalShares;
+        }
+
+        std::lock_guard<std::mutex> lock(s_LocalSharesLock);
+        spLocalShares = std::atomic_load(&s_spLocalShares);
+        if (spLocalShares == nullptr || LocalSharesChanged()) {
+            // Shares are stored in multi-string registry values in the Lanmanserver service keys.
+            // Register for the next change before reading them so that no change can be missed.
+            if (s_LocalSharesKey.m_hKey == nullptr) {
+                s_LocalSharesKey.Open(HKEY_LOCAL_MACHINE, SHARES_KEY_NAME, KEY_READ);
+            }
+            s_LocalSharesWatched = WatchLocalShares();
+            spLocalShares = std::make_shared<const NetworkShareIndex>(s_LocalSharesKey.m_hKey != nullptr
+                ? LoadLocalShares(s_LocalSharesKey) : ShareV());
+            std::atomic_store(&s_spLocalShares, spLocalShares);
+        }
+        return spLocalShares;
+    }
+
+    //
+    // Checks if the local shares might have changed since their index
+    // was loaded. If we could not register for registry notifications,
+    // we have to assume shares changed.
+    //
+    // @return true if local shares index needs to be loaded again.
+    //
+    bool NetworkShareIndex::LocalSharesChanged() noexcept
+    {
+        return !s_LocalSharesWatched || ::WaitForSingleObject(s_LocalSharesChangedEvent, 0) != WAIT_TIMEOUT;
+    }
+
+    //
+    // Asks the registry to signal s_LocalSharesChangedEvent the next time
+    // the key storing shares is modified. Must be called with the local
+    // shares lock held, before loading shares.
+    //
+    // Before Windows 8, notifications cannot be made thread-agnostic: the
+    // event is also signaled when the calling thread exits, which simply
+    // causes shares to be loaded again.
+    //
+    // @return true if registry notifications are registered.
+    //
+    bool NetworkShareIndex::WatchLocalShares() noexcept
+    {
+        if (s_LocalSharesKey.m_hKey == nullptr) {
+            return false;
+        }
+        if (s_LocalSharesChangedEvent == nullptr) {
+            s_LocalSharesChangedEvent = ::CreateEventW(nullptr, TRUE, FALSE, nullptr);
+            if (s_LocalSharesChangedEvent == nullptr) {
+                return false;
+            }
+        }
+
+        ::ResetEvent(s_LocalSharesChangedEvent);
+        LONG ret = s_LocalSharesKey.NotifyChangeKeyValue(FALSE, SHARES_NOTIFY_FILTER | NOTIFY_THREAD_AGNOSTIC,
+                                                         s_LocalSharesChangedEvent);
+        if (ret != ERROR_SUCCESS) {
+            ret = s_LocalSharesKey.NotifyChangeKeyValue(FALSE, SHARES_NOTIFY_FILTER, s_LocalSharesChangedEvent);
+        }
+        return ret == ERROR_SUCCESS;
+    }
+
+    //
+    // Loads info about the local computer's network shares from the registry.
+    //
+    // @param p_hSharesKey Handle to the registry key storing shares.
+    // @return Shares found in the registry, in registry order.
+    //
+    auto NetworkShareIndex::LoadLocalShares(ATL::CRegKey& p_rSharesKey) -> ShareV
+    {
+        // Iterate registry values to get each share.
+        ShareV vShares;
+        std::wstring valueName(MAX_REG_KEY_NAME_SIZE + 1, L'\0');
+        std::vector<wchar_t> vBuffer(INITIAL_BUFFER_SIZE, L'\0');
+        std::wstring multiStringValue;
+        LONG ret = 0;
+        DWORD i = 0;
+        do {
+            DWORD valueNameSize = MAX_REG_KEY_NAME_SIZE;
+            DWORD valueType = 0;
+            ret = ::RegEnumValue(p_rSharesKey, i, &*valueName.begin(), &valueNameSize, nullptr, &valueType, nullptr, nullptr);
+            if (ret == ERROR_SUCCESS && valueType == REG_MULTI_SZ && valueNameSize != 0) {
+                // Get the multi-string values. The buffer is reused for all shares.
+                ULONG bufferSize = gsl::narrow<ULONG>(vBuffer.size());
+                LONG queryRet = p_rSharesKey.QueryMultiStringValue(valueName.c_str(), vBuffer.data(), &bufferSize);
+                while (queryRet == ERROR_MORE_DATA) {
+                    vBuffer.resize(bufferSize, L'\0');
+                    queryRet = p_rSharesKey.QueryMultiStringValue(valueName.c_str(), vBuffer.data(), &bufferSize);
+                }
+                if (queryRet == ERROR_SUCCESS) {
+                    // Find the "Path=" part of the mult-string. This contains the share path.
+                    multiStringValue.assign(vBuffer.data(), bufferSize);
+                    std::wstring path = PluginUtils::GetMultiStringLineBeginningWith(multiStringValue, SHARE_PATH_VALUE);
+                    if (!path.empty()) {
+                        vShares.emplace_back(std::wstring(valueName.c_str(), valueNameSize), std::move(path));
+                    }
+                }
+            }
+
+            // Go to next share.
+            ++i;
+        } while (ret == ERROR_SUCCESS);
+
+        return vShares;
+    }
+
+} // namespace PCC
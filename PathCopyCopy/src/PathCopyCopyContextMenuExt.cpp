@@ -29,6 +29,8 @@
 #include <PathCopyCopySettingsApp.h>
 #include <PluginUtils.h>
 #include <PathAction.h>
+#include <StCurrentFileSystem.h>
+#include <Win32FileSystem.h>
 #include <StGdiplusStartup.h>
 #include <StGlobalBlock.h>
 #include <StGlobalLock.h>
@@ -38,8 +40,6 @@
 #include <functional>
 #include <set>
 
-#include <coveo/linq.h>
-
 #include <gdiplus.h>
 
 #pragma warning(disable: 26426) // Globals are only used by COM objects created later, so we're OK here
@@ -70,6 +70,7 @@ CPathCopyCopyContextMenuExt::CPathCopyCopyContextMenuExt() noexcept(false)
       m_vFiles(),
       m_FilesSelected(false),
       m_FoldersSelected(false),
+      m_FileSystem(PCC::Win32FileSystem::Instance()),
       m_FirstCmdId(),
       m_SubMenuCmdId(),
       m_SettingsCmdId(),
@@ -226,6 +227,10 @@ STDMETHODIMP CPathCopyCopyContextMenuExt::Initialize(
 {
     HRESULT hRes = S_OK;
 
+    // This starts a new menu operation; files might have changed since the last one.
+    m_FileSystem.Clear();
+    PCC::StCurrentFileSystem currentFileSystem(m_FileSystem);
+
     try {
         // Make sure we have a data object.
         if (p_pDataObject != nullptr) {
@@ -303,6 +308,7 @@ STDMETHODIMP CPathCopyCopyContextMenuExt::QueryContextMenu(
     UINT p_Flags)
 {
     HRESULT hRes = S_OK;
+    PCC::StCurrentFileSystem currentFileSystem(m_FileSystem);
 
     try {
         if (p_hMenu == nullptr) {
@@ -540,6 +546,11 @@ STDMETHODIMP CPathCopyCopyContextMenuExt::InvokeCommand(
 {
     HRESULT hRes = S_OK;
 
+    // Invoking a command is a new operation, since the user might have
+    // waited a while before choosing a menu item; start with a fresh cache.
+    m_FileSystem.Clear();
+    PCC::StCurrentFileSystem currentFileSystem(m_FileSystem);
+
     try {
         if ((p_pCommandInfo == nullptr) || (p_pCommandInfo->cbSize < sizeof(CMINVOKECOMMANDINFO))) {
             hRes = E_INVALIDARG;
@@ -1073,8 +1084,6 @@ HBITMAP CPathCopyCopyContextMenuExt::GetIconForIconFile(const std::wstring& p_Ic
 HRESULT CPathCopyCopyContextMenuExt::ActOnFiles(const PCC::PluginSP& p_spPlugin,
                                                 HWND const p_hWnd)
 {
-    using namespace coveo::linq;
-
     HRESULT hRes = E_FAIL;
 
     if (p_spPlugin != nullptr) {
@@ -1092,14 +1101,17 @@ HRESULT CPathCopyCopyContextMenuExt::ActOnFiles(const PCC::PluginSP& p_spPlugin,
             }
         }
         PCC::FilesV vNewFiles;
-        PCC::FilesV vFiles = GetFilesToActOn(recursively);
-        for (const auto& oldName : vFiles) {
-            // Ask plugin to compute filename using its scheme and save it.
+        PCC::FilesV vNewNames = GetFilesToActOn(recursively);
+        vNewFiles.reserve(vNewNames.size());
+
+        // Ask plugin to compute filenames using its scheme, all at once.
+        p_spPlugin->GetPaths(vNewNames);
+        for (auto& newName : vNewNames) {
+            // Apply global options to the filename and save it.
             std::wstring newFile;
             if (makeEmailLinks) {
                 newFile += L"<";
             }
-            std::wstring newName = p_spPlugin->GetPath(oldName);
             StringUtils::EncodeURICharacters(newName, encodeParam);
             if (addQuotes) {
                 AddQuotes(newName, areQuotesOptional);
@@ -1111,10 +1123,11 @@ HRESULT CPathCopyCopyContextMenuExt::ActOnFiles(const PCC::PluginSP& p_spPlugin,
             vNewFiles.emplace_back(std::move(newFile));
         }
 
-        // Sort files alphabetically (case-insensitively).
-        vNewFiles = from(vNewFiles)
-                  | order_by([](auto&& file) { return StringUtils::ToUppercase(file); })
-                  | to_vector();
+        // Sort files alphabetically (case-insensitively), unless user
+        // wants to keep them in the order they were selected.
+        if (!GetSettings().GetPreserveSelectionOrder()) {
+            StringUtils::SortCaseInsensitively(vNewFiles);
+        }
 
         // Convert vector of filenames to a string using path separator.
         std::wstring newFiles;
@@ -1173,28 +1186,18 @@ PCC::FilesV CPathCopyCopyContextMenuExt::GetFilesToActOn(const bool p_Recursivel
     auto vFiles(m_vFiles);
 
     if (p_Recursively) {
+        const PCC::FileSystem& fileSystem = PCC::FileSystem::Current();
         auto vNewFiles(vFiles);
+        PCC::WStringV vFileNames;
         while (!vNewFiles.empty()) {
             PCC::FilesV vFilesToScan;
             vFilesToScan.swap(vNewFiles);
             for (const auto& fileToScan : vFilesToScan) {
-                auto attributes = ::GetFileAttributesW(fileToScan.c_str());
-                if (attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0) {
-                    WIN32_FIND_DATAW findData;
-                    HANDLE hFind = ::FindFirstFileW((fileToScan + L"\\*").c_str(), &findData);
-                    if (hFind != INVALID_HANDLE_VALUE) {
-                        try {
-                            do {
-                                const std::wstring fileName = findData.cFileName;
-                                if (fileName != L"." && fileName != L"..") {
-                                    vNewFiles.emplace_back(fileToScan + L"\\" + fileName);
-                                }
-                            } while (::FindNextFileW(hFind, &findData));
-                            ::FindClose(hFind);
-                        } catch (...) {
-                            ::FindClose(hFind);
-                            throw;
-                        }
+                if (fileSystem.IsDirectory(fileToScan)) {
+                    vFileNames.clear();
+                    fileSystem.EnumerateFolder(fileToScan, vFileNames);
+                    for (const auto& fileName : vFileNames) {
+                        vNewFiles.emplace_back(fileToScan + L"\\" + fileName);
                     }
                 }
             }
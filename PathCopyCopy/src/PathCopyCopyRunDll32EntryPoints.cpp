@@ -22,13 +22,19 @@
 #include <stdafx.h>
 #include <AllPluginsProvider.h>
 #include <AtlRegKey.h>
+#include <CachedFileSystem.h>
 #include <PathCopyCopyRunDll32EntryPoints.h>
 #include <PathCopyCopyPluginsRegistry.h>
 #include <PathCopyCopySettings.h>
+#include <PluginPipelineProfiler.h>
 #include <StClipboard.h>
 #include <StCoInitialize.h>
+#include <StCurrentFileSystem.h>
 #include <StGlobalBlock.h>
 #include <StGlobalLock.h>
+#include <Win32FileSystem.h>
+
+#include <sstream>
 
 #pragma warning(disable: 26461) // Some pointers could point to const, but per API they shouldn't
 
@@ -41,6 +47,27 @@ namespace
     // Registry key in HKEY_CURRENT_USER where to output rundll32 results.
     const wchar_t* const    PCC_RUNDLL32_OUTPUT_KEY     = L"Software\\clechasseur\\PathCopyCopy\\Rundll32Output";
 
+    //
+    // Returns a report of the hits and misses of the cache used to follow
+    // symlinks, to append to a pipeline profiling report.
+    //
+    // @param p_Stats Reparse point cache statistics.
+    // @return Report, with a header line and a line of counters.
+    //
+    std::wstring ReparsePointStatsReport(const PCC::ReparsePointCache::Stats& p_Stats)
+    {
+        std::wostringstream wos;
+        wos << L"Cache\tPartHits\tPartMisses\tPartHitRate\tTargetHits\tTargetMisses\tTargetHitRate" << std::endl;
+        wos << L"ReparsePoints\t"
+            << p_Stats.m_NumPartHits << L'\t'
+            << p_Stats.m_NumPartMisses << L'\t'
+            << p_Stats.GetPartHitRate() << L'\t'
+            << p_Stats.m_NumTargetHits << L'\t'
+            << p_Stats.m_NumTargetMisses << L'\t'
+            << p_Stats.GetTargetHitRate() << std::endl;
+        return wos.str();
+    }
+
 } // anonymous namespace
 
 //
@@ -340,3 +367,109 @@ void CALLBACK ApplyUserRevisionsW(HWND /*p_hWnd*/,
         // Can't do much, don't crash rundll32.
     }
 }
+
+//
+// ProfilePipelinePluginW
+//
+// Function that can be called with rundll32.exe to profile a specific
+// pipeline plugin. The plugin is invoked a number of times on a path with
+// pipeline profiling enabled, then the profiling report is saved to a
+// registry value. The command-line must first contain the plugin's GUID,
+// then the value name, then the number of times to invoke the plugin,
+// then the path to convert, all separated by commas. Call like this:
+//
+// rundll32.exe path\to\PCCxx.dll,ProfilePipelinePlugin {guid},reg_value_name,count,path\to\convert
+//
+// The report will be saved in the specified registry value in
+//
+// HKEY_CURRENT_USER\Software\clechasseur\PathCopyCopy\Rundll32Output
+//
+// The report contains one line per element of each pipeline that was used
+// (including pipelines used by the profiled plugin). See PipelineProfiler.
+// Like during a menu operation, file system queries go through a
+// CachedFileSystem; the report ends with the hits and misses of the
+// cache it uses to follow symlinks (see ReparsePointCache::Stats).
+//
+// p_hWnd         - Window handle to use as parent for our windows.
+// p_hDllInstance - Instance handle for our DLL; ignored.
+// p_pCmdLine     - Command-line passed to rundll32.
+// p_ShowCmd      - How to show any window; ignored.
+//
+void CALLBACK ProfilePipelinePluginW(HWND /*p_hWnd*/,
+                                     HINSTANCE /*p_hDllInstance*/,
+                                     LPWSTR p_pCmdLine,
+                                     int /*p_ShowCmd*/)
+{
+    // Initialize COM so that COM plugins can work.
+    StCoInitialize coInit;
+
+    // Assume we won't be able to profile the plugin.
+    std::wstring report;
+    std::wstring regValueName;
+
+    try {
+        // Parse command-line and separate the guid from the value name, count and path.
+        std::wstring cmdLine(p_pCmdLine);
+        std::wstring::size_type sepPos = cmdLine.find(RUNDLL32_CMDLINE_SEPARATOR);
+        if (sepPos != std::wstring::npos) {
+            // Convert GUID and get the plugin.
+            cmdLine.at(sepPos) = L'\0';
+            CLSID pluginId = { 0 };
+            if (SUCCEEDED(::CLSIDFromString(&*cmdLine.begin(), &pluginId))) {
+                PCC::Settings settings;
+                PCC::PluginSPV vspPlugins = PCC::PluginsRegistry::GetPluginsInDefaultOrder(
+                    &settings, &settings, PCC::PipelinePluginsOptions::FetchBoth);
+                PCC::PluginSPS sspAllPlugins(vspPlugins.cbegin(), vspPlugins.cend());
+                PCC::AllPluginsProvider pluginProvider(sspAllPlugins);
+                for (const PCC::PluginSP& spPlugin : sspAllPlugins) {
+                    spPlugin->SetSettings(&settings);
+                    spPlugin->SetPluginProvider(&pluginProvider);
+                }
+                const auto it = sspAllPlugins.find(pluginId);
+                if (it != sspAllPlugins.end()) {
+                    // Separate the value name from the count.
+                    cmdLine.erase(cmdLine.begin(), cmdLine.begin() + sepPos + 1);
+                    sepPos = cmdLine.find(RUNDLL32_CMDLINE_SEPARATOR);
+                    if (sepPos != std::wstring::npos) {
+                        regValueName.assign(cmdLine.begin(), cmdLine.begin() + sepPos);
+
+                        // Separate the count from the path.
+                        cmdLine.erase(cmdLine.begin(), cmdLine.begin() + sepPos + 1);
+                        sepPos = cmdLine.find(RUNDLL32_CMDLINE_SEPARATOR);
+                        if (sepPos != std::wstring::npos) {
+                            // Call GetPath method on plugin the requested number of times while profiling.
+                            const unsigned long count = std::wcstoul(cmdLine.c_str(), nullptr, 10);
+                            const std::wstring path(cmdLine.begin() + sepPos + 1, cmdLine.end());
+                            const PCC::PluginSP& spPlugin = *it;
+                            PCC::CachedFileSystem fileSystem(PCC::Win32FileSystem::Instance());
+                            PCC::PipelineProfiler::Reset();
+                            PCC::PipelineProfiler::SetEnabled(true);
+                            {
+                                PCC::StCurrentFileSystem currentFileSystem(fileSystem);
+                                for (unsigned long i = 0; i < count; ++i) {
+                                    spPlugin->GetPath(path);
+                                }
+                            }
+                            PCC::PipelineProfiler::SetEnabled(false);
+                            report = PCC::PipelineProfiler::Report();
+                            report += ReparsePointStatsReport(fileSystem.GetReparsePointStats());
+                        }
+                    }
+                }
+            }
+        }
+    } catch (...) {
+        // Assume plugin won't work.
+        PCC::PipelineProfiler::SetEnabled(false);
+        report.clear();
+        regValueName.clear();
+    }
+
+    // Save report to the registry.
+    if (!report.empty() && !regValueName.empty()) {
+        AtlRegKey outputKey(HKEY_CURRENT_USER, PCC_RUNDLL32_OUTPUT_KEY, true, KEY_SET_VALUE);
+        if (outputKey.Valid()) {
+            outputKey.SetStringValue(regValueName.c_str(), report.c_str());
+        }
+    }
+}
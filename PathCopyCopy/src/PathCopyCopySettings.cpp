@@ -70,6 +70,7 @@ namespace
     const wchar_t* const    SETTING_COPY_PATHS_RECURSIVELY                  = L"CopyPathsRecursively";
     const wchar_t* const    SETTING_PATHS_SEPARATOR                         = L"PathsSeparator";
     const wchar_t* const    SETTING_TRUE_LNK_PATHS                          = L"TrueLnkPaths";
+    const wchar_t* const    SETTING_PRESERVE_SELECTION_ORDER                = L"PreserveSelectionOrder";
     const wchar_t* const    SETTING_WSL_PATH_PREFIX                         = L"WSLPathPrefix";
     const wchar_t* const    SETTING_CTRL_KEY_PLUGIN                         = L"CtrlKeyPlugin";
     const wchar_t* const    SETTING_MAIN_MENU_PLUGIN_DISPLAY_ORDER          = L"MainMenuDisplayOrder";
@@ -116,6 +117,7 @@ namespace
     constexpr bool          SETTING_COPY_PATHS_RECURSIVELY_DEFAULT          = false;
     const wchar_t* const    SETTING_PATHS_SEPARATOR_DEFAULT                 = L"";
     constexpr bool          SETTING_TRUE_LNK_PATHS_DEFAULT                  = false;
+    constexpr bool          SETTING_PRESERVE_SELECTION_ORDER_DEFAULT        = false;
     const wchar_t* const    SETTING_WSL_PATH_PREFIX_DEFAULT                 = L"/mnt";
     constexpr double        SETTING_UPDATE_INTERVAL_DEFAULT                 = 86400.0;      // One day, in seconds.
     constexpr bool          SETTING_DISABLE_SOFTWARE_UPDATE_DEFAULT         = false;
@@ -582,6 +584,26 @@ namespace PCC
         return trueLnkPaths;
     }
 
+    //
+    // Returns whether we want to copy paths in the order in which files
+    // were selected instead of sorting them alphabetically.
+    //
+    // @return true to skip sorting paths.
+    //
+    bool Settings::GetPreserveSelectionOrder() const
+    {
+        // Perform late-revising.
+        Revise();
+
+        // Check if value exists. If so, read it, otherwise use default value.
+        bool preserveSelectionOrder = SETTING_PRESERVE_SELECTION_ORDER_DEFAULT;
+        DWORD regPreserveSelectionOrder = 0;
+        if (m_UserKey.QueryDWORDValue(SETTING_PRESERVE_SELECTION_ORDER, regPreserveSelectionOrder) == ERROR_SUCCESS) {
+            preserveSelectionOrder = regPreserveSelectionOrder != 0;
+        }
+        return preserveSelectionOrder;
+    }
+
     //
     // Returns the prefix to use to build WSL paths.
     //
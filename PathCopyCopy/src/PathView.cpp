@@ -0,0 +1,383 @@
+// PathView.cpp
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdafx.h>
+#include <PathView.h>
+#include <StringUtils.h>
+
+#include <assert.h>
+
+
+namespace
+{
+    const StringUtils::CharClass    PATH_SEPARATORS(L"\\/");    // Characters separating path parts
+
+} // anonymous namespace
+
+namespace PCC
+{
+    //
+    // Constructor. Parses the given path.
+    //
+    // @param p_Path Path to parse. Must outlive the view.
+    //
+    PathView::PathView(const std::wstring_view p_Path)
+    {
+        Parse(p_Path);
+    }
+
+    //
+    // Parses a path in a single pass, replacing any path parsed before.
+    // Memory used by a previous path is reused if possible.
+    //
+    // @param p_Path Path to parse. Must outlive the view.
+    //
+    void PathView::Parse(const std::wstring_view p_Path)
+    {
+        m_Path = p_Path;
+        m_RootKind = ParseRoot(p_Path, m_RootSize);
+        m_FirstSeparator = L'\0';
+        m_vParts.clear();
+        m_vParentSizes.clear();
+        m_ExtensionPos = std::wstring_view::npos;
+
+        // Most paths have less parts than this, so it avoids growing vectors.
+        constexpr size_t INITIAL_CAPACITY = 16;
+        m_vParts.reserve(INITIAL_CAPACITY);
+        m_vParentSizes.reserve(INITIAL_CAPACITY);
+
+        // Parts are found by jumping from one separator to the next.
+        size_t partBegin = 0;
+        while (partBegin < p_Path.size()) {
+            size_t partEnd = StringUtils::FindFirstOf(p_Path, PATH_SEPARATORS, partBegin);
+            if (partEnd == std::wstring_view::npos) {
+                partEnd = p_Path.size();
+            }
+            if (partEnd != partBegin) {
+                m_vParts.emplace_back(partBegin, partEnd);
+            }
+            if (m_FirstSeparator == L'\0' && partEnd < p_Path.size()) {
+                m_FirstSeparator = p_Path[partEnd];
+            }
+            partBegin = partEnd + 1;
+        }
+
+        // The extension starts at the last dot of the last part, if it is
+        // followed by at least one character and is not the part's first character.
+        // If the path ends with a separator, its last part is empty.
+        if (!m_vParts.empty() && m_vParts.back().second == p_Path.size()) {
+            const size_t leafBegin = m_vParts.back().first;
+            const size_t dotPos = p_Path.substr(leafBegin).rfind(L'.');
+            if (dotPos != std::wstring_view::npos && dotPos > 0 && leafBegin + dotPos + 1 < p_Path.size()) {
+                m_ExtensionPos = leafBegin + dotPos;
+            }
+        }
+
+        // Parents are found by truncating the path at each separator, starting
+        // from the end, like PluginUtils::ExtractFolderFromPath. Separators are
+        // found between parts. Once we reach a separator kept in its parent,
+        // truncating would not change it anymore.
+        size_t currentSize = p_Path.size();
+        size_t separatorsEnd = p_Path.size();
+        for (size_t partIndex = m_vParts.size(); ; --partIndex) {
+            const size_t separatorsBegin = partIndex > 0 ? m_vParts[partIndex - 1].second : 0;
+            for (size_t separatorPos = separatorsEnd; separatorPos > separatorsBegin; ) {
+                --separatorPos;
+                const size_t parentSize = GetParentSize(separatorPos);
+                if (parentSize == currentSize) {
+                    return;
+                }
+                m_vParentSizes.push_back(parentSize);
+                currentSize = parentSize;
+                if (parentSize > separatorPos) {
+                    return;
+                }
+            }
+            if (partIndex == 0) {
+                break;
+            }
+            separatorsEnd = m_vParts[partIndex - 1].first;
+        }
+    }
+
+    //
+    // Returns the path that was parsed.
+    //
+    // @return Path parsed.
+    //
+    std::wstring_view PathView::Path() const noexcept
+    {
+        return m_Path;
+    }
+
+    //
+    // Returns the kind of root of the path.
+    //
+    // @return Kind of root.
+    //
+    PathView::RootKind PathView::GetRootKind() const noexcept
+    {
+        return m_RootKind;
+    }
+
+    //
+    // Returns the size of the path's root. See GetRootSize.
+    //
+    // @return Size of root, or 0 if path is relative.
+    //
+    size_t PathView::RootSize() const noexcept
+    {
+        return m_RootSize;
+    }
+
+    //
+    // Returns the first separator found in the path. Can be used
+    // to auto-detect the type of separators used by the path.
+    //
+    // @return First separator, or L'\0' if path has no separator.
+    //
+    wchar_t PathView::FirstSeparator() const noexcept
+    {
+        return m_FirstSeparator;
+    }
+
+    //
+    // Returns the number of parts in the path. Parts are the non-empty
+    // strings found between separators, including the root's parts
+    // (for example, "C:" or UNC server names).
+    //
+    // @return Number of path parts.
+    //
+    size_t PathView::NumParts() const noexcept
+    {
+        return m_vParts.size();
+    }
+
+    //
+    // Returns a part of the path.
+    //
+    // @param p_Index Index of part; must be less than NumParts.
+    // @return View of part in path.
+    //
+    std::wstring_view PathView::Part(const size_t p_Index) const noexcept
+    {
+        assert(p_Index < m_vParts.size());
+        const auto& part = m_vParts[p_Index];
+        return m_Path.substr(part.first, part.second - part.first);
+    }
+
+    //
+    // Returns the separators found before a part of the path.
+    //
+    // @param p_Index Index of part; must be less than NumParts.
+    // @return View of separators before part in path; empty for a first
+    //         part not preceded by separators.
+    //
+    std::wstring_view PathView::SeparatorsBefore(const size_t p_Index) const noexcept
+    {
+        assert(p_Index < m_vParts.size());
+        const size_t separatorsBegin = p_Index > 0 ? m_vParts[p_Index - 1].second : 0;
+        return m_Path.substr(separatorsBegin, m_vParts[p_Index].first - separatorsBegin);
+    }
+
+    //
+    // Returns the number of parents of the path. See Parent.
+    //
+    // @return Number of parents.
+    //
+    size_t PathView::NumParents() const noexcept
+    {
+        return m_vParentSizes.size();
+    }
+
+    //
+    // Returns one of the path's parents. Parents are ordered from the
+    // closest to the farthest, like PluginUtils::EnumerateParents returns
+    // them; the last one is the path's root, if it has one. For example,
+    // the parents of "C:\Foo\Bar.txt" are "C:\Foo" and "C:\".
+    //
+    // @param p_Index Index of parent; must be less than NumParents.
+    // @return View of parent in path.
+    //
+    std::wstring_view PathView::Parent(const size_t p_Index) const noexcept
+    {
+        assert(p_Index < m_vParentSizes.size());
+        return m_Path.substr(0, m_vParentSizes[p_Index]);
+    }
+
+    //
+    // Returns the position of the path's file extension. The extension
+    // starts at the last dot of the path's last part, if it is not the
+    // part's first character and is followed by at least one character.
+    //
+    // @return Position of extension's dot, or npos if path has no extension.
+    //
+    size_t PathView::ExtensionPos() const noexcept
+    {
+        return m_ExtensionPos;
+    }
+
+    //
+    // Returns a lazy range of the parents of a path. Unlike Parent, does not
+    // require parsing the path; useful when only a few parents are needed,
+    // or to iterate parents of a path once.
+    //
+    // @param p_Path Path whose parents to iterate. Must outlive the range.
+    // @return Range of parents, from the closest to the farthest.
+    //
+    auto PathView::Parents(const std::wstring_view p_Path) noexcept -> ParentRange
+    {
+        return ParentRange(p_Path);
+    }
+
+    //
+    // Checks if a character is a path separator.
+    //
+    // @param p_Char Character to check.
+    // @return true if p_Char is a backslash or a forward slash.
+    //
+    bool PathView::IsSeparator(const wchar_t p_Char) noexcept
+    {
+        return p_Char == L'\\' || p_Char == L'/';
+    }
+
+    //
+    // Returns the size of a path's root. The root includes the separator
+    // that follows it, if any. Recognized roots are:
+    //
+    // - Drive letters, like "C:" or "C:\"
+    // - UNC server and share, like "\\server\share\"
+    // - Prefixed paths, like "\\?\C:\", "\\?\UNC\server\share\" or "\\.\device\"
+    // - A single separator, for paths relative to the current drive
+    //
+    // @param p_Path Path whose root to find.
+    // @return Size of root, or 0 if path is relative.
+    //
+    size_t PathView::GetRootSize(const std::wstring_view p_Path) noexcept
+    {
+        size_t rootSize = 0;
+        ParseRoot(p_Path, rootSize);
+        return rootSize;
+    }
+
+    //
+    // Returns the size of the parent obtained by truncating a path
+    // at a separator. The separator is not part of the parent, unless
+    // it is within the first three characters, like in "C:\".
+    //
+    // @param p_SeparatorPos Position of separator in path.
+    // @return Size of parent.
+    //
+    size_t PathView::GetParentSize(const size_t p_SeparatorPos) noexcept
+    {
+        return p_SeparatorPos <= 2 ? p_SeparatorPos + 1 : p_SeparatorPos;
+    }
+
+    //
+    // Finds the root of a path. See GetRootSize.
+    //
+    // @param p_Path Path whose root to find.
+    // @param p_rRootSize Where to store size of root, or 0 if path is relative.
+    // @return Kind of root.
+    //
+    PathView::RootKind PathView::ParseRoot(const std::wstring_view p_Path,
+                                           size_t& p_rRootSize) noexcept
+    {
+        // Skips a number of path parts starting at a given position,
+        // including the separator that follows the last one.
+        const auto skipParts = [&](size_t p_Pos, const size_t p_NumParts) noexcept {
+            for (size_t i = 0; i < p_NumParts; ++i) {
+                const auto separatorPos = StringUtils::FindFirstOf(p_Path, PATH_SEPARATORS, p_Pos);
+                if (separatorPos == std::wstring_view::npos) {
+                    return p_Path.size();
+                }
+                p_Pos = separatorPos + 1;
+            }
+            return p_Pos;
+        };
+        const auto isDrive = [&](const size_t p_Pos) noexcept {
+            return p_Path.size() >= p_Pos + 2 && p_Path[p_Pos + 1] == L':' &&
+                   ((p_Path[p_Pos] >= L'A' && p_Path[p_Pos] <= L'Z') || (p_Path[p_Pos] >= L'a' && p_Path[p_Pos] <= L'z'));
+        };
+        const auto driveRootSize = [&](const size_t p_Pos) noexcept {
+            return (p_Path.size() > p_Pos + 2 && IsSeparator(p_Path[p_Pos + 2])) ? p_Pos + 3 : p_Pos + 2;
+        };
+        const auto isUNCPrefix = [&](const size_t p_Pos) noexcept {
+            return p_Path.size() >= p_Pos + 3 &&
+                   StringUtils::ToUppercase(p_Path[p_Pos]) == L'U' &&
+                   StringUtils::ToUppercase(p_Path[p_Pos + 1]) == L'N' &&
+                   StringUtils::ToUppercase(p_Path[p_Pos + 2]) == L'C' &&
+                   (p_Path.size() == p_Pos + 3 || IsSeparator(p_Path[p_Pos + 3]));
+        };
+
+        RootKind rootKind = RootKind::Relative;
+        p_rRootSize = 0;
+        if (p_Path.size() >= 2 && IsSeparator(p_Path[0]) && IsSeparator(p_Path[1])) {
+            if (p_Path.size() >= 4 && (p_Path[2] == L'?' || p_Path[2] == L'.') && IsSeparator(p_Path[3])) {
+                rootKind = RootKind::Prefixed;
+                if (isDrive(4)) {
+                    p_rRootSize = driveRootSize(4);
+                } else if (isUNCPrefix(4)) {
+                    p_rRootSize = skipParts(4, 3);
+                } else {
+                    p_rRootSize = skipParts(4, 1);
+                }
+            } else {
+                rootKind = RootKind::UNC;
+                p_rRootSize = skipParts(2, 2);
+            }
+        } else if (isDrive(0)) {
+            rootKind = RootKind::Drive;
+            p_rRootSize = driveRootSize(0);
+        } else if (!p_Path.empty() && IsSeparator(p_Path[0])) {
+            rootKind = RootKind::Rooted;
+            p_rRootSize = 1;
+        }
+        return rootKind;
+    }
+
+    //
+    // Returns the view of a path, parsing it if it is not the same as the
+    // last path looked up or if it was modified since (see Invalidate).
+    //
+    // @param p_Path Path whose view to return.
+    // @return View of p_Path, valid until p_Path is modified or the next call to Get.
+    //
+    const PathView& PathViewCache::Get(const std::wstring& p_Path)
+    {
+        if (!m_Valid || p_Path.data() != m_View.Path().data() || p_Path.size() != m_View.Path().size()) {
+            m_View.Parse(p_Path);
+            m_Valid = true;
+        }
+        return m_View;
+    }
+
+    //
+    // Tells the cache that the last path looked up has been modified,
+    // so that it is parsed again the next time it is looked up. Needed
+    // because modifications can leave the path's data and size as-is.
+    //
+    void PathViewCache::Invalidate() noexcept
+    {
+        m_Valid = false;
+    }
+
+} // namespace PCC
@@ -92,6 +92,21 @@ namespace PCC
         return true;
     }
 
+    //
+    // Returns the paths of a batch of files, as determined by the plugin's
+    // own path scheme. The default implementation calls GetPath for each
+    // file; plugins that can amortize work over many files can override this.
+    //
+    // @param p_Files Full paths to the files to get the paths for. Upon
+    //                return, each will contain the path according to plugin.
+    //
+    void Plugin::GetPaths(const gsl::span<std::wstring> p_Files) const
+    {
+        for (auto& file : p_Files) {
+            file = GetPath(file);
+        }
+    }
+
     //
     // Returns the separator to use between each path when using this plugin.
     // The default value is the empty string, which instructs PCC to use the
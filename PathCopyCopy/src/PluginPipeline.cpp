@@ -22,6 +22,10 @@
 #include <stdafx.h>
 #include <PluginPipeline.h>
 #include <PluginPipelineDecoder.h>
+#include <PluginPipelineOptimizer.h>
+#include <PluginPipelineProfiler.h>
+
+#include <chrono>
 
 
 namespace PCC
@@ -176,13 +180,18 @@ namespace PCC
         m_ShowForFolders = p_ShowForFolders;
     }
 
+    std::atomic<bool>       Pipeline::s_VerificationMode(false);
+    std::atomic<uint64_t>   Pipeline::s_NumVerificationFailures(0);
+
     //
     // Constructor with pre-built elements.
     //
     // @param p_vspElements List of elements in the pipeline.
     //
     Pipeline::Pipeline(const PipelineElementSPV& p_vspElements)
-        : m_vspElements(p_vspElements)
+        : m_vspElements(p_vspElements),
+          m_PluginId(GUID_NULL),
+          m_Program(PipelineOptimizer::Optimize(m_vspElements))
     {
     }
 
@@ -191,9 +200,14 @@ namespace PCC
     // built by decoding the string. See PipelineDecoder.
     //
     // @param p_EncodedElements Elements encoded in a string.
-    //
-    Pipeline::Pipeline(const std::wstring& p_EncodedElements)
-        : m_vspElements(PipelineDecoder::DecodePipeline(p_EncodedElements))
+    // @param p_PluginId ID of plugin owning the pipeline, if any.
+    //                   Used to identify the pipeline when profiling.
+    //
+    Pipeline::Pipeline(const std::wstring& p_EncodedElements,
+                       const GUID& p_PluginId /*= GUID_NULL*/)
+        : m_vspElements(PipelineDecoder::DecodePipeline(p_EncodedElements)),
+          m_PluginId(p_PluginId),
+          m_Program(PipelineOptimizer::Optimize(m_vspElements))
     {
     }
 
@@ -202,6 +216,7 @@ namespace PCC
     // are considered valid.
     //
     // When the pipeline is invalid, an InvalidPipelineException is thrown.
+    // Otherwise, the pipeline is bound to the plugin provider (see BindPlugins).
     //
     // @param p_pPluginProvider Optional plugin provider that can be used
     //                          during validation.
@@ -215,6 +230,29 @@ namespace PCC
         for (const auto& spElement : m_vspElements) {
             spElement->Validate(p_pPluginProvider, p_rsSeenPluginIds);
         }
+        BindPlugins(p_pPluginProvider);
+    }
+
+    //
+    // Binds the pipeline to a plugin provider. Plugins applied by the
+    // pipeline are looked up once instead of every time a path is modified
+    // with the same provider. The pipeline must be re-bound (or unbound)
+    // if the provider changes, since bound plugins are owned by the provider.
+    //
+    // @param p_pPluginProvider Object to access plugins. Can be nullptr.
+    //
+    void Pipeline::BindPlugins(const PluginProvider* const p_pPluginProvider) const
+    {
+        m_Program.Bind(p_pPluginProvider);
+    }
+
+    //
+    // Unbinds the pipeline from its plugin provider. Plugins will be
+    // looked up every time a path is modified until the pipeline is bound again.
+    //
+    void Pipeline::UnbindPlugins() const noexcept
+    {
+        m_Program.Unbind();
     }
 
 
@@ -228,12 +266,160 @@ namespace PCC
     void Pipeline::ModifyPath(std::wstring& p_rPath,
                               const PluginProvider* const p_pPluginProvider) const
     {
-        std::stack<std::wstring> aStack;
+        ModifyPaths(gsl::make_span(&p_rPath, 1), p_pPluginProvider);
+    }
+
+    //
+    // Modifies a batch of paths by successively applying all pipeline
+    // elements to each of them. This is equivalent to calling ModifyPath
+    // on each path, but the stack used by elements is created once and
+    // reused for the whole batch, so its memory is reused for each path.
+    //
+    // Elements are not called directly; instead, the pipeline's elements
+    // are optimized and compiled into a program that is run for each path.
+    // See PipelineOptimizer and PipelineProgram. In verification mode, the
+    // elements are also called directly to make sure results are the same.
+    // When profiling is enabled, elements are called directly instead to
+    // record counters for each element. See PipelineProfiler.
+    //
+    // @param p_Paths Paths to modify. Will be modified in-place.
+    // @param p_pPluginProvider Optional object to access plugins.
+    //
+    void Pipeline::ModifyPaths(const gsl::span<std::wstring> p_Paths,
+                               const PluginProvider* const p_pPluginProvider) const
+    {
+        if (PipelineProfiler::Enabled()) {
+            ProfilePaths(p_Paths, p_pPluginProvider);
+            return;
+        }
+
+        const bool verify = GetVerificationMode();
+        std::wstring originalPath;
+        PipelineStack aStack;
+        for (auto& path : p_Paths) {
+            if (verify) {
+                originalPath = path;
+            }
+
+            m_Program.Run(path, aStack, p_pPluginProvider);
+
+            // Each path must start with an empty stack.
+            aStack.Clear();
+
+            if (verify) {
+                VerifyPath(originalPath, path, p_pPluginProvider);
+            }
+        }
+    }
+
+    //
+    // Returns the program used to modify paths. Used to inline
+    // this pipeline in another pipeline's program.
+    //
+    // @return Reference to pipeline's program.
+    //
+    const PipelineProgram& Pipeline::GetProgram() const noexcept
+    {
+        return m_Program;
+    }
+
+    //
+    // Returns whether pipelines are in verification mode. In this mode,
+    // paths are modified both by the optimized pipeline and by calling
+    // all elements directly and the results are compared.
+    //
+    // Since elements are called twice for each path, this also repeats
+    // their side effects, like accessing the file system. Verification
+    // mode is thus disabled by default; it is meant to be enabled by
+    // tests. See GetNumVerificationFailures.
+    //
+    // @return true if verification mode is enabled.
+    //
+    bool Pipeline::GetVerificationMode() noexcept
+    {
+        return s_VerificationMode;
+    }
+
+    //
+    // Enables or disables verification mode for all pipelines.
+    // See GetVerificationMode.
+    //
+    // @param p_Verify Whether to enable verification mode.
+    //
+    void Pipeline::SetVerificationMode(const bool p_Verify) noexcept
+    {
+        s_VerificationMode = p_Verify;
+    }
+
+    //
+    // Returns the number of paths for which the result of the optimized
+    // pipeline differed from the result of calling elements directly
+    // while in verification mode. See GetVerificationMode.
+    //
+    // @return Number of verification failures since process started.
+    //
+    uint64_t Pipeline::GetNumVerificationFailures() noexcept
+    {
+        return s_NumVerificationFailures;
+    }
+
+    //
+    // Verifies the result of modifying a path with the optimized pipeline
+    // by calling all pipeline elements directly. If results differ, the
+    // failure is counted (see GetNumVerificationFailures) and the path is
+    // replaced with the result of the elements, which are the reference
+    // implementation.
+    //
+    // @param p_OriginalPath Path before it was modified.
+    // @param p_rPath Path modified by the optimized pipeline.
+    // @param p_pPluginProvider Optional object to access plugins.
+    //
+    void Pipeline::VerifyPath(const std::wstring& p_OriginalPath,
+                              std::wstring& p_rPath,
+                              const PluginProvider* const p_pPluginProvider) const
+    {
+        std::wstring referencePath(p_OriginalPath);
+        PipelineStack aStack;
         for (const auto& spElement : m_vspElements) {
-            spElement->ModifyPath(p_rPath, aStack, p_pPluginProvider);
+            spElement->ModifyPath(referencePath, aStack, p_pPluginProvider);
+            aStack.PathModified();
+        }
+
+        if (referencePath != p_rPath) {
+            ++s_NumVerificationFailures;
+            p_rPath = std::move(referencePath);
         }
     }
 
+    //
+    // Modifies a batch of paths by calling all pipeline elements directly
+    // and records the time spent in each element, as well as the size of
+    // the paths it receives and returns. Counters are recorded once for
+    // the whole batch. See PipelineProfiler.
+    //
+    // @param p_Paths Paths to modify. Will be modified in-place.
+    // @param p_pPluginProvider Optional object to access plugins.
+    //
+    void Pipeline::ProfilePaths(const gsl::span<std::wstring> p_Paths,
+                                const PluginProvider* const p_pPluginProvider) const
+    {
+        PipelineElementProfileV vProfiles(m_vspElements.size());
+        PipelineStack aStack;
+        for (auto& path : p_Paths) {
+            for (size_t i = 0; i < m_vspElements.size(); ++i) {
+                const size_t bytesIn = path.size() * sizeof(wchar_t);
+                const auto start = std::chrono::steady_clock::now();
+                m_vspElements[i]->ModifyPath(path, aStack, p_pPluginProvider);
+                const auto time = std::chrono::steady_clock::now() - start;
+                aStack.PathModified();
+                vProfiles[i].Add(std::chrono::duration_cast<std::chrono::nanoseconds>(time),
+                                 bytesIn, path.size() * sizeof(wchar_t));
+            }
+            aStack.Clear();
+        }
+        PipelineProfiler::Record(m_PluginId, vProfiles);
+    }
+
     //
     // Modifies global pipeline options by successively applying all pipeline
     // elements to it. Returns the final version of the pipeline options.
@@ -293,7 +479,7 @@ namespace PCC
     // @param p_pPluginProvider Optional object to access plugins.
     //
     void PipelineElement::ModifyPath(std::wstring& p_rPath,
-                                     std::stack<std::wstring>& /*p_rStack*/,
+                                     PipelineStack& /*p_rStack*/,
                                      const PluginProvider* const p_pPluginProvider) const noexcept(false)
     {
         // Most elements don't need the stack so just call the non-stack version.
@@ -340,6 +526,19 @@ namespace PCC
         return true;
     }
 
+    //
+    // Compiles this element into instructions of a PipelineProgram.
+    // The default implementation emits an instruction that calls the
+    // element's ModifyPath method. Elements that can be expressed
+    // using specific instructions can override this.
+    //
+    // @param p_rCompiler Compiler to use to emit instructions.
+    //
+    void PipelineElement::Compile(PipelineCompiler& p_rCompiler) const
+    {
+        p_rCompiler.EmitCallElement(*this);
+    }
+
     //
     // Default constructor.
     //
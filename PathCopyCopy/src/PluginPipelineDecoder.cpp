@@ -24,7 +24,6 @@
 #include <PluginPipelineElements.h>
 
 #include <assert.h>
-#include <sstream>
 
 
 namespace
@@ -41,10 +40,13 @@ namespace
     constexpr wchar_t   ELEMENT_CODE_FORWARD_TO_BACKSLASHES     = L'/';
     constexpr wchar_t   ELEMENT_CODE_REMOVE_EXT                 = L'.';
     constexpr wchar_t   ELEMENT_CODE_FIND_REPLACE               = L'?';
+    constexpr wchar_t   ELEMENT_CODE_MULTI_FIND_REPLACE         = L'*';
+    constexpr wchar_t   ELEMENT_CODE_PREFIX_MAP                 = L'p';
     constexpr wchar_t   ELEMENT_CODE_REGEX                      = L'^';
     constexpr wchar_t   ELEMENT_CODE_UNEXPAND_ENV_STRINGS       = L'e';
     constexpr wchar_t   ELEMENT_CODE_INJECT_DRIVE_LABEL         = L':';
     constexpr wchar_t   ELEMENT_CODE_COPY_N_PATH_PARTS          = L'n';
+    constexpr wchar_t   ELEMENT_CODE_NORMALIZE_PATH             = L'=';
     constexpr wchar_t   ELEMENT_CODE_APPLY_PLUGIN               = L'{';
     constexpr wchar_t   ELEMENT_CODE_APPLY_PIPELINE_PLUGIN      = L'}';
     constexpr wchar_t   ELEMENT_CODE_PUSH_TO_STACK              = L'u';
@@ -58,22 +60,133 @@ namespace
     constexpr wchar_t   ELEMENT_CODE_COMMAND_LINE               = L'>';
     constexpr wchar_t   ELEMENT_CODE_DISPLAY_FOR_SELECTION      = L'!';
 
+    // Maximum number of decoded pipelines kept in cache. When cache is full,
+    // the least recently used pipeline is dropped to make room for a new one.
+    constexpr size_t    MAX_DECODED_PIPELINES                   = 64;
+
     // Version numbers used for regex elements.
     constexpr long      REGEX_ELEMENT_INITIAL_VERSION           = 1;
     constexpr long      REGEX_ELEMENT_MAX_VERSION               = REGEX_ELEMENT_INITIAL_VERSION;
 
+    // Version numbers used for multi find/replace elements.
+    constexpr long      MULTI_FIND_REPLACE_ELEMENT_INITIAL_VERSION  = 1;
+    constexpr long      MULTI_FIND_REPLACE_ELEMENT_MAX_VERSION      = MULTI_FIND_REPLACE_ELEMENT_INITIAL_VERSION;
+
+    // Version numbers used for prefix map elements.
+    constexpr long      PREFIX_MAP_ELEMENT_INITIAL_VERSION      = 1;
+    constexpr long      PREFIX_MAP_ELEMENT_MAX_VERSION          = PREFIX_MAP_ELEMENT_INITIAL_VERSION;
+
+    //
+    // Parses an integer value stored as decimal digits in an encoded string.
+    // Parsing stops at the first character that is not a digit, like
+    // stream extraction would.
+    //
+    // @param p_Digits Characters containing the integer value.
+    // @return Integer value.
+    //
+    long ParseEncodedInteger(const std::wstring_view p_Digits) noexcept
+    {
+        auto it = p_Digits.cbegin();
+        const auto end = p_Digits.cend();
+        while (it != end && *it == L' ') {
+            ++it;
+        }
+        const bool negative = it != end && *it == L'-';
+        if (negative) {
+            ++it;
+        }
+
+        long value = 0;
+        for (; it != end && *it >= L'0' && *it <= L'9'; ++it) {
+            value = (value * 10) + (*it - L'0');
+        }
+        return negative ? -value : value;
+    }
+
 } // anonymous namespace
 
 namespace PCC
 {
+    std::mutex                          PipelineDecoder::s_DecodedPipelinesLock;
+    PipelineDecoder::DecodedPipelineM   PipelineDecoder::s_DecodedPipelines;
+    uint64_t                            PipelineDecoder::s_CacheClock = 0;
+
     //
     // Decodes a series of elements that were encoded by the settings application
     // in a string and produces a list of corresponding pipeline element objects.
     //
+    // Since pipeline elements are immutable, decoded pipelines are cached;
+    // decoding the same string again returns the same elements. The cache
+    // keeps up to MAX_DECODED_PIPELINES pipelines; when it is full, the
+    // least recently used pipeline is dropped, so strings that are no
+    // longer used (like edited pipelines) do not stay in memory.
+    //
+    // Some elements read files while being decoded (like prefix maps stored
+    // in a table file). The last write time of those files is recorded when
+    // the pipeline is decoded; if one of them has changed (or disappeared)
+    // when the pipeline is found in cache, the pipeline is decoded again,
+    // so the new content of the file is used the next time it is decoded.
+    //
     // @param p_EncodedElements Elements encoded in a string.
     // @return Vector of resulting elements.
     //
     auto PipelineDecoder::DecodePipeline(const std::wstring& p_EncodedElements) -> PipelineElementSPV
+    {
+        {
+            PipelineElementSPV vspCachedElements;
+            SourceFileV vCachedSourceFiles;
+            {
+                std::lock_guard<std::mutex> lock(s_DecodedPipelinesLock);
+                const auto it = s_DecodedPipelines.find(p_EncodedElements);
+                if (it != s_DecodedPipelines.end()) {
+                    it->second.m_LastUse = ++s_CacheClock;
+                    if (it->second.m_vSourceFiles.empty()) {
+                        return it->second.m_vspElements;
+                    }
+                    vspCachedElements = it->second.m_vspElements;
+                    vCachedSourceFiles = it->second.m_vSourceFiles;
+                }
+            }
+
+            // Check source files outside the lock since it hits the disk.
+            if (!vCachedSourceFiles.empty() && !SourceFilesChanged(vCachedSourceFiles)) {
+                return vspCachedElements;
+            }
+        }
+
+        // Decode outside the lock. If decoding fails, the exception
+        // propagates and nothing is cached.
+        SourceFileV vSourceFiles;
+        auto vspPipelineElements = DecodePipelineElements(p_EncodedElements, vSourceFiles);
+
+        std::lock_guard<std::mutex> lock(s_DecodedPipelinesLock);
+        if (s_DecodedPipelines.size() >= MAX_DECODED_PIPELINES &&
+            s_DecodedPipelines.find(p_EncodedElements) == s_DecodedPipelines.end()) {
+            // Cache is small, so finding the least recently used pipeline is cheap.
+            const auto lruIt = std::min_element(s_DecodedPipelines.begin(), s_DecodedPipelines.end(),
+                                                [](const auto& p_Left, const auto& p_Right) noexcept {
+                                                    return p_Left.second.m_LastUse < p_Right.second.m_LastUse;
+                                                });
+            s_DecodedPipelines.erase(lruIt);
+        }
+        // If pipeline is already in cache, it was either decoded by another thread
+        // in the meantime or its source files changed; in both cases, replace it.
+        auto& decodedPipeline = s_DecodedPipelines.insert_or_assign(p_EncodedElements,
+                                                                    DecodedPipeline { std::move(vspPipelineElements),
+                                                                                      std::move(vSourceFiles) }).first->second;
+        decodedPipeline.m_LastUse = ++s_CacheClock;
+        return decodedPipeline.m_vspElements;
+    }
+
+    //
+    // Performs the actual decoding of pipeline elements for DecodePipeline.
+    //
+    // @param p_EncodedElements Elements encoded in a string.
+    // @param p_rvSourceFiles Where to store info about files read while decoding.
+    // @return Vector of resulting elements.
+    //
+    auto PipelineDecoder::DecodePipelineElements(const std::wstring_view p_EncodedElements,
+                                                 SourceFileV& p_rvSourceFiles) -> PipelineElementSPV
     {
         EncodedElementsStream stream(p_EncodedElements);
         const size_t numElements = stream.ReadElementCount();
@@ -84,9 +197,25 @@ namespace PCC
             vspPipelineElements.emplace_back(DecodePipelineElement(stream));
         }
 
+        p_rvSourceFiles = std::move(stream.GetSourceFiles());
         return vspPipelineElements;
     }
 
+    //
+    // Checks if files read while decoding a pipeline have changed since.
+    //
+    // @param p_vSourceFiles Info about files read while decoding.
+    // @return true if at least one file has been modified or cannot be found.
+    //
+    bool PipelineDecoder::SourceFilesChanged(const SourceFileV& p_vSourceFiles)
+    {
+        return std::any_of(p_vSourceFiles.cbegin(), p_vSourceFiles.cend(), [](const auto& p_SourceFile) {
+            std::error_code errorCode;
+            const auto lastWriteTime = std::filesystem::last_write_time(std::filesystem::path(p_SourceFile.m_Path), errorCode);
+            return errorCode || lastWriteTime != p_SourceFile.m_LastWriteTime;
+        });
+    }
+
     //
     // Decodes a pipeline element found in an encoded pipeline elements stream.
     //
@@ -142,6 +271,14 @@ namespace PCC
                 spElement = DecodeFindReplaceElement(p_rStream);
                 break;
             }
+            case ELEMENT_CODE_MULTI_FIND_REPLACE: {
+                spElement = DecodeMultiFindReplaceElement(p_rStream);
+                break;
+            }
+            case ELEMENT_CODE_PREFIX_MAP: {
+                spElement = DecodePrefixMapElement(p_rStream);
+                break;
+            }
             case ELEMENT_CODE_REGEX: {
                 spElement = DecodeRegexElement(p_rStream);
                 break;
@@ -158,6 +295,10 @@ namespace PCC
                 spElement = DecodeCopyNPathPartsElement(p_rStream);
                 break;
             }
+            case ELEMENT_CODE_NORMALIZE_PATH: {
+                spElement = std::make_shared<NormalizePathPipelineElement>();
+                break;
+            }
             case ELEMENT_CODE_APPLY_PLUGIN:
             case ELEMENT_CODE_APPLY_PIPELINE_PLUGIN: {
                 spElement = DecodeApplyPluginElement(code, p_rStream);
@@ -177,6 +318,7 @@ namespace PCC
             }
             case ELEMENT_CODE_DUPLICATE_STACK_VALUE: {
                 spElement = std::make_shared<DuplicateStackValuePipelineElement>();
+                break;
             }
             case ELEMENT_CODE_PATHS_SEPARATOR: {
                 spElement = DecodePathsSeparatorElement(p_rStream);
@@ -226,6 +368,76 @@ namespace PCC
         return std::make_shared<FindReplacePipelineElement>(oldValue, newValue);
     }
 
+    //
+    // Decodes a MultiFindReplacePipelineElement found in an encoded stream.
+    //
+    // @param p_rStream Stream containing encoded element.
+    // @return Newly-created element.
+    //
+    auto PipelineDecoder::DecodeMultiFindReplaceElement(PipelineDecoder::EncodedElementsStream& p_rStream) -> PipelineElementSP
+    {
+        // The data starts by a version number, like for regex elements.
+        const auto version = p_rStream.ReadLong();
+        if (version > MULTI_FIND_REPLACE_ELEMENT_MAX_VERSION) {
+            throw InvalidPipelineException(ATL::CStringA(MAKEINTRESOURCEA(IDS_INVALIDPIPELINE_POSSIBLE_DOWNGRADE)));
+        }
+
+        // Initial version: number of pairs, followed by each old and new value.
+        const auto numPairs = p_rStream.ReadLong();
+        if (numPairs < 0) {
+            throw InvalidPipelineException();
+        }
+        WStringPairV vFindReplacePairs;
+        for (long i = 0; i < numPairs; ++i) {
+            auto oldValue = p_rStream.ReadString();
+            auto newValue = p_rStream.ReadString();
+            vFindReplacePairs.emplace_back(std::move(oldValue), std::move(newValue));
+        }
+
+        // Element will compile pairs into its automaton.
+        return std::make_shared<MultiFindReplacePipelineElement>(vFindReplacePairs);
+    }
+
+    //
+    // Decodes a PrefixMapPipelineElement found in an encoded stream.
+    //
+    // @param p_rStream Stream containing encoded element.
+    // @return Newly-created element.
+    //
+    auto PipelineDecoder::DecodePrefixMapElement(PipelineDecoder::EncodedElementsStream& p_rStream) -> PipelineElementSP
+    {
+        // The data starts by a version number, like for regex elements.
+        const auto version = p_rStream.ReadLong();
+        if (version > PREFIX_MAP_ELEMENT_MAX_VERSION) {
+            throw InvalidPipelineException(ATL::CStringA(MAKEINTRESOURCEA(IDS_INVALIDPIPELINE_POSSIBLE_DOWNGRADE)));
+        }
+
+        // Initial version: a flag telling whether table is stored in a file.
+        // If so, the file path follows; otherwise, the number of entries
+        // follows, then each prefix and replacement value. Large tables
+        // are better stored in a file since encoded strings are limited.
+        WStringPairV vPrefixReplacementPairs;
+        const auto fromFile = p_rStream.ReadBool();
+        if (fromFile) {
+            const auto filePath = p_rStream.ReadString();
+            p_rStream.AddSourceFile(filePath);
+            vPrefixReplacementPairs = PrefixMapPipelineElement::LoadTable(filePath);
+        } else {
+            const auto numEntries = p_rStream.ReadLong();
+            if (numEntries < 0) {
+                throw InvalidPipelineException();
+            }
+            for (long i = 0; i < numEntries; ++i) {
+                auto prefix = p_rStream.ReadString();
+                auto replacement = p_rStream.ReadString();
+                vPrefixReplacementPairs.emplace_back(std::move(prefix), std::move(replacement));
+            }
+        }
+
+        // Element will compile entries into its trie.
+        return std::make_shared<PrefixMapPipelineElement>(vPrefixReplacementPairs);
+    }
+
     //
     // Decodes a RegexPipelineElement found in an encoded stream.
     //
@@ -283,9 +495,12 @@ namespace PCC
         // (Note: GUIDSTRING_MAX includes the terminating null)
         const auto guidString = p_rStream.ReadData(GUIDSTRING_MAX - 1);
 
-        // Now that we have the data, convert it to a GUID.
+        // Now that we have the data, convert it to a GUID. We need a null-terminated
+        // string for this, so copy it to a buffer first.
+        wchar_t guidBuffer[GUIDSTRING_MAX] = { 0 };
+        guidString.copy(guidBuffer, GUIDSTRING_MAX - 1);
         CLSID pluginGuid;
-        if (FAILED(::CLSIDFromString(guidString.c_str(), &pluginGuid))) {
+        if (FAILED(::CLSIDFromString(guidBuffer, &pluginGuid))) {
             // Invalid GUID format.
             throw InvalidPipelineException();
         }
@@ -456,8 +671,9 @@ namespace PCC
     // Constructor.
     //
     // @param p_EncodedElements String containing encoded pipeline elements data.
+    //                          The stream does not copy it, so it must outlive the stream.
     //
-    PipelineDecoder::EncodedElementsStream::EncodedElementsStream(const std::wstring& p_EncodedElements)
+    PipelineDecoder::EncodedElementsStream::EncodedElementsStream(const std::wstring_view p_EncodedElements) noexcept
         : m_EncodedElements(p_EncodedElements),
           m_CurIndex(0)
     {
@@ -467,14 +683,14 @@ namespace PCC
     // Reads a number of characters from the stream.
     //
     // @param p_DataSize Size of data to read, in number of characters.
-    // @return String containing the data.
+    // @return View of the data in the encoded string.
     //
-    auto PipelineDecoder::EncodedElementsStream::ReadData(const std::wstring::size_type p_DataSize) -> std::wstring
+    auto PipelineDecoder::EncodedElementsStream::ReadData(const std::wstring_view::size_type p_DataSize) -> std::wstring_view
     {
         if (m_EncodedElements.size() - m_CurIndex < p_DataSize) {
             throw InvalidPipelineException();
         }
-        std::wstring data = m_EncodedElements.substr(m_CurIndex, p_DataSize);
+        const auto data = m_EncodedElements.substr(m_CurIndex, p_DataSize);
         m_CurIndex += p_DataSize;
         return data;
     }
@@ -493,10 +709,8 @@ namespace PCC
         // The first two characters are a string representation of the number
         // of elements in the pipeline (99 being the maximum number of elements
         // there can be).
-        std::wstringstream wss(ReadData(2));
-        size_t numElements = 0;
-        wss >> numElements;
-        return numElements;
+        const long numElements = ParseEncodedInteger(ReadData(2));
+        return numElements > 0 ? static_cast<size_t>(numElements) : 0;
     }
 
     //
@@ -507,10 +721,7 @@ namespace PCC
     auto PipelineDecoder::EncodedElementsStream::ReadLong() -> long
     {
         // Encoded as four consecutive characters corresponding to the integer value.
-        std::wstringstream wss(ReadData(4));
-        long intValue = 0;
-        wss >> intValue;
-        return intValue;
+        return ParseEncodedInteger(ReadData(4));
     }
 
     //
@@ -525,7 +736,7 @@ namespace PCC
 
         // Now that we know the length of the string that is encoded, we simply
         // need to copy that much characters from the encoded string.
-        return ReadData(stringSize);
+        return std::wstring(ReadData(stringSize));
     }
 
     //
@@ -543,4 +754,28 @@ namespace PCC
         return boolChar == L'1';
     }
 
+    //
+    // Records that a file is read while decoding elements. Its last write
+    // time is recorded now, before the file is read, so that a change made
+    // while it is being read is detected later.
+    //
+    // @param p_FilePath Path of file that will be read.
+    //
+    void PipelineDecoder::EncodedElementsStream::AddSourceFile(const std::wstring& p_FilePath)
+    {
+        std::error_code errorCode;
+        const auto lastWriteTime = std::filesystem::last_write_time(std::filesystem::path(p_FilePath), errorCode);
+        m_vSourceFiles.push_back({ p_FilePath, errorCode ? std::filesystem::file_time_type::min() : lastWriteTime });
+    }
+
+    //
+    // Returns info about files read while decoding elements.
+    //
+    // @return Source files recorded with AddSourceFile.
+    //
+    auto PipelineDecoder::EncodedElementsStream::GetSourceFiles() noexcept -> SourceFileV&
+    {
+        return m_vSourceFiles;
+    }
+
 } // namespace PCC
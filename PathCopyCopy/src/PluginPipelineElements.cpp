@@ -28,19 +28,100 @@
 
 #include <algorithm>
 #include <assert.h>
-#include <sstream>
-
-#include <coveo/linq.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
 
 
 namespace
 {
     const wchar_t* const    DRIVE_LABEL_IDENTIFIER  = L"%DRIVELABEL%";  // Identifier to replace with drive label
 
+    const StringUtils::CharClass
+                            PATH_SEPARATORS(L"\\/");                    // Characters separating path parts
+    const wchar_t* const    REGEX_LINE_TERMINATORS  = L"\r\n\u2028\u2029";  // Characters not matched by . in ECMAScript regexes
+
+    //
+    // Checks if a character is a path separator.
+    //
+    // @param p_Char Character to check.
+    // @return true if p_Char is a backslash or a forward slash.
+    //
+    bool IsPathSeparator(const wchar_t p_Char) noexcept
+    {
+        return p_Char == L'\\' || p_Char == L'/';
+    }
+
+    //
+    // Folds a character of a path prefix for case-insensitive comparison.
+    // Forward slashes are folded to backslashes so that both separators
+    // match each other.
+    //
+    // @param p_Char Character to fold.
+    // @return Folded character.
+    //
+    wchar_t FoldPrefixChar(const wchar_t p_Char) noexcept
+    {
+        return p_Char == L'/' ? L'\\' : StringUtils::ToUppercase(p_Char);
+    }
+
 } // anonymous namespace
 
 namespace PCC
 {
+    //
+    // Constructor. Compiles the regular expression right away.
+    // If the regex is invalid, it will be reported by Validate.
+    //
+    // @param p_Regex Regular expression. If empty, no regex is compiled.
+    // @param p_IgnoreCase Whether to ignore case when looking for matches.
+    //
+    PipelineRegex::PipelineRegex(const std::wstring& p_Regex,
+                                 const bool p_IgnoreCase)
+    {
+        if (!p_Regex.empty()) {
+            try {
+                m_upRegex = RegexBackend::Create(p_Regex, p_IgnoreCase);
+            } catch (const std::regex_error&) {
+                assert(m_upRegex == nullptr);
+                m_Valid = false;
+            }
+        }
+    }
+
+    //
+    // Returns the compiled regex object.
+    //
+    // @return Pointer to regex object, or nullptr if the regex
+    //         was empty or invalid.
+    //
+    const RegexBackend* PipelineRegex::Get() const noexcept
+    {
+        return m_upRegex.get();
+    }
+
+    //
+    // Checks whether the regex compiled successfully. An empty
+    // regex is considered valid even though Get returns nullptr.
+    //
+    // @return true if regex is valid.
+    //
+    bool PipelineRegex::IsValid() const noexcept
+    {
+        return m_Valid;
+    }
+
+    //
+    // Validates the regex. If it failed to compile, an
+    // InvalidPipelineException is thrown.
+    //
+    void PipelineRegex::Validate() const
+    {
+        if (!m_Valid) {
+            throw InvalidPipelineException(ATL::CStringA(MAKEINTRESOURCEA(IDS_INVALIDPIPELINE_INVALID_REGEX)));
+        }
+    }
+
     //
     // Modifies the given path by following the symlink if it
     // points to one.
@@ -67,6 +148,17 @@ namespace PCC
         p_rPath.append(1, L'\"');
     }
 
+    //
+    // Compiles this element into a PipelineProgram instruction
+    // that surrounds the path with quotes.
+    //
+    // @param p_rCompiler Compiler to use to emit instructions.
+    //
+    void QuotesPipelineElement::Compile(PipelineCompiler& p_rCompiler) const
+    {
+        p_rCompiler.Emit(PipelineOpcode::Quotes);
+    }
+
     //
     // Modifies the given path by surrounding it with quotes if the
     // path contains spaces.
@@ -77,12 +169,23 @@ namespace PCC
     void OptionalQuotesPipelineElement::ModifyPath(std::wstring& p_rPath,
                                                    const PluginProvider* const /*p_pPluginProvider*/) const
     {
-        if (p_rPath.find(' ') != std::wstring::npos) {
+        if (StringUtils::FindFirstOf(p_rPath, L" ") != std::wstring::npos) {
             p_rPath.insert(p_rPath.begin(), 1, L'\"');
             p_rPath.append(1, L'\"');
         }
     }
 
+    //
+    // Compiles this element into a PipelineProgram instruction
+    // that surrounds the path with quotes if it contains spaces.
+    //
+    // @param p_rCompiler Compiler to use to emit instructions.
+    //
+    void OptionalQuotesPipelineElement::Compile(PipelineCompiler& p_rCompiler) const
+    {
+        p_rCompiler.Emit(PipelineOpcode::OptionalQuotes);
+    }
+
     //
     // Modifies the given path by turning it into an e-mail link.
     //
@@ -96,6 +199,17 @@ namespace PCC
         p_rPath.append(1, L'>');
     }
 
+    //
+    // Compiles this element into a PipelineProgram instruction
+    // that turns the path into an e-mail link.
+    //
+    // @param p_rCompiler Compiler to use to emit instructions.
+    //
+    void EmailLinksPipelineElement::Compile(PipelineCompiler& p_rCompiler) const
+    {
+        p_rCompiler.Emit(PipelineOpcode::EmailLinks);
+    }
+
     //
     // Modifies the given path by encoding URI whitespace.
     //
@@ -129,7 +243,18 @@ namespace PCC
     void BackToForwardSlashesPipelineElement::ModifyPath(std::wstring& p_rPath,
                                                          const PluginProvider* const /*p_pPluginProvider*/) const
     {
-        std::replace(p_rPath.begin(), p_rPath.end(), L'\\', L'/');
+        StringUtils::ReplaceChar(p_rPath, L'\\', L'/');
+    }
+
+    //
+    // Compiles this element into a PipelineProgram instruction
+    // that replaces all backslashes by forward slashes.
+    //
+    // @param p_rCompiler Compiler to use to emit instructions.
+    //
+    void BackToForwardSlashesPipelineElement::Compile(PipelineCompiler& p_rCompiler) const
+    {
+        p_rCompiler.Emit(PipelineOpcode::BackToForwardSlashes);
     }
 
     //
@@ -141,7 +266,33 @@ namespace PCC
     void ForwardToBackslashesPipelineElement::ModifyPath(std::wstring& p_rPath,
                                                          const PluginProvider* const /*p_pPluginProvider*/) const
     {
-        std::replace(p_rPath.begin(), p_rPath.end(), L'/', L'\\');
+        StringUtils::ReplaceChar(p_rPath, L'/', L'\\');
+    }
+
+    //
+    // Compiles this element into a PipelineProgram instruction
+    // that replaces all forward slashes by backslashes.
+    //
+    // @param p_rCompiler Compiler to use to emit instructions.
+    //
+    void ForwardToBackslashesPipelineElement::Compile(PipelineCompiler& p_rCompiler) const
+    {
+        p_rCompiler.Emit(PipelineOpcode::ForwardToBackslashes);
+    }
+
+    //
+    // Modified our path by removing any file extension at the end of it.
+    // The path's structure is looked up in the stack's cache.
+    //
+    // @param p_rPath Path to modify (in-place).
+    // @param p_rStack Stack caching the structure of the path.
+    // @param p_pPluginProvider Optional object to access plugins.
+    //
+    void RemoveFileExtPipelineElement::ModifyPath(std::wstring& p_rPath,
+                                                  PipelineStack& p_rStack,
+                                                  const PluginProvider* const /*p_pPluginProvider*/) const
+    {
+        ModifyPath(p_rPath, p_rStack.GetPathView(p_rPath));
     }
 
     //
@@ -153,8 +304,27 @@ namespace PCC
     void RemoveFileExtPipelineElement::ModifyPath(std::wstring& p_rPath,
                                                   const PluginProvider* const /*p_pPluginProvider*/) const
     {
-        const std::wregex extRegex(L"^(.*[^\\\\/])(?:\\.[^\\\\/.]+)$", std::regex_constants::ECMAScript);
-        p_rPath = std::regex_replace(p_rPath, extRegex, L"$1");
+        ModifyPath(p_rPath, PathView(p_rPath));
+    }
+
+    //
+    // Modified our path by removing any file extension at the end of it.
+    //
+    // @param p_rPath Path to modify (in-place).
+    // @param p_PathView Structure of p_rPath.
+    //
+    void RemoveFileExtPipelineElement::ModifyPath(std::wstring& p_rPath,
+                                                  const PathView& p_PathView) const
+    {
+        // Like the regex ^(.*[^\\/])(?:\.[^\\/.]+)$ used previously, paths
+        // with a line break before the last character preceding the extension
+        // are left untouched.
+        const auto dotPos = p_PathView.ExtensionPos();
+        if (dotPos != std::wstring::npos &&
+            StringUtils::FindFirstOf(std::wstring_view(p_rPath.data(), dotPos - 1), REGEX_LINE_TERMINATORS) == std::wstring_view::npos) {
+
+            p_rPath.erase(dotPos);
+        }
     }
 
     //
@@ -166,7 +336,7 @@ namespace PCC
     FindReplacePipelineElement::FindReplacePipelineElement(const std::wstring& p_OldValue,
                                                            const std::wstring& p_NewValue)
         : PipelineElement(),
-          m_OldValue(p_OldValue),
+          m_OldValueSearcher(p_OldValue),
           m_NewValue(p_NewValue)
     {
     }
@@ -181,8 +351,328 @@ namespace PCC
     void FindReplacePipelineElement::ModifyPath(std::wstring& p_rPath,
                                                 const PluginProvider* const /*p_pPluginProvider*/) const
     {
-        if (!m_OldValue.empty()) {
-            StringUtils::ReplaceAll(p_rPath, m_OldValue, m_NewValue);
+        if (!m_OldValueSearcher.Pattern().empty()) {
+            StringUtils::ReplaceAll(p_rPath, m_OldValueSearcher, m_NewValue);
+        }
+    }
+
+    //
+    // Compiles this element into a PipelineProgram instruction that
+    // replaces all instances of our old value with our new value.
+    //
+    // @param p_rCompiler Compiler to use to emit instructions.
+    //
+    void FindReplacePipelineElement::Compile(PipelineCompiler& p_rCompiler) const
+    {
+        if (!m_OldValueSearcher.Pattern().empty()) {
+            p_rCompiler.Emit(PipelineOpcode::FindReplace,
+                             p_rCompiler.AddSearcher(m_OldValueSearcher),
+                             p_rCompiler.AddString(m_NewValue));
+        }
+    }
+
+    //
+    // Constructor. Compiles values to find into an Aho-Corasick automaton.
+    //
+    // @param p_vFindReplacePairs Pairs of values to find and their replacement.
+    //                            Empty values to find are ignored; if a value
+    //                            to find appears more than once, its first
+    //                            replacement is used.
+    //
+    MultiFindReplacePipelineElement::MultiFindReplacePipelineElement(const WStringPairV& p_vFindReplacePairs)
+        : PipelineElement(),
+          m_vNodes(1),
+          m_vReplacements(),
+          m_FirstChars(std::wstring_view())
+    {
+        // First build a trie of all values to find.
+        for (const auto& findReplacePair : p_vFindReplacePairs) {
+            uint32_t node = 0;
+            for (const wchar_t c : findReplacePair.first) {
+                auto& vTransitions = m_vNodes[node].m_vTransitions;
+                auto it = std::lower_bound(vTransitions.begin(), vTransitions.end(), c,
+                                           [](const auto& p_Transition, const wchar_t p_Char) noexcept {
+                                               return p_Transition.first < p_Char;
+                                           });
+                if (it == vTransitions.end() || it->first != c) {
+                    const auto child = static_cast<uint32_t>(m_vNodes.size());
+                    vTransitions.emplace(it, c, child);
+                    m_vNodes.emplace_back();
+                    m_vNodes.back().m_Depth = m_vNodes[node].m_Depth + 1;
+                    node = child;
+                } else {
+                    node = it->second;
+                }
+            }
+            if (node != 0 && m_vNodes[node].m_Replacement == NO_NODE) {
+                m_vReplacements.emplace_back(findReplacePair.second);
+                m_vNodes[node].m_Replacement = static_cast<uint32_t>(m_vReplacements.size() - 1);
+            }
+        }
+
+        // Remember first characters to be able to skip parts of path
+        // where no value to find can start. Character classes cannot
+        // hold specific non-ASCII characters, so they are all included
+        // if needed; the automaton will skip those that do not match.
+        std::wstring firstChars;
+        for (const auto& transition : m_vNodes.front().m_vTransitions) {
+            firstChars.push_back(transition.first);
+        }
+        const bool anyNonASCIIFirstChar = !firstChars.empty() && firstChars.back() >= 0x80;
+        m_FirstChars = StringUtils::CharClass(firstChars, anyNonASCIIFirstChar);
+
+        // Now compute failure and output links, breadth-first so that
+        // links of shorter prefixes are known when needed.
+        std::vector<uint32_t> vQueue;
+        vQueue.reserve(m_vNodes.size());
+        vQueue.push_back(0);
+        for (size_t i = 0; i < vQueue.size(); ++i) {
+            const uint32_t node = vQueue[i];
+            for (const auto& transition : m_vNodes[node].m_vTransitions) {
+                const uint32_t child = transition.second;
+                uint32_t failure = 0;
+                if (node != 0) {
+                    failure = Step(m_vNodes[node].m_Failure, transition.first);
+                }
+                Node& childNode = m_vNodes[child];
+                childNode.m_Failure = failure;
+                childNode.m_Output = childNode.m_Replacement != NO_NODE ? child : m_vNodes[failure].m_Output;
+                vQueue.push_back(child);
+            }
+        }
+    }
+
+    //
+    // Modifies the given path by replacing all values to find
+    // with their replacement value, in a single pass.
+    //
+    // @param p_rPath Path to modify (in-place).
+    // @param p_pPluginProvider Optional object to access plugins.
+    //
+    void MultiFindReplacePipelineElement::ModifyPath(std::wstring& p_rPath,
+                                                     const PluginProvider* const /*p_pPluginProvider*/) const
+    {
+        std::wstring newPath;
+        size_t copiedEnd = 0;
+        size_t pos = 0;
+        uint32_t node = 0;
+        size_t matchBegin = std::wstring::npos;
+        size_t matchEnd = 0;
+        uint32_t matchReplacement = NO_NODE;
+        while (pos < p_rPath.size() || matchBegin != std::wstring::npos) {
+            if (pos < p_rPath.size()) {
+                if (node == 0 && matchBegin == std::wstring::npos) {
+                    // Skip to the next character that can start a value to find.
+                    pos = StringUtils::FindFirstOf(p_rPath, m_FirstChars, pos);
+                    if (pos == std::wstring::npos) {
+                        pos = p_rPath.size();
+                        continue;
+                    }
+                }
+                node = Step(node, p_rPath[pos++]);
+
+                // The longest value ending here is the one that starts first.
+                const uint32_t output = m_vNodes[node].m_Output;
+                if (output != NO_NODE) {
+                    const size_t begin = pos - m_vNodes[output].m_Depth;
+                    if (matchBegin == std::wstring::npos || begin <= matchBegin) {
+                        matchBegin = begin;
+                        matchEnd = pos;
+                        matchReplacement = m_vNodes[output].m_Replacement;
+                    }
+                }
+
+                // Keep scanning while a longer value starting at or before
+                // our match could still be found.
+                if (matchBegin == std::wstring::npos || matchBegin >= pos - m_vNodes[node].m_Depth) {
+                    continue;
+                }
+            }
+
+            // Replace the match and resume scanning after it.
+            if (newPath.empty()) {
+                newPath.reserve(p_rPath.size());
+            }
+            newPath.append(p_rPath, copiedEnd, matchBegin - copiedEnd);
+            newPath.append(m_vReplacements[matchReplacement]);
+            copiedEnd = matchEnd;
+            pos = matchEnd;
+            node = 0;
+            matchBegin = std::wstring::npos;
+        }
+        if (copiedEnd != 0) {
+            newPath.append(p_rPath, copiedEnd, std::wstring::npos);
+            p_rPath = std::move(newPath);
+        }
+    }
+
+    //
+    // Returns the child of an automaton node for a given character.
+    //
+    // @param p_Node Index of node.
+    // @param p_Char Character to look for.
+    // @return Index of child node, or NO_NODE if there is none.
+    //
+    uint32_t MultiFindReplacePipelineElement::GetTransition(const uint32_t p_Node,
+                                                            const wchar_t p_Char) const noexcept
+    {
+        const auto& vTransitions = m_vNodes[p_Node].m_vTransitions;
+        const auto it = std::lower_bound(vTransitions.cbegin(), vTransitions.cend(), p_Char,
+                                         [](const auto& p_Transition, const wchar_t c) noexcept {
+                                             return p_Transition.first < c;
+                                         });
+        return (it != vTransitions.cend() && it->first == p_Char) ? it->second : NO_NODE;
+    }
+
+    //
+    // Moves the automaton to the next node after reading a character,
+    // following failure links if needed.
+    //
+    // @param p_Node Index of current node.
+    // @param p_Char Character read.
+    // @return Index of next node.
+    //
+    uint32_t MultiFindReplacePipelineElement::Step(uint32_t p_Node,
+                                                   const wchar_t p_Char) const noexcept
+    {
+        for (;;) {
+            const uint32_t next = GetTransition(p_Node, p_Char);
+            if (next != NO_NODE) {
+                return next;
+            }
+            if (p_Node == 0) {
+                return 0;
+            }
+            p_Node = m_vNodes[p_Node].m_Failure;
+        }
+    }
+
+    //
+    // Constructor. Compiles prefixes into a case-insensitive trie.
+    //
+    // @param p_vPrefixReplacementPairs Pairs of prefixes and their replacement.
+    //                                  Empty prefixes are ignored; if a prefix
+    //                                  appears more than once (ignoring case),
+    //                                  its first replacement is used.
+    //
+    PrefixMapPipelineElement::PrefixMapPipelineElement(const WStringPairV& p_vPrefixReplacementPairs)
+        : PipelineElement(),
+          m_vNodes(),
+          m_TransitionChars(),
+          m_vTransitionNodes(),
+          m_vReplacements()
+    {
+        // First build the trie using separate transitions for each node.
+        std::vector<std::vector<std::pair<wchar_t, uint32_t>>> vvNodeTransitions(1);
+        std::vector<uint32_t> vNodeReplacements(1, NO_REPLACEMENT);
+        for (const auto& prefixReplacementPair : p_vPrefixReplacementPairs) {
+            uint32_t node = 0;
+            for (const wchar_t c : prefixReplacementPair.first) {
+                const wchar_t upperC = FoldPrefixChar(c);
+                auto& vTransitions = vvNodeTransitions[node];
+                auto it = std::lower_bound(vTransitions.begin(), vTransitions.end(), upperC,
+                                           [](const auto& p_Transition, const wchar_t p_Char) noexcept {
+                                               return p_Transition.first < p_Char;
+                                           });
+                if (it == vTransitions.end() || it->first != upperC) {
+                    const auto child = static_cast<uint32_t>(vvNodeTransitions.size());
+                    vTransitions.emplace(it, upperC, child);
+                    vvNodeTransitions.emplace_back();
+                    vNodeReplacements.push_back(NO_REPLACEMENT);
+                    node = child;
+                } else {
+                    node = it->second;
+                }
+            }
+            if (node != 0 && vNodeReplacements[node] == NO_REPLACEMENT) {
+                m_vReplacements.emplace_back(prefixReplacementPair.second);
+                vNodeReplacements[node] = static_cast<uint32_t>(m_vReplacements.size() - 1);
+            }
+        }
+
+        // Now store all transitions together so that large tables
+        // do not need one allocation per node.
+        m_vNodes.resize(vvNodeTransitions.size());
+        m_TransitionChars.reserve(vvNodeTransitions.size() - 1);
+        m_vTransitionNodes.reserve(vvNodeTransitions.size() - 1);
+        for (size_t i = 0; i < vvNodeTransitions.size(); ++i) {
+            Node& node = m_vNodes[i];
+            node.m_FirstTransition = static_cast<uint32_t>(m_vTransitionNodes.size());
+            node.m_NumTransitions = static_cast<uint32_t>(vvNodeTransitions[i].size());
+            node.m_Replacement = vNodeReplacements[i];
+            for (const auto& transition : vvNodeTransitions[i]) {
+                m_TransitionChars.push_back(transition.first);
+                m_vTransitionNodes.push_back(transition.second);
+            }
+        }
+    }
+
+    //
+    // Loads a table of prefixes and their replacement from a file.
+    // The file must be encoded in UTF-8 (a byte order mark is allowed)
+    // and contain one entry per line, with the prefix and replacement
+    // separated by a tab character. Empty lines are skipped.
+    //
+    // @param p_FilePath Path of file to load.
+    // @return Pairs of prefixes and their replacement, in file order.
+    //
+    WStringPairV PrefixMapPipelineElement::LoadTable(const std::wstring& p_FilePath)
+    {
+        std::ifstream file(std::filesystem::path(p_FilePath), std::ios::in | std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (!file.is_open() || file.bad()) {
+            throw InvalidPipelineException(ATL::CStringA(MAKEINTRESOURCEA(IDS_INVALIDPIPELINE_PREFIX_MAP_FILE)));
+        }
+        constexpr std::string_view UTF8_BOM = "\xEF\xBB\xBF";
+        if (std::string_view(content).substr(0, UTF8_BOM.size()) == UTF8_BOM) {
+            content.erase(0, UTF8_BOM.size());
+        }
+        const std::wstring table(ATL::CA2W(content.c_str(), CP_UTF8));
+
+        WStringPairV vPrefixReplacementPairs;
+        for (const std::wstring_view line : StringUtils::SplitView(table, L"\r\n")) {
+            const auto tabPos = line.find(L'\t');
+            if (tabPos == std::wstring_view::npos) {
+                throw InvalidPipelineException(ATL::CStringA(MAKEINTRESOURCEA(IDS_INVALIDPIPELINE_PREFIX_MAP_FILE)));
+            }
+            vPrefixReplacementPairs.emplace_back(line.substr(0, tabPos), line.substr(tabPos + 1));
+        }
+        return vPrefixReplacementPairs;
+    }
+
+    //
+    // Modifies the given path by replacing the longest prefix found
+    // in our table with its replacement value. A prefix only matches
+    // entire path parts: it must be followed by a separator or the end
+    // of the path, unless it ends with a separator itself.
+    //
+    // @param p_rPath Path to modify (in-place).
+    // @param p_pPluginProvider Optional object to access plugins.
+    //
+    void PrefixMapPipelineElement::ModifyPath(std::wstring& p_rPath,
+                                              const PluginProvider* const /*p_pPluginProvider*/) const
+    {
+        uint32_t node = 0;
+        size_t prefixSize = 0;
+        uint32_t replacement = NO_REPLACEMENT;
+        for (size_t i = 0; i < p_rPath.size(); ++i) {
+            const Node& curNode = m_vNodes[node];
+            const auto transitionsBegin = m_TransitionChars.cbegin() + curNode.m_FirstTransition;
+            const auto transitionsEnd = transitionsBegin + curNode.m_NumTransitions;
+            const wchar_t upperC = FoldPrefixChar(p_rPath[i]);
+            const auto it = std::lower_bound(transitionsBegin, transitionsEnd, upperC);
+            if (it == transitionsEnd || *it != upperC) {
+                break;
+            }
+            node = m_vTransitionNodes[it - m_TransitionChars.cbegin()];
+            const bool atPartEnd = i + 1 == p_rPath.size() || IsPathSeparator(p_rPath[i]) || IsPathSeparator(p_rPath[i + 1]);
+            if (m_vNodes[node].m_Replacement != NO_REPLACEMENT && atPartEnd) {
+                prefixSize = i + 1;
+                replacement = m_vNodes[node].m_Replacement;
+            }
+        }
+        if (replacement != NO_REPLACEMENT) {
+            p_rPath.replace(0, prefixSize, m_vReplacements[replacement]);
         }
     }
 
@@ -197,12 +687,24 @@ namespace PCC
                                                const std::wstring& p_Format,
                                                const bool p_IgnoreCase)
         : PipelineElement(),
-          m_Regex(p_Regex),
-          m_Format(p_Format),
-          m_IgnoreCase(p_IgnoreCase),
-          m_upRegex(),
-          m_RegexTested(false)
+          m_Regex(p_Regex, p_IgnoreCase),
+          m_Format(p_Format)
+    {
+    }
+
+    //
+    // Validates this pipeline element. In order to be valid,
+    // our regular expression must compile.
+    //
+    // @param p_pPluginProvider Optional plugin provider; unused.
+    // @param p_rsSeenPluginIds Set used to store seen plugin IDs; unused.
+    //
+    void RegexPipelineElement::Validate(const PluginProvider* const p_pPluginProvider,
+                                        GUIDS& p_rsSeenPluginIds) const
     {
+        PipelineElement::Validate(p_pPluginProvider, p_rsSeenPluginIds);
+
+        m_Regex.Validate();
     }
 
     //
@@ -215,12 +717,11 @@ namespace PCC
     void RegexPipelineElement::ModifyPath(std::wstring& p_rPath,
                                           const PluginProvider* const /*p_pPluginProvider*/) const
     {
-        // Check if regex is valid.
-        InitRegex();
-        if (m_upRegex != nullptr) {
+        const RegexBackend* const pRegex = m_Regex.Get();
+        if (pRegex != nullptr) {
             try {
                 // Perform the find-replace and return the modified string.
-                p_rPath = std::regex_replace(p_rPath, *m_upRegex, m_Format);
+                p_rPath = pRegex->Replace(p_rPath, m_Format);
             } catch (const std::regex_error&) {
                 // Nothing much we can do, we didn't get this at init time...
                 // Probably a problem with the replacement expression.
@@ -229,48 +730,36 @@ namespace PCC
         }
     }
 
+    //
+    // Compiles this element into a PipelineProgram instruction that
+    // performs find/replace operations using our regex.
+    //
+    // @param p_rCompiler Compiler to use to emit instructions.
+    //
+    void RegexPipelineElement::Compile(PipelineCompiler& p_rCompiler) const
+    {
+        const RegexBackend* const pRegex = m_Regex.Get();
+        if (pRegex != nullptr) {
+            p_rCompiler.Emit(PipelineOpcode::RegexReplace,
+                             p_rCompiler.AddRegex(*pRegex),
+                             p_rCompiler.AddString(m_Format));
+        }
+    }
+
     //
     // Checks if a plugin using this pipeline element should be enabled or not.
-    // In our case, we see if our regex is valid.
+    // In our case, we see if we have a regex to use.
     //
     // @param p_ParentPath Path of the parent folder for the file to check; unused.
     // @param p_File Path of file to use for the check; unused.
     // @param p_psspAllPlugins Optional set containing all plugins; unused.
-    // @return false if regular expression is invalid.
+    // @return false if regular expression is empty or invalid.
     //
     bool RegexPipelineElement::ShouldBeEnabledFor(const std::wstring& /*p_ParentPath*/,
                                                   const std::wstring& /*p_File*/,
                                                   const PluginProvider* const /*p_pPluginProvider*/) const
     {
-        InitRegex();
-        return m_upRegex != nullptr;
-    }
-
-    //
-    // Initializes the m_apRegex member using the other members.
-    // Call this method before needing to access the regex object.
-    //
-    // Note: m_apRegex will remain null if the regular expression is invalid.
-    //
-    void RegexPipelineElement::InitRegex() const
-    {
-        // Only init once.
-        if (!m_RegexTested) {
-            // Try creating regex. Keep null if the regex is invalid.
-            try {
-                if (!m_Regex.empty()) {
-#pragma warning(suppress: 26812)    // std::regex_constants::syntax_option_type could be enum class
-                    std::regex_constants::syntax_option_type reOptions = std::regex_constants::ECMAScript;
-                    if (m_IgnoreCase) {
-                        reOptions |= std::regex_constants::icase;
-                    }
-                    m_upRegex = std::make_unique<std::wregex>(m_Regex, reOptions);
-                }
-            } catch (const std::regex_error&) {
-                assert(m_upRegex == nullptr);
-            }
-            m_RegexTested = true;
-        }
+        return m_Regex.Get() != nullptr;
     }
 
     //
@@ -290,6 +779,22 @@ namespace PCC
         }
     }
 
+    //
+    // Modifies the given path by replacing all instances of %DRIVELABEL%
+    // with the label of the current drive. The path's structure is
+    // looked up in the stack's cache.
+    //
+    // @param p_rPath Path to modify (in-place).
+    // @param p_rStack Stack caching the structure of the path.
+    // @param p_pPluginProvider Optional object to access plugins.
+    //
+    void InjectDriveLabelPipelineElement::ModifyPath(std::wstring& p_rPath,
+                                                     PipelineStack& p_rStack,
+                                                     const PluginProvider* const /*p_pPluginProvider*/) const
+    {
+        ModifyPath(p_rPath, p_rStack.GetPathView(p_rPath));
+    }
+
     //
     // Modifies the given path by replacing all instances of %DRIVELABEL%
     // with the label of the current drive.
@@ -300,13 +805,23 @@ namespace PCC
     void InjectDriveLabelPipelineElement::ModifyPath(std::wstring& p_rPath,
                                                      const PluginProvider* const /*p_pPluginProvider*/) const
     {
-        using namespace coveo::linq;
+        ModifyPath(p_rPath, PathView(p_rPath));
+    }
 
-        // Get drive letter for path.
-        const auto vParents = PluginUtils::EnumerateParents(p_rPath);
+    //
+    // Modifies the given path by replacing all instances of %DRIVELABEL%
+    // with the label of the current drive.
+    //
+    // @param p_rPath Path to modify (in-place).
+    // @param p_PathView Structure of p_rPath.
+    //
+    void InjectDriveLabelPipelineElement::ModifyPath(std::wstring& p_rPath,
+                                                     const PathView& p_PathView) const
+    {
+        // Get drive letter for path: it's the path's farthest parent.
         std::wstring drive;
-        if (!vParents.empty()) {
-            drive = vParents.back();
+        if (p_PathView.NumParents() != 0) {
+            drive = p_PathView.Parent(p_PathView.NumParents() - 1);
         }
         if (!drive.empty()) {
             if (drive.back() != L'\\') {
@@ -344,37 +859,144 @@ namespace PCC
 
     //
     // Modifies the given path by keeping only some parts of the path.
+    // The path's structure is looked up in the stack's cache.
     //
     // @param p_rPath Path to modify (in-place).
+    // @param p_rStack Stack caching the structure of the path.
     // @param p_pPluginProvider Optional object to access plugins.
     //
     void CopyNPathPartsPipelineElement::ModifyPath(std::wstring& p_rPath,
+                                                   PipelineStack& p_rStack,
                                                    const PluginProvider* const /*p_pPluginProvider*/) const
     {
-        // First split the path into parts.
-        auto vPathParts = StringUtils::Split(p_rPath, L"\\/");
-        
+        ModifyPath(p_rPath, p_rStack.GetPathView(p_rPath));
+    }
+
+    //
+    // Modifies the given path by keeping only some parts of the path.
+    //
+    // @param p_rPath Path to modify (in-place).
+    // @param p_pPluginProvider Optional object to access plugins.
+    //
+    void CopyNPathPartsPipelineElement::ModifyPath(std::wstring& p_rPath,
+                                                   const PluginProvider* const /*p_pPluginProvider*/) const
+    {
+        ModifyPath(p_rPath, PathView(p_rPath));
+    }
+
+    //
+    // Modifies the given path by keeping only some parts of the path.
+    //
+    // @param p_rPath Path to modify (in-place).
+    // @param p_PathView Structure of p_rPath.
+    //
+    void CopyNPathPartsPipelineElement::ModifyPath(std::wstring& p_rPath,
+                                                   const PathView& p_PathView) const
+    {
         // If we have less parts than requested just return the path unmodified.
-        if (m_NumParts < vPathParts.size()) {
+        const size_t numPathParts = p_PathView.NumParts();
+        if (m_NumParts < numPathParts) {
+            if (m_NumParts == 0) {
+                p_rPath.clear();
+                return;
+            }
+
             // Try auto-detecting the separator type used in this path.
-            const auto separatorPos = p_rPath.find_first_of(L"\\/");
-            const auto separator = separatorPos != std::wstring::npos ? p_rPath[separatorPos] : L'\\';
+            const auto separator = p_PathView.FirstSeparator() != L'\0' ? p_PathView.FirstSeparator() : L'\\';
+
+            // Locate the parts to keep. If they are all separated by a single
+            // separator of the auto-detected type, they can be copied as-is.
+            const size_t firstPartToKeep = m_First ? 0 : numPathParts - m_NumParts;
+            const size_t lastPartToKeep = firstPartToKeep + m_NumParts - 1;
+            bool keptPathIsJoined = true;
+            for (size_t i = firstPartToKeep + 1; keptPathIsJoined && i <= lastPartToKeep; ++i) {
+                const auto separators = p_PathView.SeparatorsBefore(i);
+                keptPathIsJoined = separators.size() == 1 && separators.front() == separator;
+            }
 
-            // Keep only the required number of path parts and join them using separator.
-            if (m_First) {
-                vPathParts.erase(vPathParts.end() - (vPathParts.size() - m_NumParts), vPathParts.end());
+            // Keep only the required number of path parts, joining them using separator if needed.
+            const auto firstPart = p_PathView.Part(firstPartToKeep);
+            const auto lastPart = p_PathView.Part(lastPartToKeep);
+            const size_t keptPathPos = static_cast<size_t>(firstPart.data() - p_PathView.Path().data());
+            const size_t keptPathEnd = static_cast<size_t>(lastPart.data() + lastPart.size() - p_PathView.Path().data());
+            if (keptPathIsJoined) {
+                p_rPath.erase(keptPathEnd);
+                p_rPath.erase(0, keptPathPos);
             } else {
-                vPathParts.erase(vPathParts.begin(), vPathParts.begin() + (vPathParts.size() - m_NumParts));
+                std::wstring newPath;
+                newPath.reserve(keptPathEnd - keptPathPos);
+                for (size_t i = firstPartToKeep; i <= lastPartToKeep; ++i) {
+                    if (!newPath.empty()) {
+                        newPath.push_back(separator);
+                    }
+                    newPath.append(p_PathView.Part(i));
+                }
+                p_rPath = std::move(newPath);
+            }
+        }
+    }
+
+    //
+    // Modifies the given path by normalizing it in a single pass.
+    // Since normalizing never makes a path longer, parts are moved
+    // towards the beginning of the string as they are processed.
+    //
+    // @param p_rPath Path to modify (in-place).
+    // @param p_pPluginProvider Optional object to access plugins.
+    //
+    void NormalizePathPipelineElement::ModifyPath(std::wstring& p_rPath,
+                                                  const PluginProvider* const /*p_pPluginProvider*/) const
+    {
+        // Paths without separators have nothing to normalize.
+        const auto separatorPos = StringUtils::FindFirstOf(p_rPath, PATH_SEPARATORS);
+        if (separatorPos == std::wstring::npos) {
+            return;
+        }
+        const wchar_t separator = p_rPath[separatorPos];
+
+        // Keep the root, converting its separators. ".." parts cannot go
+        // above the root unless it's only a drive (like in "C:..\foo").
+        const size_t rootSize = PathView::GetRootSize(p_rPath);
+        const bool absolute = rootSize != 0 && (IsPathSeparator(p_rPath.front()) || IsPathSeparator(p_rPath[rootSize - 1]));
+        std::replace_if(p_rPath.begin(), p_rPath.begin() + rootSize, IsPathSeparator, separator);
+
+        const std::wstring_view parentPart(L"..");
+        size_t readPos = rootSize;
+        size_t writePos = rootSize;
+        while (readPos < p_rPath.size()) {
+            size_t partEnd = StringUtils::FindFirstOf(p_rPath, PATH_SEPARATORS, readPos);
+            if (partEnd == std::wstring::npos) {
+                partEnd = p_rPath.size();
             }
-            std::wstringstream wss;
-            for (auto&& part : vPathParts) {
-                if (wss.tellp() != 0) {
-                    wss << separator;
+            const std::wstring_view part(p_rPath.data() + readPos, partEnd - readPos);
+            if (part == parentPart) {
+                // Remove the last part written, unless it's also a "..".
+                const size_t lastSeparatorPos = writePos > rootSize ? p_rPath.rfind(separator, writePos - 1) : std::wstring::npos;
+                const size_t lastPartPos = (lastSeparatorPos != std::wstring::npos && lastSeparatorPos >= rootSize) ? lastSeparatorPos + 1 : rootSize;
+                const std::wstring_view lastPart(p_rPath.data() + lastPartPos, writePos - lastPartPos);
+                if (writePos > rootSize && lastPart != parentPart) {
+                    writePos = lastPartPos > rootSize ? lastPartPos - 1 : rootSize;
+                } else if (!absolute) {
+                    if (writePos > rootSize) {
+                        p_rPath[writePos++] = separator;
+                    }
+                    p_rPath[writePos++] = L'.';
+                    p_rPath[writePos++] = L'.';
                 }
-                wss << part;
+            } else if (!part.empty() && part != L".") {
+                if (writePos > rootSize) {
+                    p_rPath[writePos++] = separator;
+                }
+                writePos = static_cast<size_t>(std::copy(part.cbegin(), part.cend(), p_rPath.begin() + writePos) - p_rPath.begin());
             }
-            p_rPath = wss.str();
+            readPos = partEnd + 1;
+        }
+
+        // A relative path that was entirely removed points to the current folder.
+        if (writePos == 0) {
+            p_rPath[writePos++] = L'.';
         }
+        p_rPath.resize(writePos);
     }
 
     //
@@ -455,6 +1077,18 @@ namespace PCC
         return enabled;
     }
 
+    //
+    // Compiles this element into a PipelineProgram instruction that
+    // applies our plugin. The plugin is looked up when the program
+    // is bound to a plugin provider instead of for each path.
+    //
+    // @param p_rCompiler Compiler to use to emit instructions.
+    //
+    void ApplyPluginPipelineElement::Compile(PipelineCompiler& p_rCompiler) const
+    {
+        p_rCompiler.Emit(PipelineOpcode::ApplyPlugin, p_rCompiler.AddPluginId(m_PluginId));
+    }
+
     //
     // Constructor.
     //
@@ -525,8 +1159,7 @@ namespace PCC
                                                            const bool p_IgnoreCase,
                                                            const size_t p_Group)
         : m_Method(PushToStackMethod::Regex),
-          m_Regex(p_Regex),
-          m_IgnoreCase(p_IgnoreCase),
+          m_Regex(p_Regex, p_IgnoreCase),
           m_Group(p_Group)
     {
     }
@@ -543,6 +1176,21 @@ namespace PCC
     {
     }
 
+    //
+    // Validates this pipeline element. If we use a regex to find the
+    // part of the path to push, it must compile to be valid.
+    //
+    // @param p_pPluginProvider Optional plugin provider; unused.
+    // @param p_rsSeenPluginIds Set used to store seen plugin IDs; unused.
+    //
+    void PushToStackPipelineElement::Validate(const PluginProvider* const p_pPluginProvider,
+                                              GUIDS& p_rsSeenPluginIds) const
+    {
+        PipelineElement::Validate(p_pPluginProvider, p_rsSeenPluginIds);
+
+        m_Regex.Validate();
+    }
+
     //
     // Locates the part of the path requested and pushes it to the stack.
     // If nothing is found, an empty string will be pushed.
@@ -552,22 +1200,78 @@ namespace PCC
     // @param p_pPluginProvider Optional object to access plugins; unused.
     //
     void PushToStackPipelineElement::ModifyPath(std::wstring& p_rPath,
-                                                std::stack<std::wstring>& p_rStack,
+                                                PipelineStack& p_rStack,
                                                 const PluginProvider* const /*p_pPluginProvider*/) const
     {
-        p_rStack.emplace(PartToPush(p_rPath));
+        p_rStack.Push(PartToPush(p_rPath));
+    }
+
+    //
+    // Compiles this element into a PipelineProgram instruction that
+    // pushes the requested part of the path to the stack.
+    //
+    // @param p_rCompiler Compiler to use to emit instructions.
+    //
+    void PushToStackPipelineElement::Compile(PipelineCompiler& p_rCompiler) const
+    {
+        switch (m_Method) {
+            case PushToStackMethod::Entire: {
+                p_rCompiler.Emit(PipelineOpcode::PushEntire);
+                break;
+            }
+            case PushToStackMethod::Range: {
+                p_rCompiler.Emit(PipelineOpcode::PushRange, m_Begin, m_End);
+                break;
+            }
+            case PushToStackMethod::Regex: {
+                // Without a regex, we always push an empty string.
+                const RegexBackend* const pRegex = m_Regex.Get();
+                if (pRegex != nullptr) {
+                    p_rCompiler.Emit(PipelineOpcode::PushRegex, p_rCompiler.AddRegex(*pRegex), m_Group);
+                } else {
+                    p_rCompiler.Emit(PipelineOpcode::PushFixed, p_rCompiler.AddString(std::wstring()));
+                }
+                break;
+            }
+            case PushToStackMethod::Fixed: {
+                p_rCompiler.Emit(PipelineOpcode::PushFixed, p_rCompiler.AddString(m_FixedString));
+                break;
+            }
+            default:
+                PipelineElement::Compile(p_rCompiler);
+        }
+    }
+
+    //
+    // Returns the method used to find the part of the path to push.
+    //
+    // @return Push method.
+    //
+    PushToStackMethod PushToStackPipelineElement::GetMethod() const noexcept
+    {
+        return m_Method;
+    }
+
+    //
+    // Returns the fixed string pushed to the stack.
+    //
+    // @return Fixed string. Only meaningful if GetMethod returns Fixed.
+    //
+    const std::wstring& PushToStackPipelineElement::GetFixedString() const noexcept
+    {
+        return m_FixedString;
     }
 
     //
     // Given a path, returns the part to push to the stack.
     //
     // @param p_Path Path to locate part of.
-    // @return Part of p_Path to push to the stack.
+    // @return Part of p_Path to push to the stack. Can be a view of p_Path.
     //
-    std::wstring PushToStackPipelineElement::PartToPush(const std::wstring& p_Path) const
+    std::wstring_view PushToStackPipelineElement::PartToPush(const std::wstring& p_Path) const
     {
-        std::wstring part;
-        
+        std::wstring_view part;
+
         switch (m_Method) {
             case PushToStackMethod::Entire: {
                 // Push the entire path.
@@ -577,27 +1281,21 @@ namespace PCC
             case PushToStackMethod::Range: {
                 // Push a range in the path.
                 if (m_Begin < p_Path.size() && m_Begin < m_End) {
-                    part = p_Path.substr(m_Begin, m_End - m_Begin);
+                    part = std::wstring_view(p_Path).substr(m_Begin, m_End - m_Begin);
                 }
                 break;
             }
             case PushToStackMethod::Regex: {
                 // Push the first match for a regex.
-                try {
-                    if (!m_Regex.empty()) {
-#pragma warning(suppress: 26812)    // std::regex_constants::syntax_option_type could be enum class
-                        std::regex_constants::syntax_option_type reOptions = std::regex_constants::ECMAScript;
-                        if (m_IgnoreCase) {
-                            reOptions |= std::regex_constants::icase;
-                        }
-                        std::wregex regex(m_Regex, reOptions);
-
-                        std::wsmatch match;
-                        if (std::regex_search(p_Path, match, regex)) {
-                            part = match[m_Group];
+                const RegexBackend* const pRegex = m_Regex.Get();
+                if (pRegex != nullptr) {
+                    try {
+                        RegexMatch match;
+                        if (pRegex->Search(p_Path, match) && match.Matched(m_Group)) {
+                            part = std::wstring_view(p_Path).substr(match.Position(m_Group), match.Length(m_Group));
                         }
+                    } catch (const std::regex_error&) {
                     }
-                } catch (const std::regex_error&) {
                 }
                 break;
             }
@@ -647,11 +1345,25 @@ namespace PCC
     PopFromStackPipelineElement::PopFromStackPipelineElement(const std::wstring& p_Regex,
                                                              const bool p_IgnoreCase)
         : m_Location(PopFromStackLocation::Regex),
-          m_Regex(p_Regex),
-          m_IgnoreCase(p_IgnoreCase)
+          m_Regex(p_Regex, p_IgnoreCase)
     {
     }
 
+    //
+    // Validates this pipeline element. If we use a regex to find the
+    // part of the path to replace, it must compile to be valid.
+    //
+    // @param p_pPluginProvider Optional plugin provider; unused.
+    // @param p_rsSeenPluginIds Set used to store seen plugin IDs; unused.
+    //
+    void PopFromStackPipelineElement::Validate(const PluginProvider* const p_pPluginProvider,
+                                               GUIDS& p_rsSeenPluginIds) const
+    {
+        PipelineElement::Validate(p_pPluginProvider, p_rsSeenPluginIds);
+
+        m_Regex.Validate();
+    }
+
     //
     // Attempts to pop a value from the stack. If it works, optionally stores
     // it in the path by replacing the entire path or part of it with the
@@ -662,12 +1374,13 @@ namespace PCC
     // @param p_pPluginProvider Optional object to access plugins; unused.
     //
     void PopFromStackPipelineElement::ModifyPath(std::wstring& p_rPath,
-                                                 std::stack<std::wstring>& p_rStack,
+                                                 PipelineStack& p_rStack,
                                                  const PluginProvider* const /*p_pPluginProvider*/) const
     {
-        if (!p_rStack.empty()) {
-            const auto value{p_rStack.top()};
-            p_rStack.pop();
+        if (!p_rStack.Empty()) {
+            // Popping does not invalidate the value.
+            const auto value = p_rStack.Top();
+            p_rStack.Pop();
 
             switch (m_Location) {
                 case PopFromStackLocation::Entire: {
@@ -684,30 +1397,24 @@ namespace PCC
                 }
                 case PopFromStackLocation::Regex: {
                     // Replace regex match with the value.
-                    try {
-                        if (!m_Regex.empty()) {
-#pragma warning(suppress: 26812)    // std::regex_constants::syntax_option_type could be enum class
-                            std::regex_constants::syntax_option_type reOptions = std::regex_constants::ECMAScript;
-                            if (m_IgnoreCase) {
-                                reOptions |= std::regex_constants::icase;
-                            }
-                            std::wregex regex(m_Regex, reOptions);
-
-                            // We can't use std::regex_replace because if the value contains
-                            // special characters it will get weird. So use regex_search and
+                    const RegexBackend* const pRegex = m_Regex.Get();
+                    if (pRegex != nullptr) {
+                        try {
+                            // We can't use Replace because if the value contains
+                            // special characters it will get weird. So use Search and
                             // do the replacement by hand.
-                            std::wsmatch match;
-                            if (std::regex_search(p_rPath, match, regex)) {
-                                p_rPath = match.prefix().str() + value + match.suffix().str();
+                            RegexMatch match;
+                            if (pRegex->Search(p_rPath, match)) {
+                                p_rPath.replace(match.Position(0), match.Length(0), value);
                             }
+                        } catch (const std::regex_error&) {
                         }
-                    } catch (const std::regex_error&) {
                     }
                     break;
                 }
                 case PopFromStackLocation::Start: {
                     // Insert value at start of path.
-                    p_rPath = value + p_rPath;
+                    p_rPath.insert(0, value);
                     break;
                 }
                 case PopFromStackLocation::End: {
@@ -726,44 +1433,115 @@ namespace PCC
     }
 
     //
-    // Attempts to pop two values from the stack. If it works, pushes
-    // them back in reverse order.
+    // Compiles this element into a PipelineProgram instruction that pops
+    // a value from the stack and stores it at the requested location.
+    //
+    // @param p_rCompiler Compiler to use to emit instructions.
+    //
+    void PopFromStackPipelineElement::Compile(PipelineCompiler& p_rCompiler) const
+    {
+        switch (m_Location) {
+            case PopFromStackLocation::Entire: {
+                p_rCompiler.Emit(PipelineOpcode::PopEntire);
+                break;
+            }
+            case PopFromStackLocation::Range: {
+                p_rCompiler.Emit(PipelineOpcode::PopRange, m_Begin, m_End);
+                break;
+            }
+            case PopFromStackLocation::Regex: {
+                // Without a regex, the popped value is simply dropped.
+                const RegexBackend* const pRegex = m_Regex.Get();
+                if (pRegex != nullptr) {
+                    p_rCompiler.Emit(PipelineOpcode::PopRegex, p_rCompiler.AddRegex(*pRegex));
+                } else {
+                    p_rCompiler.Emit(PipelineOpcode::PopNowhere);
+                }
+                break;
+            }
+            case PopFromStackLocation::Start: {
+                p_rCompiler.Emit(PipelineOpcode::PopStart);
+                break;
+            }
+            case PopFromStackLocation::End: {
+                p_rCompiler.Emit(PipelineOpcode::PopEnd);
+                break;
+            }
+            case PopFromStackLocation::Nowhere: {
+                p_rCompiler.Emit(PipelineOpcode::PopNowhere);
+                break;
+            }
+            default:
+                PipelineElement::Compile(p_rCompiler);
+        }
+    }
+
+    //
+    // Returns the location where the popped value is stored.
+    //
+    // @return Pop location.
+    //
+    PopFromStackLocation PopFromStackPipelineElement::GetLocation() const noexcept
+    {
+        return m_Location;
+    }
+
+    //
+    // Swaps the two values on top of the stack, if there are
+    // at least two values on the stack.
     //
     // @param p_rPath Path to modify; unused.
-    // @param p_rStack Stack from which to pop the values.
+    // @param p_rStack Stack containing the values to swap.
     // @param p_pPluginProvider Optional object to access plugins; unused.
     //
     void SwapStackValuesPipelineElement::ModifyPath(std::wstring& /*p_rPath*/,
-                                                    std::stack<std::wstring>& p_rStack,
+                                                    PipelineStack& p_rStack,
                                                     const PluginProvider* const /*p_pPluginProvider*/) const
     {
-        if (p_rStack.size() >= 2) {
-            const auto value1{p_rStack.top()};
-            p_rStack.pop();
-            const auto value2{p_rStack.top()};
-            p_rStack.pop();
-            p_rStack.push(value1);
-            p_rStack.push(value2);
+        if (p_rStack.Size() >= 2) {
+            p_rStack.Swap();
         }
     }
 
     //
-    // Attempts to pop a value from the stack. If it works, pushes
-    // back two copies of the value.
+    // Compiles this element into a PipelineProgram instruction
+    // that swaps the two top values on the stack.
+    //
+    // @param p_rCompiler Compiler to use to emit instructions.
+    //
+    void SwapStackValuesPipelineElement::Compile(PipelineCompiler& p_rCompiler) const
+    {
+        p_rCompiler.Emit(PipelineOpcode::SwapStackValues);
+    }
+
+    //
+    // Duplicates the value on top of the stack, if the
+    // stack is not empty.
     //
     // @param p_rPath Path to modify; unused.
-    // @param p_rStack Stack from which to pop the value.
+    // @param p_rStack Stack containing the value to duplicate.
     // @param p_pPluginProvider Optional object to access plugins; unused.
     //
     void DuplicateStackValuePipelineElement::ModifyPath(std::wstring& /*p_rPath*/,
-                                                        std::stack<std::wstring>& p_rStack,
+                                                        PipelineStack& p_rStack,
                                                         const PluginProvider* const /*p_pPluginProvider*/) const
     {
-        if (!p_rStack.empty()) {
-            p_rStack.push(p_rStack.top());
+        if (!p_rStack.Empty()) {
+            p_rStack.Duplicate();
         }
     }
 
+    //
+    // Compiles this element into a PipelineProgram instruction
+    // that duplicates the top value on the stack.
+    //
+    // @param p_rCompiler Compiler to use to emit instructions.
+    //
+    void DuplicateStackValuePipelineElement::Compile(PipelineCompiler& p_rCompiler) const
+    {
+        p_rCompiler.Emit(PipelineOpcode::DuplicateStackValue);
+    }
+
     //
     // Constructor.
     //
@@ -797,6 +1575,16 @@ namespace PCC
         p_rOptions.SetPathsSeparator(m_PathsSeparator);
     }
 
+    //
+    // Does not compile to any instruction since this element
+    // only modifies pipeline options.
+    //
+    // @param p_rCompiler Compiler to use to emit instructions; unused.
+    //
+    void PathsSeparatorPipelineElement::Compile(PipelineCompiler& /*p_rCompiler*/) const
+    {
+    }
+
     //
     // Modify global pipeline options by specifying that paths should
     // be copied recursively.
@@ -808,6 +1596,16 @@ namespace PCC
         p_rOptions.SetCopyPathsRecursively(true);
     }
 
+    //
+    // Does not compile to any instruction since this element
+    // only modifies pipeline options.
+    //
+    // @param p_rCompiler Compiler to use to emit instructions; unused.
+    //
+    void RecursiveCopyPipelineElement::Compile(PipelineCompiler& /*p_rCompiler*/) const
+    {
+    }
+
     //
     // Constructor.
     //
@@ -841,6 +1639,16 @@ namespace PCC
         p_rOptions.SetExecutable(m_Executable);
     }
 
+    //
+    // Does not compile to any instruction since this element
+    // only modifies pipeline options.
+    //
+    // @param p_rCompiler Compiler to use to emit instructions; unused.
+    //
+    void ExecutablePipelineElement::Compile(PipelineCompiler& /*p_rCompiler*/) const
+    {
+    }
+
     //
     // Constructor.
     //
@@ -920,4 +1728,133 @@ namespace PCC
         p_rOptions.SetShowForFolders(m_ShowForFolders);
     }
 
+    //
+    // Does not compile to any instruction since this element
+    // only modifies pipeline options.
+    //
+    // @param p_rCompiler Compiler to use to emit instructions; unused.
+    //
+    void DisplayForSelectionPipelineElement::Compile(PipelineCompiler& /*p_rCompiler*/) const
+    {
+    }
+
+    //
+    // Constructor.
+    //
+    // @param p_Prefix String to insert at start of path.
+    // @param p_Suffix String to append at end of path.
+    // @param p_OnlyIfSpaces Whether to surround path only if it contains spaces.
+    //
+    SurroundPipelineElement::SurroundPipelineElement(const std::wstring& p_Prefix,
+                                                     const std::wstring& p_Suffix,
+                                                     const bool p_OnlyIfSpaces)
+        : PipelineElement(),
+          m_Prefix(p_Prefix),
+          m_Suffix(p_Suffix),
+          m_OnlyIfSpaces(p_OnlyIfSpaces)
+    {
+    }
+
+    //
+    // Modifies the given path by surrounding it with our prefix and suffix.
+    //
+    // @param p_rPath Path to modify (in-place).
+    // @param p_pPluginProvider Optional object to access plugins.
+    //
+    void SurroundPipelineElement::ModifyPath(std::wstring& p_rPath,
+                                             const PluginProvider* const /*p_pPluginProvider*/) const
+    {
+        if (!m_OnlyIfSpaces || StringUtils::FindFirstOf(p_rPath, L" ") != std::wstring::npos) {
+            p_rPath.insert(0, m_Prefix);
+            p_rPath.append(m_Suffix);
+        }
+    }
+
+    //
+    // Compiles this element into a PipelineProgram instruction
+    // that surrounds the path with our prefix and suffix.
+    //
+    // @param p_rCompiler Compiler to use to emit instructions.
+    //
+    void SurroundPipelineElement::Compile(PipelineCompiler& p_rCompiler) const
+    {
+        p_rCompiler.Emit(m_OnlyIfSpaces ? PipelineOpcode::SurroundIfSpaces : PipelineOpcode::Surround,
+                         p_rCompiler.AddString(m_Prefix),
+                         p_rCompiler.AddString(m_Suffix));
+    }
+
+    //
+    // Returns the string inserted at start of path.
+    //
+    // @return Prefix string.
+    //
+    const std::wstring& SurroundPipelineElement::GetPrefix() const noexcept
+    {
+        return m_Prefix;
+    }
+
+    //
+    // Returns the string appended at end of path.
+    //
+    // @return Suffix string.
+    //
+    const std::wstring& SurroundPipelineElement::GetSuffix() const noexcept
+    {
+        return m_Suffix;
+    }
+
+    //
+    // Returns whether the path is surrounded only if it contains spaces.
+    //
+    // @return true if path is surrounded only if it contains spaces.
+    //
+    bool SurroundPipelineElement::GetOnlyIfSpaces() const noexcept
+    {
+        return m_OnlyIfSpaces;
+    }
+
+    //
+    // Constructor.
+    //
+    // @param p_Value Value to replace path with.
+    //
+    SetPathPipelineElement::SetPathPipelineElement(const std::wstring& p_Value)
+        : PipelineElement(),
+          m_Value(p_Value)
+    {
+    }
+
+    //
+    // Modifies the given path by replacing it with our value.
+    //
+    // @param p_rPath Path to modify (in-place).
+    // @param p_pPluginProvider Optional object to access plugins.
+    //
+    void SetPathPipelineElement::ModifyPath(std::wstring& p_rPath,
+                                            const PluginProvider* const /*p_pPluginProvider*/) const
+    {
+        p_rPath = m_Value;
+    }
+
+    //
+    // Compiles this element into a PipelineProgram instruction
+    // that replaces the path with our value.
+    //
+    // @param p_rCompiler Compiler to use to emit instructions.
+    //
+    void SetPathPipelineElement::Compile(PipelineCompiler& p_rCompiler) const
+    {
+        p_rCompiler.Emit(PipelineOpcode::SetPath, p_rCompiler.AddString(m_Value));
+    }
+
+    //
+    // Returns the value that replaces the path.
+    //
+    // @return Path value.
+    //
+    const std::wstring& SetPathPipelineElement::GetValue() const noexcept
+    {
+        return m_Value;
+    }
+
 } // namespace PCC
@@ -0,0 +1,229 @@
+// PluginPipelineOptimizer.cpp
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdafx.h>
+#include <PluginPipelineOptimizer.h>
+#include <PluginPipelineElements.h>
+
+
+namespace PCC
+{
+    //
+    // Optimizes a list of pipeline elements. Elements are added one by one
+    // to the result; each time, we try to combine the last two elements of
+    // the result until no further combination is possible.
+    //
+    // @param p_vspElements Elements to optimize.
+    // @return Optimized elements, to be used to modify paths only.
+    //
+    auto PipelineOptimizer::Optimize(const PipelineElementSPV& p_vspElements) -> PipelineElementSPV
+    {
+        PipelineElementSPV vspOptimized;
+        vspOptimized.reserve(p_vspElements.size());
+        PipelineElementSPV vspCombined;
+        for (const auto& spElement : p_vspElements) {
+            // Elements that only modify options can be dropped.
+            if (!ModifiesPath(*spElement)) {
+                continue;
+            }
+            vspOptimized.emplace_back(Normalize(spElement));
+
+            bool combined = true;
+            while (combined && vspOptimized.size() >= 2) {
+                vspCombined.clear();
+                combined = Combine(vspOptimized[vspOptimized.size() - 2], vspOptimized.back(), vspCombined);
+                if (combined) {
+                    vspOptimized.resize(vspOptimized.size() - 2);
+                    vspOptimized.insert(vspOptimized.end(), vspCombined.cbegin(), vspCombined.cend());
+                }
+            }
+        }
+
+        return vspOptimized;
+    }
+
+    //
+    // Attempts to combine two consecutive elements.
+    //
+    // @param p_spFirst First element.
+    // @param p_spSecond Second element, applied after p_spFirst.
+    // @param p_rvspCombined Where to store the elements replacing both
+    //                       p_spFirst and p_spSecond if they can be
+    //                       combined. Can be left empty.
+    // @return true if elements were combined.
+    //
+    bool PipelineOptimizer::Combine(const PipelineElementSP& p_spFirst,
+                                    const PipelineElementSP& p_spSecond,
+                                    PipelineElementSPV& p_rvspCombined)
+    {
+        const auto isSlashConversion = [](const PipelineElementSP& p_spElement) {
+            return dynamic_cast<const BackToForwardSlashesPipelineElement*>(p_spElement.get()) != nullptr ||
+                   dynamic_cast<const ForwardToBackslashesPipelineElement*>(p_spElement.get()) != nullptr;
+        };
+
+        // After a slash conversion, all slashes are the same, so the
+        // second conversion determines the result.
+        if (isSlashConversion(p_spFirst) && isSlashConversion(p_spSecond)) {
+            p_rvspCombined.push_back(p_spSecond);
+            return true;
+        }
+
+        // Swapping twice does nothing: either both swaps happen or none do.
+        if (dynamic_cast<const SwapStackValuesPipelineElement*>(p_spFirst.get()) != nullptr &&
+            dynamic_cast<const SwapStackValuesPipelineElement*>(p_spSecond.get()) != nullptr) {
+            return true;
+        }
+
+        const auto* const pPop = dynamic_cast<const PopFromStackPipelineElement*>(p_spSecond.get());
+        if (pPop != nullptr) {
+            // Pushing or duplicating a value then dropping it does nothing.
+            if (pPop->GetLocation() == PopFromStackLocation::Nowhere &&
+                (dynamic_cast<const PushToStackPipelineElement*>(p_spFirst.get()) != nullptr ||
+                 dynamic_cast<const DuplicateStackValuePipelineElement*>(p_spFirst.get()) != nullptr)) {
+                return true;
+            }
+
+            // Pushing a fixed string then popping it into the path
+            // does not need to go through the stack.
+            const auto* const pPush = dynamic_cast<const PushToStackPipelineElement*>(p_spFirst.get());
+            if (pPush != nullptr && pPush->GetMethod() == PushToStackMethod::Fixed) {
+                switch (pPop->GetLocation()) {
+                    case PopFromStackLocation::Entire: {
+                        p_rvspCombined.push_back(std::make_shared<SetPathPipelineElement>(pPush->GetFixedString()));
+                        return true;
+                    }
+                    case PopFromStackLocation::Start: {
+                        p_rvspCombined.push_back(std::make_shared<SurroundPipelineElement>(pPush->GetFixedString(), std::wstring(), false));
+                        return true;
+                    }
+                    case PopFromStackLocation::End: {
+                        p_rvspCombined.push_back(std::make_shared<SurroundPipelineElement>(std::wstring(), pPush->GetFixedString(), false));
+                        return true;
+                    }
+                    default:
+                        break;
+                }
+            }
+        }
+
+        // Consecutive surrounds can be fused if the second one is known
+        // to apply whenever the first one does:
+        // - if both are unconditional
+        // - if both depend on spaces (if the first applies, the path has spaces)
+        // - if the first one is unconditional and adds spaces itself
+        const auto* const pFirstSurround = dynamic_cast<const SurroundPipelineElement*>(p_spFirst.get());
+        const auto* const pSecondSurround = dynamic_cast<const SurroundPipelineElement*>(p_spSecond.get());
+        if (pFirstSurround != nullptr && pSecondSurround != nullptr) {
+            bool onlyIfSpaces = pFirstSurround->GetOnlyIfSpaces();
+            bool fuse = onlyIfSpaces == pSecondSurround->GetOnlyIfSpaces();
+            if (!fuse && !onlyIfSpaces) {
+                fuse = pFirstSurround->GetPrefix().find(L' ') != std::wstring::npos ||
+                       pFirstSurround->GetSuffix().find(L' ') != std::wstring::npos;
+            }
+            if (fuse) {
+                p_rvspCombined.push_back(std::make_shared<SurroundPipelineElement>(
+                    pSecondSurround->GetPrefix() + pFirstSurround->GetPrefix(),
+                    pFirstSurround->GetSuffix() + pSecondSurround->GetSuffix(),
+                    onlyIfSpaces));
+                return true;
+            }
+        }
+
+        // If the path is replaced by a constant, anything that only looks
+        // at the path before that is useless and anything that only looks
+        // at the path after that can be computed right away.
+        const auto* const pFirstSetPath = dynamic_cast<const SetPathPipelineElement*>(p_spFirst.get());
+        if (dynamic_cast<const SetPathPipelineElement*>(p_spSecond.get()) != nullptr && IsPure(*p_spFirst)) {
+            p_rvspCombined.push_back(p_spSecond);
+            return true;
+        }
+        if (pFirstSetPath != nullptr && IsPure(*p_spSecond)) {
+            std::wstring value(pFirstSetPath->GetValue());
+            p_spSecond->ModifyPath(value, nullptr);
+            p_rvspCombined.push_back(std::make_shared<SetPathPipelineElement>(value));
+            return true;
+        }
+
+        return false;
+    }
+
+    //
+    // Normalizes an element so that it can be combined more easily.
+    // For example, quotes are turned into SurroundPipelineElement.
+    //
+    // @param p_spElement Element to normalize.
+    // @return Normalized element, or p_spElement if it needs no normalization.
+    //
+    auto PipelineOptimizer::Normalize(const PipelineElementSP& p_spElement) -> PipelineElementSP
+    {
+        if (dynamic_cast<const QuotesPipelineElement*>(p_spElement.get()) != nullptr) {
+            return std::make_shared<SurroundPipelineElement>(L"\"", L"\"", false);
+        }
+        if (dynamic_cast<const OptionalQuotesPipelineElement*>(p_spElement.get()) != nullptr) {
+            return std::make_shared<SurroundPipelineElement>(L"\"", L"\"", true);
+        }
+        if (dynamic_cast<const EmailLinksPipelineElement*>(p_spElement.get()) != nullptr) {
+            return std::make_shared<SurroundPipelineElement>(L"<", L">", false);
+        }
+        return p_spElement;
+    }
+
+    //
+    // Checks whether an element can have an effect on paths. Elements that
+    // only modify pipeline options do not modify paths.
+    //
+    // @param p_Element Element to check.
+    // @return true if element can modify paths or the stack.
+    //
+    bool PipelineOptimizer::ModifiesPath(const PipelineElement& p_Element) noexcept
+    {
+        return dynamic_cast<const PathsSeparatorPipelineElement*>(&p_Element) == nullptr &&
+               dynamic_cast<const RecursiveCopyPipelineElement*>(&p_Element) == nullptr &&
+               dynamic_cast<const ExecutablePipelineElement*>(&p_Element) == nullptr &&
+               dynamic_cast<const DisplayForSelectionPipelineElement*>(&p_Element) == nullptr;
+    }
+
+    //
+    // Checks whether an element is "pure", e.g. whether its result depends
+    // only on the path. Pure elements do not use the stack, plugins, the
+    // file system or the environment.
+    //
+    // @param p_Element Element to check.
+    // @return true if element is pure.
+    //
+    bool PipelineOptimizer::IsPure(const PipelineElement& p_Element) noexcept
+    {
+        return dynamic_cast<const SurroundPipelineElement*>(&p_Element) != nullptr ||
+               dynamic_cast<const SetPathPipelineElement*>(&p_Element) != nullptr ||
+               dynamic_cast<const EncodeURIWhitespacePipelineElement*>(&p_Element) != nullptr ||
+               dynamic_cast<const EncodeURICharsPipelineElement*>(&p_Element) != nullptr ||
+               dynamic_cast<const BackToForwardSlashesPipelineElement*>(&p_Element) != nullptr ||
+               dynamic_cast<const ForwardToBackslashesPipelineElement*>(&p_Element) != nullptr ||
+               dynamic_cast<const RemoveFileExtPipelineElement*>(&p_Element) != nullptr ||
+               dynamic_cast<const FindReplacePipelineElement*>(&p_Element) != nullptr ||
+               dynamic_cast<const MultiFindReplacePipelineElement*>(&p_Element) != nullptr ||
+               dynamic_cast<const PrefixMapPipelineElement*>(&p_Element) != nullptr ||
+               dynamic_cast<const RegexPipelineElement*>(&p_Element) != nullptr ||
+               dynamic_cast<const CopyNPathPartsPipelineElement*>(&p_Element) != nullptr ||
+               dynamic_cast<const NormalizePathPipelineElement*>(&p_Element) != nullptr;
+    }
+
+} // namespace PCC
@@ -0,0 +1,155 @@
+// PluginPipelineProfiler.cpp
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdafx.h>
+#include <PluginPipelineProfiler.h>
+
+#include <algorithm>
+#include <sstream>
+
+
+namespace PCC
+{
+    std::atomic<bool>               PipelineProfiler::s_Enabled(false);
+    std::mutex                      PipelineProfiler::s_Lock;
+    PipelineProfiler::ProfileM      PipelineProfiler::s_Profiles;
+
+    //
+    // Adds the result of one call to an element to the counters.
+    //
+    // @param p_Time Time spent in element.
+    // @param p_BytesIn Size of path passed to element, in bytes.
+    // @param p_BytesOut Size of path returned by element, in bytes.
+    //
+    void PipelineElementProfile::Add(const std::chrono::nanoseconds p_Time,
+                                     const size_t p_BytesIn,
+                                     const size_t p_BytesOut) noexcept
+    {
+        ++m_Invocations;
+        m_TotalTime += p_Time;
+        m_MaxTime = (std::max)(m_MaxTime, p_Time);
+        m_BytesIn += p_BytesIn;
+        m_BytesOut += p_BytesOut;
+    }
+
+    //
+    // Adds the counters of another profile to ours.
+    //
+    // @param p_Other Profile to merge with ours.
+    //
+    void PipelineElementProfile::Merge(const PipelineElementProfile& p_Other) noexcept
+    {
+        m_Invocations += p_Other.m_Invocations;
+        m_TotalTime += p_Other.m_TotalTime;
+        m_MaxTime = (std::max)(m_MaxTime, p_Other.m_MaxTime);
+        m_BytesIn += p_Other.m_BytesIn;
+        m_BytesOut += p_Other.m_BytesOut;
+    }
+
+    //
+    // Enables or disables profiling of pipelines. Counters recorded
+    // so far are kept; call Reset to clear them.
+    //
+    // @param p_Enabled Whether to enable profiling.
+    //
+    void PipelineProfiler::SetEnabled(const bool p_Enabled) noexcept
+    {
+        s_Enabled = p_Enabled;
+    }
+
+    //
+    // Records the counters of a pipeline. Pipelines accumulate counters
+    // for a batch of paths and record them once, so the lock is not
+    // taken for each element.
+    //
+    // @param p_PluginId ID of plugin owning the pipeline.
+    // @param p_vProfiles Counters for each element of the pipeline.
+    //
+    void PipelineProfiler::Record(const GUID& p_PluginId,
+                                  const PipelineElementProfileV& p_vProfiles)
+    {
+        std::lock_guard<std::mutex> lock(s_Lock);
+        auto& vProfiles = s_Profiles[p_PluginId];
+        if (vProfiles.size() < p_vProfiles.size()) {
+            vProfiles.resize(p_vProfiles.size());
+        }
+        for (size_t i = 0; i < p_vProfiles.size(); ++i) {
+            vProfiles[i].Merge(p_vProfiles[i]);
+        }
+    }
+
+    //
+    // Returns a copy of the counters recorded so far.
+    //
+    // @return Counters for each profiled pipeline, keyed by plugin ID.
+    //
+    auto PipelineProfiler::GetProfiles() -> ProfileM
+    {
+        std::lock_guard<std::mutex> lock(s_Lock);
+        return s_Profiles;
+    }
+
+    //
+    // Clears all counters recorded so far.
+    //
+    void PipelineProfiler::Reset()
+    {
+        std::lock_guard<std::mutex> lock(s_Lock);
+        s_Profiles.clear();
+    }
+
+    //
+    // Returns a report of the counters recorded so far. The report contains
+    // a header line followed by one line per pipeline element, with values
+    // separated by tabs. Times are in microseconds.
+    //
+    // @return Profiling report.
+    //
+    std::wstring PipelineProfiler::Report()
+    {
+        std::wstring guidBuffer(40, L'\0'); // See StringFromGUID2 in MSDN
+        const auto guidToString = [&](const GUID& p_GUID) -> std::wstring {
+            return (::StringFromGUID2(p_GUID, &*guidBuffer.begin(), 40) != 0) ? guidBuffer.c_str() : L"";
+        };
+        const auto toMicroseconds = [](const std::chrono::nanoseconds p_Time) {
+            return std::chrono::duration_cast<std::chrono::microseconds>(p_Time).count();
+        };
+
+        std::wostringstream wos;
+        wos << L"Plugin\tElement\tInvocations\tTotalTime\tMaxTime\tBytesIn\tBytesOut" << std::endl;
+        for (const auto& pluginProfiles : GetProfiles()) {
+            const std::wstring pluginIdString = guidToString(pluginProfiles.first);
+            const auto& vProfiles = pluginProfiles.second;
+            for (size_t i = 0; i < vProfiles.size(); ++i) {
+                const auto& profile = vProfiles[i];
+                wos << pluginIdString << L'\t'
+                    << i << L'\t'
+                    << profile.m_Invocations << L'\t'
+                    << toMicroseconds(profile.m_TotalTime) << L'\t'
+                    << toMicroseconds(profile.m_MaxTime) << L'\t'
+                    << profile.m_BytesIn << L'\t'
+                    << profile.m_BytesOut << std::endl;
+            }
+        }
+        return wos.str();
+    }
+
+} // namespace PCC
@@ -0,0 +1,517 @@
+// PluginPipelineProgram.cpp
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdafx.h>
+#include <PluginPipelineProgram.h>
+#include <PipelinePlugin.h>
+#include <Plugin.h>
+#include <PluginPipeline.h>
+#include <PluginProvider.h>
+#include <StringUtils.h>
+
+#include <assert.h>
+
+
+namespace
+{
+    //
+    // Checks if an instruction can modify the path. Those that cannot
+    // only use the stack, so the path's structure remains valid.
+    //
+    // @param p_Opcode Instruction opcode.
+    // @return true if instruction can modify the path.
+    //
+    bool CanModifyPath(const PCC::PipelineOpcode p_Opcode) noexcept
+    {
+        switch (p_Opcode) {
+            case PCC::PipelineOpcode::PushEntire:
+            case PCC::PipelineOpcode::PushRange:
+            case PCC::PipelineOpcode::PushRegex:
+            case PCC::PipelineOpcode::PushFixed:
+            case PCC::PipelineOpcode::PopNowhere:
+            case PCC::PipelineOpcode::SwapStackValues:
+            case PCC::PipelineOpcode::DuplicateStackValue:
+            case PCC::PipelineOpcode::EnterFrame:
+            case PCC::PipelineOpcode::LeaveFrame:
+                return false;
+            default:
+                return true;
+        }
+    }
+
+} // anonymous namespace
+
+namespace PCC
+{
+    //
+    // Constructor. Compiles the given pipeline elements into a program.
+    //
+    // @param p_vspElements Elements to compile.
+    //
+    PipelineProgram::PipelineProgram(const PipelineElementSPV& p_vspElements)
+        : m_vspElements(p_vspElements),
+          m_Code(),
+          m_BoundCode(),
+          m_pBoundPluginProvider(nullptr)
+    {
+        PipelineCompiler compiler(*this);
+        for (const auto& spElement : m_vspElements) {
+            spElement->Compile(compiler);
+        }
+    }
+
+    //
+    // Runs the program to modify the given path. The result is the same
+    // as calling ModifyPath on each element that was compiled in order.
+    //
+    // @param p_rPath Path to modify (in-place).
+    // @param p_rStack Stack used by stack instructions.
+    // @param p_pPluginProvider Optional object to access plugins.
+    //
+    void PipelineProgram::Run(std::wstring& p_rPath,
+                              PipelineStack& p_rStack,
+                              const PluginProvider* const p_pPluginProvider) const
+    {
+        // Use bound code if possible; otherwise, plugins are looked up for each path.
+        const Code& code = (p_pPluginProvider != nullptr && p_pPluginProvider == m_pBoundPluginProvider)
+            ? m_BoundCode : m_Code;
+        for (const auto& instruction : code.m_vInstructions) {
+            switch (instruction.m_Opcode) {
+                case PipelineOpcode::CallElement: {
+                    code.m_vpElements[instruction.m_Operand1]->ModifyPath(p_rPath, p_rStack, p_pPluginProvider);
+                    break;
+                }
+                case PipelineOpcode::Quotes: {
+                    p_rPath.insert(p_rPath.begin(), 1, L'\"');
+                    p_rPath.append(1, L'\"');
+                    break;
+                }
+                case PipelineOpcode::OptionalQuotes: {
+                    if (StringUtils::FindFirstOf(p_rPath, L" ") != std::wstring::npos) {
+                        p_rPath.insert(p_rPath.begin(), 1, L'\"');
+                        p_rPath.append(1, L'\"');
+                    }
+                    break;
+                }
+                case PipelineOpcode::EmailLinks: {
+                    p_rPath.insert(p_rPath.begin(), 1, L'<');
+                    p_rPath.append(1, L'>');
+                    break;
+                }
+                case PipelineOpcode::BackToForwardSlashes: {
+                    StringUtils::ReplaceChar(p_rPath, L'\\', L'/');
+                    break;
+                }
+                case PipelineOpcode::ForwardToBackslashes: {
+                    StringUtils::ReplaceChar(p_rPath, L'/', L'\\');
+                    break;
+                }
+                case PipelineOpcode::FindReplace: {
+                    StringUtils::ReplaceAll(p_rPath, *code.m_vpSearchers[instruction.m_Operand1], code.m_vStrings[instruction.m_Operand2]);
+                    break;
+                }
+                case PipelineOpcode::RegexReplace: {
+                    try {
+                        p_rPath = code.m_vpRegexes[instruction.m_Operand1]->Replace(p_rPath, code.m_vStrings[instruction.m_Operand2]);
+                    } catch (const std::regex_error&) {
+                        // Probably a problem with the replacement expression; leave path as-is.
+                    }
+                    break;
+                }
+                case PipelineOpcode::PushEntire: {
+                    p_rStack.Push(p_rPath);
+                    break;
+                }
+                case PipelineOpcode::PushRange: {
+                    const size_t begin = instruction.m_Operand1, end = instruction.m_Operand2;
+                    if (begin < p_rPath.size() && begin < end) {
+                        p_rStack.Push(std::wstring_view(p_rPath).substr(begin, end - begin));
+                    } else {
+                        p_rStack.Push({});
+                    }
+                    break;
+                }
+                case PipelineOpcode::PushRegex: {
+                    std::wstring_view part;
+                    try {
+                        RegexMatch match;
+                        const size_t group = instruction.m_Operand2;
+                        if (code.m_vpRegexes[instruction.m_Operand1]->Search(p_rPath, match) && match.Matched(group)) {
+                            part = std::wstring_view(p_rPath).substr(match.Position(group), match.Length(group));
+                        }
+                    } catch (const std::regex_error&) {
+                    }
+                    p_rStack.Push(part);
+                    break;
+                }
+                case PipelineOpcode::PushFixed: {
+                    p_rStack.Push(code.m_vStrings[instruction.m_Operand1]);
+                    break;
+                }
+                case PipelineOpcode::PopEntire: {
+                    if (!p_rStack.Empty()) {
+                        p_rPath = p_rStack.Top();
+                        p_rStack.Pop();
+                    }
+                    break;
+                }
+                case PipelineOpcode::PopRange: {
+                    if (!p_rStack.Empty()) {
+                        const size_t begin = instruction.m_Operand1, end = instruction.m_Operand2;
+                        if (begin < p_rPath.size() && begin <= end) {
+                            p_rPath.replace(begin, end - begin, p_rStack.Top());
+                        }
+                        p_rStack.Pop();
+                    }
+                    break;
+                }
+                case PipelineOpcode::PopRegex: {
+                    if (!p_rStack.Empty()) {
+                        try {
+                            // Replace match by hand, see PopFromStackPipelineElement.
+                            RegexMatch match;
+                            if (code.m_vpRegexes[instruction.m_Operand1]->Search(p_rPath, match)) {
+                                p_rPath.replace(match.Position(0), match.Length(0), p_rStack.Top());
+                            }
+                        } catch (const std::regex_error&) {
+                        }
+                        p_rStack.Pop();
+                    }
+                    break;
+                }
+                case PipelineOpcode::PopStart: {
+                    if (!p_rStack.Empty()) {
+                        p_rPath.insert(0, p_rStack.Top());
+                        p_rStack.Pop();
+                    }
+                    break;
+                }
+                case PipelineOpcode::PopEnd: {
+                    if (!p_rStack.Empty()) {
+                        p_rPath += p_rStack.Top();
+                        p_rStack.Pop();
+                    }
+                    break;
+                }
+                case PipelineOpcode::PopNowhere: {
+                    if (!p_rStack.Empty()) {
+                        p_rStack.Pop();
+                    }
+                    break;
+                }
+                case PipelineOpcode::SwapStackValues: {
+                    if (p_rStack.Size() >= 2) {
+                        p_rStack.Swap();
+                    }
+                    break;
+                }
+                case PipelineOpcode::DuplicateStackValue: {
+                    if (!p_rStack.Empty()) {
+                        p_rStack.Duplicate();
+                    }
+                    break;
+                }
+                case PipelineOpcode::Surround: {
+                    p_rPath.insert(0, code.m_vStrings[instruction.m_Operand1]);
+                    p_rPath.append(code.m_vStrings[instruction.m_Operand2]);
+                    break;
+                }
+                case PipelineOpcode::SurroundIfSpaces: {
+                    if (StringUtils::FindFirstOf(p_rPath, L" ") != std::wstring::npos) {
+                        p_rPath.insert(0, code.m_vStrings[instruction.m_Operand1]);
+                        p_rPath.append(code.m_vStrings[instruction.m_Operand2]);
+                    }
+                    break;
+                }
+                case PipelineOpcode::SetPath: {
+                    p_rPath = code.m_vStrings[instruction.m_Operand1];
+                    break;
+                }
+                case PipelineOpcode::ApplyPlugin: {
+                    if (!code.m_vpPlugins.empty()) {
+                        const Plugin* const pPlugin = code.m_vpPlugins[instruction.m_Operand1];
+                        if (pPlugin != nullptr) {
+                            p_rPath = pPlugin->GetPath(p_rPath);
+                        }
+                    } else if (p_pPluginProvider != nullptr) {
+                        // Not bound, look up plugin like ApplyPluginPipelineElement.
+                        const PluginSP spPlugin = p_pPluginProvider->GetPlugin(code.m_vPluginIds[instruction.m_Operand1]);
+                        if (spPlugin != nullptr) {
+                            p_rPath = spPlugin->GetPath(p_rPath);
+                        }
+                    }
+                    break;
+                }
+                case PipelineOpcode::EnterFrame: {
+                    p_rStack.EnterFrame();
+                    break;
+                }
+                case PipelineOpcode::LeaveFrame: {
+                    p_rStack.LeaveFrame();
+                    break;
+                }
+                default:
+                    assert(false);
+            }
+            if (CanModifyPath(instruction.m_Opcode)) {
+                p_rStack.PathModified();
+            }
+        }
+    }
+
+    //
+    // Binds the program to the given plugin provider. Plugins applied by
+    // the program are looked up once and kept for calls to Run that use
+    // the same provider; if Run is called with another provider, plugins
+    // are looked up for each path instead.
+    //
+    // Plugins that are pipeline plugins are not applied through their
+    // GetPath method; instead, their own bound code is inlined in ours.
+    // Loops cannot happen since pipelines must be validated before being
+    // bound (see PipelinePlugin::GetPipeline).
+    //
+    // Bound plugins are not owned by the program, so it must be re-bound
+    // (or unbound) if the provider changes. The program must not be run
+    // concurrently while it is being bound.
+    //
+    // @param p_pPluginProvider Object to access plugins. Can be nullptr.
+    //
+    void PipelineProgram::Bind(const PluginProvider* const p_pPluginProvider) const
+    {
+        if (p_pPluginProvider != m_pBoundPluginProvider) {
+            Unbind();
+            if (p_pPluginProvider != nullptr) {
+                Code boundCode;
+                Link(p_pPluginProvider, boundCode);
+                m_BoundCode = std::move(boundCode);
+                m_pBoundPluginProvider = p_pPluginProvider;
+            }
+        }
+    }
+
+    //
+    // Unbinds the program from its plugin provider. Plugins will be
+    // looked up for each path until the program is bound again.
+    //
+    void PipelineProgram::Unbind() const noexcept
+    {
+        m_pBoundPluginProvider = nullptr;
+        m_BoundCode = Code();
+    }
+
+    //
+    // Links our code with plugins fetched from the given provider. See Bind.
+    //
+    // @param p_pPluginProvider Object to access plugins.
+    // @param p_rBoundCode Where to store bound code. Must be empty.
+    //
+    void PipelineProgram::Link(const PluginProvider* const p_pPluginProvider,
+                               Code& p_rBoundCode) const
+    {
+        assert(p_pPluginProvider != nullptr);
+        assert(p_rBoundCode.m_vInstructions.empty());
+
+        p_rBoundCode.m_vStrings = m_Code.m_vStrings;
+        p_rBoundCode.m_vpRegexes = m_Code.m_vpRegexes;
+        p_rBoundCode.m_vpSearchers = m_Code.m_vpSearchers;
+        p_rBoundCode.m_vpElements = m_Code.m_vpElements;
+        for (const auto& instruction : m_Code.m_vInstructions) {
+            if (instruction.m_Opcode != PipelineOpcode::ApplyPlugin) {
+                p_rBoundCode.m_vInstructions.push_back(instruction);
+                continue;
+            }
+
+            const GUID& pluginId = m_Code.m_vPluginIds[instruction.m_Operand1];
+            const PluginSP spPlugin = p_pPluginProvider->GetPlugin(pluginId);
+            const auto pPipelinePlugin = dynamic_cast<const Plugins::PipelinePlugin*>(spPlugin.get());
+            const Pipeline* const pPipeline = pPipelinePlugin != nullptr ? pPipelinePlugin->GetPipeline() : nullptr;
+            if (pPipeline != nullptr && pPipeline->GetProgram().m_pBoundPluginProvider == p_pPluginProvider) {
+                // Inline pipeline's code in its own stack frame, since calling
+                // the plugin would run its pipeline with a separate stack.
+                const PipelineProgram& program = pPipeline->GetProgram();
+                p_rBoundCode.m_vInstructions.push_back({ PipelineOpcode::EnterFrame, 0, 0 });
+                AppendCode(p_rBoundCode, program.m_BoundCode);
+                p_rBoundCode.m_vInstructions.push_back({ PipelineOpcode::LeaveFrame, 0, 0 });
+                p_rBoundCode.m_vspInlinedElements.insert(p_rBoundCode.m_vspInlinedElements.end(),
+                                                         program.m_vspElements.cbegin(), program.m_vspElements.cend());
+            } else {
+                p_rBoundCode.m_vPluginIds.push_back(pluginId);
+                p_rBoundCode.m_vpPlugins.push_back(spPlugin.get());
+                p_rBoundCode.m_vInstructions.push_back({ PipelineOpcode::ApplyPlugin,
+                                                         p_rBoundCode.m_vpPlugins.size() - 1, 0 });
+            }
+        }
+    }
+
+    //
+    // Appends code at the end of another code. Constants of the code
+    // are appended to the pools of the other code and instruction
+    // operands are adjusted accordingly.
+    //
+    // @param p_rCode Code to append to.
+    // @param p_Source Code to append.
+    //
+    void PipelineProgram::AppendCode(Code& p_rCode,
+                                     const Code& p_Source)
+    {
+        const size_t stringBase = p_rCode.m_vStrings.size();
+        const size_t regexBase = p_rCode.m_vpRegexes.size();
+        const size_t searcherBase = p_rCode.m_vpSearchers.size();
+        const size_t elementBase = p_rCode.m_vpElements.size();
+        const size_t pluginBase = p_rCode.m_vpPlugins.size();
+        p_rCode.m_vStrings.insert(p_rCode.m_vStrings.end(), p_Source.m_vStrings.cbegin(), p_Source.m_vStrings.cend());
+        p_rCode.m_vpRegexes.insert(p_rCode.m_vpRegexes.end(), p_Source.m_vpRegexes.cbegin(), p_Source.m_vpRegexes.cend());
+        p_rCode.m_vpSearchers.insert(p_rCode.m_vpSearchers.end(), p_Source.m_vpSearchers.cbegin(), p_Source.m_vpSearchers.cend());
+        p_rCode.m_vpElements.insert(p_rCode.m_vpElements.end(), p_Source.m_vpElements.cbegin(), p_Source.m_vpElements.cend());
+        p_rCode.m_vPluginIds.insert(p_rCode.m_vPluginIds.end(), p_Source.m_vPluginIds.cbegin(), p_Source.m_vPluginIds.cend());
+        p_rCode.m_vpPlugins.insert(p_rCode.m_vpPlugins.end(), p_Source.m_vpPlugins.cbegin(), p_Source.m_vpPlugins.cend());
+        p_rCode.m_vspInlinedElements.insert(p_rCode.m_vspInlinedElements.end(),
+                                            p_Source.m_vspInlinedElements.cbegin(), p_Source.m_vspInlinedElements.cend());
+
+        for (PipelineInstruction instruction : p_Source.m_vInstructions) {
+            switch (instruction.m_Opcode) {
+                case PipelineOpcode::CallElement: {
+                    instruction.m_Operand1 += elementBase;
+                    break;
+                }
+                case PipelineOpcode::FindReplace: {
+                    instruction.m_Operand1 += searcherBase;
+                    instruction.m_Operand2 += stringBase;
+                    break;
+                }
+                case PipelineOpcode::Surround:
+                case PipelineOpcode::SurroundIfSpaces: {
+                    instruction.m_Operand1 += stringBase;
+                    instruction.m_Operand2 += stringBase;
+                    break;
+                }
+                case PipelineOpcode::RegexReplace: {
+                    instruction.m_Operand1 += regexBase;
+                    instruction.m_Operand2 += stringBase;
+                    break;
+                }
+                case PipelineOpcode::PushRegex:
+                case PipelineOpcode::PopRegex: {
+                    instruction.m_Operand1 += regexBase;
+                    break;
+                }
+                case PipelineOpcode::PushFixed:
+                case PipelineOpcode::SetPath: {
+                    instruction.m_Operand1 += stringBase;
+                    break;
+                }
+                case PipelineOpcode::ApplyPlugin: {
+                    instruction.m_Operand1 += pluginBase;
+                    break;
+                }
+                default:
+                    break;
+            }
+            p_rCode.m_vInstructions.push_back(instruction);
+        }
+    }
+
+    //
+    // Constructor.
+    //
+    // @param p_rProgram Program to compile instructions into.
+    //
+    PipelineCompiler::PipelineCompiler(PipelineProgram& p_rProgram) noexcept
+        : m_rProgram(p_rProgram)
+    {
+    }
+
+    //
+    // Adds an instruction at the end of the program.
+    //
+    // @param p_Opcode Instruction opcode.
+    // @param p_Operand1 First instruction operand, if needed.
+    // @param p_Operand2 Second instruction operand, if needed.
+    //
+    void PipelineCompiler::Emit(const PipelineOpcode p_Opcode,
+                                const size_t p_Operand1 /*= 0*/,
+                                const size_t p_Operand2 /*= 0*/)
+    {
+        m_rProgram.m_Code.m_vInstructions.push_back({ p_Opcode, p_Operand1, p_Operand2 });
+    }
+
+    //
+    // Adds an instruction that calls an element's ModifyPath method.
+    // Used for elements that cannot be lowered into specific instructions.
+    //
+    // @param p_Element Element to call. Must be kept alive by the program.
+    //
+    void PipelineCompiler::EmitCallElement(const PipelineElement& p_Element)
+    {
+        m_rProgram.m_Code.m_vpElements.push_back(&p_Element);
+        Emit(PipelineOpcode::CallElement, m_rProgram.m_Code.m_vpElements.size() - 1);
+    }
+
+    //
+    // Adds a string to the program's constant pool.
+    //
+    // @param p_String String to add.
+    // @return Index of string in the pool, to be used as an instruction operand.
+    //
+    size_t PipelineCompiler::AddString(const std::wstring& p_String)
+    {
+        m_rProgram.m_Code.m_vStrings.push_back(p_String);
+        return m_rProgram.m_Code.m_vStrings.size() - 1;
+    }
+
+    //
+    // Adds a compiled regex to the program's constant pool.
+    //
+    // @param p_Regex Regex to add. Must be owned by an element kept alive by the program.
+    // @return Index of regex in the pool, to be used as an instruction operand.
+    //
+    size_t PipelineCompiler::AddRegex(const RegexBackend& p_Regex)
+    {
+        m_rProgram.m_Code.m_vpRegexes.push_back(&p_Regex);
+        return m_rProgram.m_Code.m_vpRegexes.size() - 1;
+    }
+
+    //
+    // Adds a substring searcher to the program's constant pool.
+    //
+    // @param p_Searcher Searcher to add. Must be owned by an element kept alive by the program.
+    // @return Index of searcher in the pool, to be used as an instruction operand.
+    //
+    size_t PipelineCompiler::AddSearcher(const StringUtils::Searcher& p_Searcher)
+    {
+        m_rProgram.m_Code.m_vpSearchers.push_back(&p_Searcher);
+        return m_rProgram.m_Code.m_vpSearchers.size() - 1;
+    }
+
+    //
+    // Adds the ID of a plugin applied by the program. The plugin will
+    // be looked up when the program is bound to a plugin provider.
+    //
+    // @param p_PluginId ID of plugin to add.
+    // @return Index of plugin ID, to be used as an instruction operand.
+    //
+    size_t PipelineCompiler::AddPluginId(const GUID& p_PluginId)
+    {
+        m_rProgram.m_Code.m_vPluginIds.push_back(p_PluginId);
+        return m_rProgram.m_Code.m_vPluginIds.size() - 1;
+    }
+
+} // namespace PCC
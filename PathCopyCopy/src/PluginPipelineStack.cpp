@@ -0,0 +1,168 @@
+// PluginPipelineStack.cpp
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdafx.h>
+#include <PluginPipelineStack.h>
+
+#include <assert.h>
+
+
+namespace PCC
+{
+    //
+    // Checks if the stack is empty.
+    //
+    // @return true if there are no values on the stack.
+    //
+    bool PipelineStack::Empty() const noexcept
+    {
+        return m_vSlices.size() == m_FrameBase;
+    }
+
+    //
+    // Returns the number of values on the stack.
+    //
+    // @return Number of values on the stack.
+    //
+    size_t PipelineStack::Size() const noexcept
+    {
+        return m_vSlices.size() - m_FrameBase;
+    }
+
+    //
+    // Returns the value on top of the stack. The stack must not be empty.
+    //
+    // @return View of the top value. Valid until next call to Push or Clear.
+    //
+    std::wstring_view PipelineStack::Top() const noexcept
+    {
+        assert(!Empty());
+        const auto& slice = m_vSlices.back();
+        return std::wstring_view(m_Buffer).substr(slice.m_Offset, slice.m_Length);
+    }
+
+    //
+    // Pushes a value on the stack. The value is copied at the end of the
+    // buffer, unless it is already a view of the buffer (for example, a
+    // value returned by Top), in which case it is reused as-is.
+    //
+    // @param p_Value Value to push.
+    //
+    void PipelineStack::Push(const std::wstring_view p_Value)
+    {
+        const std::less<const wchar_t*> less;
+        const wchar_t* const pBegin = m_Buffer.data();
+        const wchar_t* const pEnd = pBegin + m_Buffer.size();
+        if (!p_Value.empty() && !less(p_Value.data(), pBegin) && !less(pEnd, p_Value.data() + p_Value.size())) {
+            m_vSlices.push_back({ static_cast<size_t>(p_Value.data() - pBegin), p_Value.size() });
+        } else {
+            m_vSlices.push_back({ m_Buffer.size(), p_Value.size() });
+            m_Buffer.append(p_Value);
+        }
+    }
+
+    //
+    // Pops the value on top of the stack. The stack must not be empty.
+    // The value's data is not reclaimed until the stack is cleared.
+    //
+    void PipelineStack::Pop() noexcept
+    {
+        assert(!Empty());
+        m_vSlices.pop_back();
+    }
+
+    //
+    // Swaps the two values on top of the stack. The stack must contain
+    // at least two values.
+    //
+    void PipelineStack::Swap() noexcept
+    {
+        assert(Size() >= 2);
+        std::swap(m_vSlices[m_vSlices.size() - 1], m_vSlices[m_vSlices.size() - 2]);
+    }
+
+    //
+    // Duplicates the value on top of the stack. The stack must not be empty.
+    //
+    void PipelineStack::Duplicate()
+    {
+        assert(!Empty());
+        m_vSlices.push_back(m_vSlices.back());
+    }
+
+    //
+    // Removes all values from the stack, including values hidden by
+    // frames. Memory is kept for future values.
+    //
+    void PipelineStack::Clear() noexcept
+    {
+        m_vSlices.clear();
+        m_Buffer.clear();
+        m_FrameBase = 0;
+        m_vFrameBases.clear();
+        m_PathViewCache.Invalidate();
+    }
+
+    //
+    // Enters a new frame. Values currently on the stack are hidden
+    // until LeaveFrame is called, so the stack appears empty.
+    //
+    void PipelineStack::EnterFrame()
+    {
+        m_vFrameBases.push_back(m_FrameBase);
+        m_FrameBase = m_vSlices.size();
+    }
+
+    //
+    // Leaves the current frame. Values pushed in the frame are dropped and
+    // values hidden by EnterFrame become visible again. Values' data is not
+    // reclaimed until the stack is cleared.
+    //
+    void PipelineStack::LeaveFrame() noexcept
+    {
+        assert(!m_vFrameBases.empty());
+        m_vSlices.resize(m_FrameBase);
+        m_FrameBase = m_vFrameBases.back();
+        m_vFrameBases.pop_back();
+    }
+
+    //
+    // Returns the structure of the path being modified. The path is
+    // only parsed if it was modified since the last call (see PathModified).
+    //
+    // @param p_Path Path being modified.
+    // @return View of path, valid until the path is modified or the next call.
+    //
+    const PathView& PipelineStack::GetPathView(const std::wstring& p_Path)
+    {
+        return m_PathViewCache.Get(p_Path);
+    }
+
+    //
+    // Tells the stack that the path being modified has changed, so that
+    // its structure is parsed again the next time GetPathView is called.
+    //
+    void PipelineStack::PathModified() noexcept
+    {
+        m_PathViewCache.Invalidate();
+    }
+
+} // namespace PCC
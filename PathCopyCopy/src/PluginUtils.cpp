@@ -21,12 +21,14 @@
 
 #include <stdafx.h>
 #include <PluginUtils.h>
+#include <FileSystem.h>
+#include <NetworkShareIndex.h>
 #include <PathCopyCopyPluginsRegistry.h>
 #include <PathCopyCopySettings.h>
+#include <PathView.h>
 #include <StringUtils.h>
 #include <StWSAStartup.h>
 #include <StAddrInfo.h>
-#include <StHandle.h>
 
 #include <DefaultPlugin.h>
 
@@ -36,21 +38,13 @@
 #include <comutil.h>
 #include <lm.h>
 
-#include <coveo/enumerable.h>
-#include <coveo/linq.h>
-
 
 namespace
 {
     constexpr DWORD         INITIAL_BUFFER_SIZE         = 1024;     // Initial size of buffer used to fetch UNC name.
-    constexpr DWORD         MAX_REG_KEY_NAME_SIZE       = 255;      // Max size of a registry key's name.
-
-    const wchar_t* const    SHARES_KEY_NAME             = L"SYSTEM\\CurrentControlSet\\Services\\Lanmanserver\\Shares"; // Name of key storing network shares
-    const wchar_t* const    SHARE_PATH_VALUE            = L"Path=";     // Part of a share key's value containing the share path.
-    constexpr wchar_t       HIDDEN_SHARE_SUFFIX         = L'$';         // Suffix used for hidden shares; we will not consider them unless specified.
 
-    const wchar_t* const    HIDDEN_DRIVE_SHARES_REGEX   = L"^([A-Za-z])\\:((\\\\|/).*)$";   // Regex used to convert hidden drive shares.
-    const wchar_t* const    HIDDEN_DRIVE_SHARES_FORMAT  = L"$1$$$2";                        // Format string used to convert hidden drive shares.
+    constexpr wchar_t       HIDDEN_DRIVE_SHARE_SUFFIX   = L'$';         // Suffix appended to drive letters to get hidden drive shares.
+    const wchar_t* const    REGEX_LINE_TERMINATORS      = L"\r\n\u2028\u2029";  // Characters not matched by . in ECMAScript regexes.
 
     constexpr ULONG         REG_BUFFER_CHUNK_SIZE = 512;        // Size of chunks allocated to read the registry.
 
@@ -77,11 +71,9 @@ namespace PCC
     // @param p_Path Path to check.
     // @return true if path points to a directory.
     //
-    bool PluginUtils::IsDirectory(const std::wstring& p_Path) noexcept
+    bool PluginUtils::IsDirectory(const std::wstring& p_Path)
     {
-        const DWORD attribs = ::GetFileAttributesW(p_Path.c_str());
-        return attribs != INVALID_FILE_ATTRIBUTES &&
-               (attribs & FILE_ATTRIBUTE_DIRECTORY) == FILE_ATTRIBUTE_DIRECTORY;
+        return FileSystem::Current().IsDirectory(p_Path);
     }
 
     //
@@ -96,16 +88,13 @@ namespace PCC
     {
         // Find the last delimiter in the path and truncate path
         // as appropriate to return only the parent's path.
-        std::wstring::size_type lastDelimPos = p_rPath.find_last_of(L"/\\");
+        const std::wstring::size_type lastDelimPos = p_rPath.find_last_of(L"/\\");
         const bool found = (lastDelimPos != std::wstring::npos);
         if (found) {
             // We found a delimiter, clear everything after that
             // (and the delimiter as well). Exception: if we're left
             // with only a drive letter, keep the delimiter.
-            if (lastDelimPos <= 2) {
-                ++lastDelimPos;
-            }
-            p_rPath.erase(lastDelimPos);
+            p_rPath.erase(PathView::GetParentSize(lastDelimPos));
         }
         return found;
     }
@@ -118,21 +107,15 @@ namespace PCC
     // C:\Program Files
     // C:\
     //
+    // Kept for compatibility; to avoid copying parents, use PathView::Parents.
+    //
     // @param p_Path Path to enumerate the parents of.
     // @return List of path's parents.
     //
-    std::vector<std::wstring> PluginUtils::EnumerateParents(std::wstring p_Path)
+    std::vector<std::wstring> PluginUtils::EnumerateParents(const std::wstring_view p_Path)
     {
-        std::vector<std::wstring> vParents;
-        for (;;) {
-            const auto prevPath{p_Path};
-            const auto hasParent = ExtractFolderFromPath(p_Path);
-            if (!hasParent || p_Path == prevPath) {
-                break;
-            }
-            vParents.emplace_back(p_Path);
-        }
-        return vParents;
+        const auto parents = PathView::Parents(p_Path);
+        return std::vector<std::wstring>(parents.begin(), parents.end());
     }
 
     //
@@ -144,48 +127,19 @@ namespace PCC
     //
     bool PluginUtils::FollowSymlinkIfRequired(std::wstring& p_rPath)
     {
-        using namespace coveo::linq;
-
-        // Check if path or one of its parent points to a symlink.
-        const auto isSymlink = [](const std::wstring& path) noexcept {
-            const auto attributes = ::GetFileAttributesW(path.c_str());
-            return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0;
-        };
-        const bool symlink = from(coveo::enumerate_one(p_rPath))
-                           | concat(EnumerateParents(p_rPath))
-                           | any(isSymlink);
-        if (symlink) {
-            // In order to follow the symlink, we need a handle.
-            DWORD flagsAndAttributes = FILE_ATTRIBUTE_NORMAL;
-            if ((::GetFileAttributesW(p_rPath.c_str()) & FILE_ATTRIBUTE_DIRECTORY) != 0) {
-                // Need this flag to open directory handles according to MSDN
-                flagsAndAttributes |= FILE_FLAG_BACKUP_SEMANTICS;
-            }
-            StHandle hFile = ::CreateFileW(p_rPath.c_str(),
-                                           GENERIC_READ,
-                                           FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
-                                           nullptr,
-                                           OPEN_EXISTING,
-                                           flagsAndAttributes,
-                                           nullptr);
-            if (hFile != nullptr) {
-                const auto bufferSize = ::GetFinalPathNameByHandleW(hFile, nullptr, 0, FILE_NAME_NORMALIZED | VOLUME_NAME_DOS);
-                if (bufferSize != 0) {
-                    std::wstring finalPath(bufferSize + 1, L'\0');
-                    const auto finalPathRes = ::GetFinalPathNameByHandleW(hFile,
-                                                                          &*finalPath.begin(),
-                                                                          bufferSize + 1,
-                                                                          FILE_NAME_NORMALIZED | VOLUME_NAME_DOS);
-                    if (finalPathRes != 0) {
-                        p_rPath = finalPath.c_str();
-
-                        // Fetching symlink target probably left us with a weird path, fix it
-                        // because Explorer can't handle paths with \\?\ in them.
-                        StringUtils::ReplaceAll(p_rPath, UNC_DRIVE_SYMLINK_PREFIX, L"");
-                        StringUtils::ReplaceAll(p_rPath, LOCAL_DRIVE_SYMLINK_PREFIX, L"");
-                    }
-                }
-            }
+        // Check if path or one of its parent points to a symlink. If we are in
+        // a menu operation, the file system will remember parents already checked.
+        std::wstring finalPath;
+        const bool symlink = FileSystem::Current().FollowSymlinks(p_rPath, finalPath);
+        if (!finalPath.empty()) {
+            p_rPath = std::move(finalPath);
+
+            // Fetching symlink target probably left us with a weird path, fix it
+            // because Explorer can't handle paths with \\?\ in them.
+            static const StringUtils::Searcher s_UNCDriveSymlinkPrefixSearcher(UNC_DRIVE_SYMLINK_PREFIX);
+            static const StringUtils::Searcher s_LocalDriveSymlinkPrefixSearcher(LOCAL_DRIVE_SYMLINK_PREFIX);
+            StringUtils::ReplaceAll(p_rPath, s_UNCDriveSymlinkPrefixSearcher, std::wstring_view());
+            StringUtils::ReplaceAll(p_rPath, s_LocalDriveSymlinkPrefixSearcher, std::wstring_view());
         }
         return symlink;
     }
@@ -238,6 +192,7 @@ namespace PCC
     // Checks if the given file resides in a directory in a network share.
     // If it does, returns its corresponding network path.
     // Ex: C:\SharedDir\File.txt -> \\thiscomputer\SharedDir\File.txt
+    // If more than one share contains the file, the most specific one is used.
     //
     // @param p_rFilePath Local file path. Upon exit, will contain network path.
     // @param p_UseHiddenShares Whether to consider hidden shares when looking for valid shares.
@@ -246,64 +201,27 @@ namespace PCC
     bool PluginUtils::GetNetworkShareFilePath(std::wstring& p_rFilePath,
                                               const bool p_UseHiddenShares)
     {
-        bool converted = false;
-
-        // Scan registry to see if we can find a share that contains this path.
-        // Shares are stored in multi-string registry values in the Lanmanserver service keys.
-        ATL::CRegKey shareKey;
-        if (shareKey.Open(HKEY_LOCAL_MACHINE, SHARES_KEY_NAME, KEY_READ) == ERROR_SUCCESS) {
-            // Iterate registry values to check each share.
-            std::wstring valueName(MAX_REG_KEY_NAME_SIZE + 1, L'\0');
-            std::wstring multiStringValue;
-            std::wstring path;
-            LONG ret = 0;
-            DWORD i = 0;
-            do {
-                DWORD valueNameSize = MAX_REG_KEY_NAME_SIZE;
-                DWORD valueType = 0;
-                ret = ::RegEnumValue(shareKey, i, &*valueName.begin(), &valueNameSize, nullptr, &valueType, nullptr, nullptr);
-                if (ret == ERROR_SUCCESS && valueType == REG_MULTI_SZ) {
-                    // Get the multi-string values.
-                    ULONG bufferSize = INITIAL_BUFFER_SIZE;
-                    std::vector<wchar_t> vBuffer;
-                    do {
-                        vBuffer.resize(bufferSize, L'\0');
-                        ret = shareKey.QueryMultiStringValue(valueName.c_str(), vBuffer.data(), &bufferSize);
-                    } while (ret == ERROR_MORE_DATA);
-                    if (ret == ERROR_SUCCESS) {
-                        // Make sure this is not a hidden share (unless we use them).
-                        if (valueNameSize != 0 && (p_UseHiddenShares || valueName.at(valueNameSize - 1) != HIDDEN_SHARE_SUFFIX)) {
-                            // Find the "Path=" part of the mult-string. This contains the share path.
-                            multiStringValue.assign(vBuffer.data(), bufferSize);
-                            path = GetMultiStringLineBeginningWith(multiStringValue, SHARE_PATH_VALUE);
-                            if (!path.empty()) {
-                                // Check if our path is in that share.
-                                if (p_rFilePath.find(path) == 0) {
-                                    // Success: this is a share that contains our path.
-                                    // Replace the start of the path with the computer and share name.
-                                    std::wstringstream ss;
-                                    ss << L"\\\\" << GetLocalComputerName() << L"\\" << valueName.c_str();
-                                    if (*path.rbegin() == L'\\' || *path.rbegin() == L'/') {
-                                        // The substr below will remove the terminator if the share path
-                                        // ends with one (for example, for drives' administrative shares).
-                                        // We'll have to add an extra one manually.
-                                        ss << L'\\';
-                                    }
-                                    ss << p_rFilePath.substr(path.size());
-                                    p_rFilePath = ss.str();
-                                    converted = true;
-                                    break;
-                                }
-                            }
-                        }
-                    }
-                }
-
-                // Go to next share.
-                ++i;
-            } while (ret == ERROR_SUCCESS);
+        // Look for a share that contains this path in the index of local shares,
+        // which is only loaded again from the registry when shares change.
+        const auto spShares = NetworkShareIndex::GetLocalShares();
+        const NetworkShareIndex::Share* const pShare = spShares->Find(p_rFilePath, p_UseHiddenShares);
+        const bool converted = pShare != nullptr;
+        if (converted) {
+            // Replace the start of the path with the computer and share name.
+            const std::wstring& computerName = GetLocalComputerName();
+            const size_t sharePathSize = pShare->m_Path.size();
+            std::wstring sharePath;
+            sharePath.reserve(4 + computerName.size() + pShare->m_Name.size() + p_rFilePath.size() - sharePathSize);
+            sharePath.append(L"\\\\").append(computerName).append(L"\\").append(pShare->m_Name);
+            if (pShare->m_Path.back() == L'\\' || pShare->m_Path.back() == L'/') {
+                // The share path's terminator is removed along with the rest of the
+                // share path (for example, for drives' administrative shares).
+                // We'll have to add an extra one manually.
+                sharePath.push_back(L'\\');
+            }
+            sharePath.append(p_rFilePath, sharePathSize, std::wstring::npos);
+            p_rFilePath = std::move(sharePath);
         }
-
         return converted;
     }
 
@@ -317,23 +235,31 @@ namespace PCC
     //
     bool PluginUtils::GetHiddenDriveShareFilePath(std::wstring& p_rFilePath)
     {
-        // Try to perform the replacement in one shot. If it works, the path is converted.
-        bool converted = false;
-
-        try {
-            const std::wregex hiddenDriveShareRegex(HIDDEN_DRIVE_SHARES_REGEX, std::regex_constants::ECMAScript);
-            const std::wstring replaced = std::regex_replace(p_rFilePath, hiddenDriveShareRegex, HIDDEN_DRIVE_SHARES_FORMAT);
-            if (!replaced.empty()) {
-                std::wstringstream ss;
-                ss << L"\\\\" << GetLocalComputerName() << L"\\" << replaced;
-                p_rFilePath = ss.str();
-                converted = true;
-            }
-        } catch (const std::regex_error&) {
-            // Didn't work.
+        // Convert drive path to a path on its hidden drive share. Other paths
+        // are appended to the computer name unchanged, to keep the behavior of
+        // the regex-based conversion this replaces.
+        if (p_rFilePath.empty()) {
+            return false;
         }
-
-        return converted;
+        const wchar_t drive = p_rFilePath.front();
+        const bool isDrivePath = p_rFilePath.size() >= 3 &&
+                                 ((drive >= L'A' && drive <= L'Z') || (drive >= L'a' && drive <= L'z')) &&
+                                 p_rFilePath[1] == L':' &&
+                                 (p_rFilePath[2] == L'\\' || p_rFilePath[2] == L'/') &&
+                                 StringUtils::FindFirstOf(std::wstring_view(p_rFilePath).substr(3), REGEX_LINE_TERMINATORS) == std::wstring_view::npos;
+        const std::wstring& computerName = GetLocalComputerName();
+        std::wstring sharePath;
+        sharePath.reserve(3 + computerName.size() + p_rFilePath.size());
+        sharePath.append(L"\\\\").append(computerName).push_back(L'\\');
+        if (isDrivePath) {
+            sharePath.push_back(drive);
+            sharePath.push_back(HIDDEN_DRIVE_SHARE_SUFFIX);
+            sharePath.append(p_rFilePath, 2, std::wstring::npos);
+        } else {
+            sharePath.append(p_rFilePath);
+        }
+        p_rFilePath = std::move(sharePath);
+        return true;
     }
 
     //
@@ -484,18 +410,18 @@ namespace PCC
     // @param p_Separator Character used to separate the plugin IDs in the string.
     // @return Vector of plugin IDs as GUID structs.
     //
-    GUIDV PluginUtils::StringToPluginIds(std::wstring p_PluginIdsAsString,
+    GUIDV PluginUtils::StringToPluginIds(const std::wstring_view p_PluginIdsAsString,
                                          const wchar_t p_Separator)
     {
         // Assume there are no plugin IDs.
         GUIDV vPluginIds;
 
-        // First split the string.
-        WStringV vStringParts = StringUtils::Split(std::move(p_PluginIdsAsString), p_Separator);
-
-        // Scan parts and convert to GUIDs.
+        // Scan parts of the string and convert to GUIDs. CLSIDFromString needs
+        // a null-terminated string, so reuse the same buffer for all parts.
+        std::wstring stringPart;
         GUID onePluginId = { 0 };
-        for (const std::wstring& stringPart : vStringParts) {
+        for (const std::wstring_view part : StringUtils::SplitView(p_PluginIdsAsString, std::wstring_view(&p_Separator, 1))) {
+            stringPart.assign(part);
             if (SUCCEEDED(::CLSIDFromString(stringPart.c_str(), &onePluginId))) {
                 vPluginIds.push_back(onePluginId);
             }
@@ -511,21 +437,18 @@ namespace PCC
     // @param p_Separator Character used to separate the integers in the string.
     // @return Vector of unsigned integers.
     //
-    UInt32V PluginUtils::StringToUInt32s(std::wstring p_UInt32sAsString,
+    UInt32V PluginUtils::StringToUInt32s(const std::wstring_view p_UInt32sAsString,
                                          const wchar_t p_Separator)
     {
         // Assume there are no integers.
         UInt32V vUInt32s;
 
-        // First split the string.
-        WStringV vStringParts = StringUtils::Split(std::move(p_UInt32sAsString), p_Separator);
-
-        // Scan parts and convert to integers.
-        for (const std::wstring& stringPart : vStringParts) {
-            std::wistringstream wis(stringPart.c_str());
-            uint32_t integer = 0;
-            wis >> integer;
-            vUInt32s.push_back(integer);
+        // Scan parts of the string and convert to integers. wcstoul needs
+        // a null-terminated string, so reuse the same buffer for all parts.
+        std::wstring stringPart;
+        for (const std::wstring_view part : StringUtils::SplitView(p_UInt32sAsString, std::wstring_view(&p_Separator, 1))) {
+            stringPart.assign(part);
+            vUInt32s.push_back(static_cast<uint32_t>(::wcstoul(stringPart.c_str(), nullptr, 10)));
         }
 
         return vUInt32s;
@@ -0,0 +1,145 @@
+// RegexBackend.cpp
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdafx.h>
+#include <RegexBackend.h>
+
+
+namespace
+{
+    //
+    // Returns the options to use to compile a std::regex.
+    //
+    // @param p_IgnoreCase Whether to ignore case when matching.
+    // @return Regex syntax options.
+    //
+    std::regex_constants::syntax_option_type GetSyntaxOptions(const bool p_IgnoreCase) noexcept
+    {
+#pragma warning(suppress: 26812)    // std::regex_constants::syntax_option_type could be enum class
+        std::regex_constants::syntax_option_type reOptions = std::regex_constants::ECMAScript;
+        if (p_IgnoreCase) {
+            reOptions |= std::regex_constants::icase;
+        }
+        return reOptions;
+    }
+
+} // anonymous namespace
+
+namespace PCC
+{
+    //
+    // Checks if a group participated in the match.
+    //
+    // @param p_Group Group number; 0 is the entire match.
+    // @return true if group matched.
+    //
+    bool RegexMatch::Matched(const size_t p_Group) const noexcept
+    {
+        return (p_Group * 2) + 1 < m_vSlots.size() && m_vSlots[p_Group * 2] != std::wstring::npos;
+    }
+
+    //
+    // Returns the position of a group in the string that was searched.
+    //
+    // @param p_Group Group number; 0 is the entire match.
+    // @return Position of group, or 0 if group did not match.
+    //
+    size_t RegexMatch::Position(const size_t p_Group) const noexcept
+    {
+        return Matched(p_Group) ? m_vSlots[p_Group * 2] : 0;
+    }
+
+    //
+    // Returns the length of a group in the string that was searched.
+    //
+    // @param p_Group Group number; 0 is the entire match.
+    // @return Length of group, or 0 if group did not match.
+    //
+    size_t RegexMatch::Length(const size_t p_Group) const noexcept
+    {
+        return Matched(p_Group) ? m_vSlots[(p_Group * 2) + 1] - m_vSlots[p_Group * 2] : 0;
+    }
+
+    //
+    // Creates the backend to run a regex.
+    //
+    // @param p_Regex Regex to compile.
+    // @param p_IgnoreCase Whether to ignore case when matching.
+    // @return Regex backend.
+    // @throws std::regex_error If p_Regex is invalid.
+    //
+    std::unique_ptr<const RegexBackend> RegexBackend::Create(const std::wstring& p_Regex,
+                                                             const bool p_IgnoreCase)
+    {
+        return std::make_unique<StdRegexBackend>(p_Regex, p_IgnoreCase);
+    }
+
+    //
+    // Constructor.
+    //
+    // @param p_Regex Regex to compile.
+    // @param p_IgnoreCase Whether to ignore case when matching.
+    // @throws std::regex_error If p_Regex is invalid.
+    //
+    StdRegexBackend::StdRegexBackend(const std::wstring& p_Regex,
+                                     const bool p_IgnoreCase)
+        : RegexBackend(),
+          m_Regex(p_Regex, GetSyntaxOptions(p_IgnoreCase))
+    {
+    }
+
+    //
+    // Looks for the first match in a string using std::regex_search.
+    //
+    // @param p_String String to look into.
+    // @param p_rMatch Where to store match, if found.
+    // @return true if a match was found.
+    //
+    bool StdRegexBackend::Search(const std::wstring& p_String,
+                                 RegexMatch& p_rMatch) const
+    {
+        std::wsmatch match;
+        const bool found = std::regex_search(p_String, match, m_Regex);
+        if (found) {
+            p_rMatch.m_vSlots.resize(match.size() * 2);
+            for (size_t i = 0; i < match.size(); ++i) {
+                const bool matched = match[i].matched;
+                p_rMatch.m_vSlots[i * 2] = matched ? static_cast<size_t>(match.position(i)) : std::wstring::npos;
+                p_rMatch.m_vSlots[(i * 2) + 1] = matched ? static_cast<size_t>(match.position(i) + match.length(i)) : std::wstring::npos;
+            }
+        }
+        return found;
+    }
+
+    //
+    // Replaces all matches in a string using std::regex_replace.
+    //
+    // @param p_String String where to replace matches.
+    // @param p_Format ECMAScript format string used for replacements.
+    // @return Resulting string.
+    //
+    std::wstring StdRegexBackend::Replace(const std::wstring& p_String,
+                                          const std::wstring& p_Format) const
+    {
+        return std::regex_replace(p_String, m_Regex, p_Format);
+    }
+
+} // namespace PCC
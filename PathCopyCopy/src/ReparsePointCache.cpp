@@ -0,0 +1,235 @@
+// ReparsePointCache.cpp
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdafx.h>
+#include <ReparsePointCache.h>
+#include <FileSystem.h>
+#include <PathView.h>
+#include <StringUtils.h>
+
+#include <algorithm>
+
+
+namespace PCC
+{
+    //
+    // Returns the proportion of path parts whose status was found in the cache.
+    //
+    // @return Hit rate, between 0 and 1. If no part has been looked at, returns 0.
+    //
+    double ReparsePointCache::Stats::GetPartHitRate() const noexcept
+    {
+        const size_t numLookups = m_NumPartHits + m_NumPartMisses;
+        return numLookups != 0 ? static_cast<double>(m_NumPartHits) / static_cast<double>(numLookups) : 0.0;
+    }
+
+    //
+    // Returns the proportion of reparse point targets found in the cache.
+    //
+    // @return Hit rate, between 0 and 1. If no target has been looked at, returns 0.
+    //
+    double ReparsePointCache::Stats::GetTargetHitRate() const noexcept
+    {
+        const size_t numLookups = m_NumTargetHits + m_NumTargetMisses;
+        return numLookups != 0 ? static_cast<double>(m_NumTargetHits) / static_cast<double>(numLookups) : 0.0;
+    }
+
+    //
+    // Compares two edges of the trie.
+    //
+    // @param p_Other Edge to compare with.
+    // @return true if both edges link the same parent to the same path part.
+    //
+    bool ReparsePointCache::Edge::operator==(const Edge& p_Other) const noexcept
+    {
+        return m_ParentIndex == p_Other.m_ParentIndex && m_Part == p_Other.m_Part;
+    }
+
+    //
+    // Computes the hash of an edge of the trie.
+    //
+    // @param p_Edge Edge to hash.
+    // @return Hash value.
+    //
+    size_t ReparsePointCache::EdgeHash::operator()(const Edge& p_Edge) const noexcept
+    {
+        return std::hash<std::wstring>()(p_Edge.m_Part) ^ (p_Edge.m_ParentIndex * 0x9E3779B9u);
+    }
+
+    //
+    // Constructor. Creates an empty cache.
+    //
+    ReparsePointCache::ReparsePointCache()
+        : m_vNodes(1),
+          m_mChildren(),
+          m_Stats(),
+          m_vParentSizes(),
+          m_Prefix(),
+          m_Edge()
+    {
+    }
+
+    //
+    // Checks if a path or one of its parents is a reparse point and,
+    // if so, returns the path's final path. Only the parents not seen
+    // before by this cache are checked in the file system; the path
+    // itself is always checked, since files are rarely looked at twice.
+    //
+    // @param p_FileSystem File system to query for unknown parents.
+    // @param p_Path Path to check.
+    // @param p_rFinalPath Where to store the final path, in the form returned
+    //                     by FileSystem::GetFinalPath. Set to an empty string
+    //                     if the final path cannot be determined.
+    // @return true if p_Path or one of its parents is a reparse point.
+    //
+    bool ReparsePointCache::FollowSymlinks(const FileSystem& p_FileSystem,
+                                           const std::wstring& p_Path,
+                                           std::wstring& p_rFinalPath)
+    {
+        // Parents are returned from the closest to the farthest; we
+        // need to walk down the trie, so we look at them in reverse.
+        m_vParentSizes.clear();
+        for (const std::wstring_view parent : PathView::Parents(p_Path)) {
+            m_vParentSizes.push_back(parent.size());
+        }
+
+        size_t nodeIndex = 0;
+        size_t reparsePointIndex = 0;
+        size_t reparsePointSize = 0;
+        size_t prevParentSize = 0;
+        bool missing = false;
+        for (auto it = m_vParentSizes.crbegin(); !missing && it != m_vParentSizes.crend(); ++it) {
+            // Separators between path parts are not part of the key,
+            // so that "C:\Foo" and "C:\\Foo" end up on the same node.
+            std::wstring_view part(p_Path.data() + prevParentSize, *it - prevParentSize);
+            if (prevParentSize != 0) {
+                part.remove_prefix(std::min(part.find_first_not_of(L"\\/"), part.size()));
+            }
+            prevParentSize = *it;
+            if (part.empty()) {
+                continue;
+            }
+
+            nodeIndex = GetChild(nodeIndex, part);
+            Node& rNode = m_vNodes[nodeIndex];
+            if (rNode.m_Status == Status::Unknown) {
+                ++m_Stats.m_NumPartMisses;
+                m_Prefix.assign(p_Path, 0, *it);
+                const DWORD attributes = p_FileSystem.GetAttributes(m_Prefix);
+                if (attributes == INVALID_FILE_ATTRIBUTES) {
+                    rNode.m_Status = Status::Missing;
+                } else if ((attributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0) {
+                    rNode.m_Status = Status::ReparsePoint;
+                } else {
+                    rNode.m_Status = Status::Regular;
+                }
+            } else {
+                ++m_Stats.m_NumPartHits;
+            }
+            if (rNode.m_Status == Status::ReparsePoint) {
+                reparsePointIndex = nodeIndex;
+                reparsePointSize = *it;
+            }
+
+            // If a parent does not exist, its own parents can still be
+            // reparse points, but the path cannot be followed.
+            missing = rNode.m_Status == Status::Missing;
+        }
+
+        const DWORD attributes = !missing ? p_FileSystem.GetAttributes(p_Path) : INVALID_FILE_ATTRIBUTES;
+        const bool isReparsePoint = attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0;
+        const bool found = isReparsePoint || reparsePointIndex != 0;
+        p_rFinalPath.clear();
+        if (isReparsePoint) {
+            // The path itself is a reparse point, so it must be opened.
+            if (!p_FileSystem.GetFinalPath(p_Path, p_rFinalPath)) {
+                p_rFinalPath.clear();
+            }
+        } else if (found && attributes != INVALID_FILE_ATTRIBUTES) {
+            // The final path is the final path of the last reparse point in the
+            // parents (which follows all the others), followed by the rest.
+            Node& rReparsePoint = m_vNodes[reparsePointIndex];
+            if (!rReparsePoint.m_HasTarget) {
+                ++m_Stats.m_NumTargetMisses;
+                m_Prefix.assign(p_Path, 0, reparsePointSize);
+                if (!p_FileSystem.GetFinalPath(m_Prefix, rReparsePoint.m_Target)) {
+                    rReparsePoint.m_Target.clear();
+                }
+                rReparsePoint.m_HasTarget = true;
+            } else {
+                ++m_Stats.m_NumTargetHits;
+            }
+            if (!rReparsePoint.m_Target.empty()) {
+                p_rFinalPath = rReparsePoint.m_Target;
+                p_rFinalPath.append(p_Path, reparsePointSize, std::wstring::npos);
+            }
+        }
+        return found;
+    }
+
+    //
+    // Forgets everything in the cache and resets its counters.
+    //
+    void ReparsePointCache::Clear() noexcept
+    {
+        // Keep the root node, so that clearing does not need to allocate.
+        m_vNodes.resize(1);
+        m_mChildren.clear();
+        m_Stats = Stats();
+    }
+
+    //
+    // Returns counters of hits and misses of this cache.
+    //
+    // @return Cache statistics.
+    //
+    auto ReparsePointCache::GetStats() const noexcept -> const Stats&
+    {
+        return m_Stats;
+    }
+
+    //
+    // Returns the child of a node for a given path part, adding it if needed.
+    //
+    // @param p_NodeIndex Index of parent node.
+    // @param p_Part Path part. Will be compared case-insensitively.
+    // @return Index of child node.
+    //
+    size_t ReparsePointCache::GetChild(const size_t p_NodeIndex,
+                                       const std::wstring_view p_Part)
+    {
+        m_Edge.m_ParentIndex = p_NodeIndex;
+        m_Edge.m_Part.assign(p_Part);
+        std::transform(m_Edge.m_Part.begin(), m_Edge.m_Part.end(), m_Edge.m_Part.begin(), [](const wchar_t c) {
+            return c == L'/' ? L'\\' : StringUtils::ToUppercase(c);
+        });
+        const auto it = m_mChildren.find(m_Edge);
+        if (it != m_mChildren.end()) {
+            return it->second;
+        }
+
+        const size_t childIndex = m_vNodes.size();
+        m_mChildren.emplace(m_Edge, childIndex);
+        m_vNodes.emplace_back();
+        return childIndex;
+    }
+
+} // namespace PCC
@@ -22,11 +22,511 @@
 #include <stdafx.h>
 #include <StringUtils.h>
 
+#include <algorithm>
 #include <assert.h>
+#include <cwchar>
 #include <cwctype>
-#include <functional>
-#include <sstream>
+#include <execution>
+#include <numeric>
 
+#if defined(_M_IX86) || defined(_M_X64)
+#include <intrin.h>
+#include <immintrin.h>
+#define STRINGUTILS_USE_SIMD
+#endif
+
+
+namespace
+{
+    // Minimum number of strings to sort before using a parallel sort.
+    constexpr size_t    PARALLEL_SORT_THRESHOLD         = 10000;
+
+    //
+    // Returns a string containing all ASCII control characters.
+    //
+    // @return String containing characters 0x00-0x1F and 0x7F.
+    //
+    std::wstring GetControlChars()
+    {
+        std::wstring controlChars;
+        for (wchar_t c = 0x00; c <= 0x1F; ++c) {
+            controlChars.push_back(c);
+        }
+        controlChars.push_back(L'\x7F');
+        return controlChars;
+    }
+
+    //
+    // Replaces all non-overlapping matches of a value in a string. The result
+    // is built in a single pass, so that the string's tail is not moved for
+    // each match like with repeated calls to std::wstring::replace.
+    //
+    // @param p_rString String to modify (in-place).
+    // @param p_OldValueSize Size of value to replace. If 0, nothing is replaced.
+    // @param p_NewValue Replacement value.
+    // @param p_Find Function used to find the next match, called with the
+    //               string and position where to start looking.
+    //
+    template<typename Finder>
+    void ReplaceAllMatches(std::wstring& p_rString,
+                           const size_t p_OldValueSize,
+                           const std::wstring_view p_NewValue,
+                           const Finder& p_Find)
+    {
+        if (p_OldValueSize == 0) {
+            return;
+        }
+        size_t pos = p_Find(p_rString, 0);
+        if (pos == std::wstring::npos) {
+            return;
+        }
+
+        if (p_NewValue.size() == p_OldValueSize) {
+            // Tail never moves, so matches can be replaced in-place.
+            do {
+                std::copy(p_NewValue.cbegin(), p_NewValue.cend(), p_rString.begin() + pos);
+                pos = p_Find(p_rString, pos + p_OldValueSize);
+            } while (pos != std::wstring::npos);
+            return;
+        }
+
+        std::wstring result;
+        result.reserve(p_NewValue.size() > p_OldValueSize
+            ? p_rString.size() + p_NewValue.size() - p_OldValueSize
+            : p_rString.size());
+        size_t from = 0;
+        do {
+            result.append(p_rString, from, pos - from);
+            result.append(p_NewValue);
+            from = pos + p_OldValueSize;
+            pos = p_Find(p_rString, from);
+        } while (pos != std::wstring::npos);
+        result.append(p_rString, from, std::wstring::npos);
+        p_rString = std::move(result);
+    }
+
+    //
+    // Returns the number of UTF-8 bytes needed to encode a character of a
+    // UTF-16 string. A surrogate pair is encoded as a whole when looking at
+    // its high surrogate; its low surrogate then needs no bytes. Unpaired
+    // surrogates are encoded as U+FFFD (replacement character).
+    //
+    // @param p_String UTF-16 string.
+    // @param p_Pos Position of character in string.
+    // @return Number of UTF-8 bytes needed for character.
+    //
+    size_t UTF8Size(const std::wstring_view p_String,
+                    const size_t p_Pos) noexcept
+    {
+        const wchar_t c = p_String[p_Pos];
+        if (c < 0x80) {
+            return 1;
+        } else if (c < 0x800) {
+            return 2;
+        } else if (c >= 0xD800 && c <= 0xDBFF) {
+            return (p_Pos + 1 < p_String.size() && p_String[p_Pos + 1] >= 0xDC00 && p_String[p_Pos + 1] <= 0xDFFF) ? 4 : 3;
+        } else if (c >= 0xDC00 && c <= 0xDFFF) {
+            return (p_Pos > 0 && p_String[p_Pos - 1] >= 0xD800 && p_String[p_Pos - 1] <= 0xDBFF) ? 0 : 3;
+        }
+        return 3;
+    }
+
+    //
+    // Converts a character of a UTF-16 string to UTF-8. See UTF8Size.
+    //
+    // @param p_String UTF-16 string.
+    // @param p_Pos Position of character in string.
+    // @param p_pBytes Where to store UTF-8 bytes. Must have room for 4 bytes.
+    // @return Number of UTF-8 bytes stored.
+    //
+    size_t ToUTF8(const std::wstring_view p_String,
+                  const size_t p_Pos,
+                  uint8_t* const p_pBytes) noexcept
+    {
+        const size_t size = UTF8Size(p_String, p_Pos);
+        uint32_t codePoint = p_String[p_Pos];
+        if (size == 4) {
+            codePoint = 0x10000 + (((codePoint - 0xD800) << 10) | (p_String[p_Pos + 1] - 0xDC00));
+        } else if (size == 3 && codePoint >= 0xD800 && codePoint <= 0xDFFF) {
+            codePoint = 0xFFFD;
+        }
+        switch (size) {
+            case 1: {
+                p_pBytes[0] = static_cast<uint8_t>(codePoint);
+                break;
+            }
+            case 2: {
+                p_pBytes[0] = static_cast<uint8_t>(0xC0 | (codePoint >> 6));
+                p_pBytes[1] = static_cast<uint8_t>(0x80 | (codePoint & 0x3F));
+                break;
+            }
+            case 3: {
+                p_pBytes[0] = static_cast<uint8_t>(0xE0 | (codePoint >> 12));
+                p_pBytes[1] = static_cast<uint8_t>(0x80 | ((codePoint >> 6) & 0x3F));
+                p_pBytes[2] = static_cast<uint8_t>(0x80 | (codePoint & 0x3F));
+                break;
+            }
+            case 4: {
+                p_pBytes[0] = static_cast<uint8_t>(0xF0 | (codePoint >> 18));
+                p_pBytes[1] = static_cast<uint8_t>(0x80 | ((codePoint >> 12) & 0x3F));
+                p_pBytes[2] = static_cast<uint8_t>(0x80 | ((codePoint >> 6) & 0x3F));
+                p_pBytes[3] = static_cast<uint8_t>(0x80 | (codePoint & 0x3F));
+                break;
+            }
+            default:
+                break;
+        }
+        return size;
+    }
+
+#ifdef STRINGUTILS_USE_SIMD
+    static_assert(sizeof(wchar_t) == sizeof(uint16_t), "Vectorized kernels expect UTF-16 characters");
+
+    using SimdLevel = StringUtils::SimdLevel;
+
+    //
+    // Checks which instruction sets are supported by the processor
+    // (and the OS, in the case of AVX2).
+    //
+    // @return Best instruction set that can be used.
+    //
+    SimdLevel DetectSimdLevel() noexcept
+    {
+        int cpuInfo[4] = { 0 };
+        ::__cpuid(cpuInfo, 0);
+        const int maxLeaf = cpuInfo[0];
+        ::__cpuid(cpuInfo, 1);
+        const bool sse2 = (cpuInfo[3] & (1 << 26)) != 0;
+        const bool osxsave = (cpuInfo[2] & (1 << 27)) != 0;
+        const bool avx = (cpuInfo[2] & (1 << 28)) != 0;
+        bool avx2 = false;
+        if (osxsave && avx && maxLeaf >= 7 && (::_xgetbv(0) & 0x6) == 0x6) {
+            ::__cpuidex(cpuInfo, 7, 0);
+            avx2 = (cpuInfo[1] & (1 << 5)) != 0;
+        }
+        return avx2 ? SimdLevel::AVX2 : (sse2 ? SimdLevel::SSE2 : SimdLevel::Scalar);
+    }
+
+    //
+    // Returns the index of the lowest bit set in a non-zero mask.
+    //
+    // @param p_Mask Mask to scan. Must not be zero.
+    // @return Index of lowest bit set.
+    //
+    size_t LowestBitSet(const unsigned long p_Mask) noexcept
+    {
+        unsigned long index = 0;
+        ::_BitScanForward(&index, p_Mask);
+        return index;
+    }
+
+    //
+    // Replaces characters using 128-bit vectors. Returns the number of
+    // characters processed; remaining characters must be processed by
+    // the caller.
+    //
+    // @param p_pChars Characters to modify.
+    // @param p_Size Number of characters.
+    // @param p_OldChar Character to replace.
+    // @param p_NewChar Replacement character.
+    // @return Number of characters processed.
+    //
+    size_t ReplaceCharSSE2(wchar_t* const p_pChars,
+                           const size_t p_Size,
+                           const wchar_t p_OldChar,
+                           const wchar_t p_NewChar) noexcept
+    {
+        const __m128i oldChars = _mm_set1_epi16(static_cast<short>(p_OldChar));
+        const __m128i newChars = _mm_set1_epi16(static_cast<short>(p_NewChar));
+        size_t i = 0;
+        for (; i + 8 <= p_Size; i += 8) {
+            __m128i* const pBlock = reinterpret_cast<__m128i*>(p_pChars + i);
+            const __m128i block = _mm_loadu_si128(pBlock);
+            const __m128i matches = _mm_cmpeq_epi16(block, oldChars);
+            if (_mm_movemask_epi8(matches) != 0) {
+                _mm_storeu_si128(pBlock, _mm_or_si128(_mm_and_si128(matches, newChars),
+                                                      _mm_andnot_si128(matches, block)));
+            }
+        }
+        return i;
+    }
+
+    //
+    // Replaces characters using 256-bit vectors. See ReplaceCharSSE2.
+    //
+    size_t ReplaceCharAVX2(wchar_t* const p_pChars,
+                           const size_t p_Size,
+                           const wchar_t p_OldChar,
+                           const wchar_t p_NewChar) noexcept
+    {
+        const __m256i oldChars = _mm256_set1_epi16(static_cast<short>(p_OldChar));
+        const __m256i newChars = _mm256_set1_epi16(static_cast<short>(p_NewChar));
+        size_t i = 0;
+        for (; i + 16 <= p_Size; i += 16) {
+            __m256i* const pBlock = reinterpret_cast<__m256i*>(p_pChars + i);
+            const __m256i block = _mm256_loadu_si256(pBlock);
+            const __m256i matches = _mm256_cmpeq_epi16(block, oldChars);
+            if (_mm256_movemask_epi8(matches) != 0) {
+                _mm256_storeu_si256(pBlock, _mm256_blendv_epi8(block, newChars, matches));
+            }
+        }
+        return i;
+    }
+
+    //
+    // Looks for any of a set of characters using 128-bit vectors. If no
+    // character is found, returns the number of characters processed;
+    // remaining characters must be processed by the caller.
+    //
+    // @param p_pChars Characters to scan.
+    // @param p_Size Number of characters.
+    // @param p_Chars Characters to look for.
+    // @param p_rFound Set to true if a character is found.
+    // @return Index of first character found, or number of characters processed.
+    //
+    size_t FindFirstOfSSE2(const wchar_t* const p_pChars,
+                           const size_t p_Size,
+                           const std::wstring_view p_Chars,
+                           bool& p_rFound) noexcept
+    {
+        size_t i = 0;
+        for (; i + 8 <= p_Size; i += 8) {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_pChars + i));
+            __m128i matches = _mm_setzero_si128();
+            for (const wchar_t c : p_Chars) {
+                matches = _mm_or_si128(matches, _mm_cmpeq_epi16(block, _mm_set1_epi16(static_cast<short>(c))));
+            }
+            const int mask = _mm_movemask_epi8(matches);
+            if (mask != 0) {
+                p_rFound = true;
+                return i + (LowestBitSet(static_cast<unsigned long>(mask)) / 2);
+            }
+        }
+        return i;
+    }
+
+    //
+    // Looks for any of a set of characters using 256-bit vectors. See FindFirstOfSSE2.
+    //
+    size_t FindFirstOfAVX2(const wchar_t* const p_pChars,
+                           const size_t p_Size,
+                           const std::wstring_view p_Chars,
+                           bool& p_rFound) noexcept
+    {
+        size_t i = 0;
+        for (; i + 16 <= p_Size; i += 16) {
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_pChars + i));
+            __m256i matches = _mm256_setzero_si256();
+            for (const wchar_t c : p_Chars) {
+                matches = _mm256_or_si256(matches, _mm256_cmpeq_epi16(block, _mm256_set1_epi16(static_cast<short>(c))));
+            }
+            const int mask = _mm256_movemask_epi8(matches);
+            if (mask != 0) {
+                p_rFound = true;
+                return i + (LowestBitSet(static_cast<unsigned long>(mask)) / 2);
+            }
+        }
+        return i;
+    }
+
+    //
+    // Looks for a character in a class using 256-bit vectors. Characters are
+    // clamped to 0x80 and packed to bytes; the class of each byte is then found
+    // by looking up its low and high nibbles in the class tables. See
+    // FindFirstOfSSE2 for the meaning of the return value.
+    //
+    // @param p_pChars Characters to scan.
+    // @param p_Size Number of characters.
+    // @param p_pLowNibbles Low nibbles table of the class.
+    // @param p_pHighNibbles High nibbles table of the class.
+    // @param p_IncludeNonASCII Whether non-ASCII characters are part of the class.
+    // @param p_rFound Set to true if a character is found.
+    // @return Index of first character found, or number of characters processed.
+    //
+    size_t FindFirstInClassAVX2(const wchar_t* const p_pChars,
+                                const size_t p_Size,
+                                const uint8_t* const p_pLowNibbles,
+                                const uint8_t* const p_pHighNibbles,
+                                const bool p_IncludeNonASCII,
+                                bool& p_rFound) noexcept
+    {
+        const __m256i lowNibbles = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p_pLowNibbles)));
+        const __m256i highNibbles = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p_pHighNibbles)));
+        const __m256i nibbleMask = _mm256_set1_epi8(0x0F);
+        const __m256i nonASCIIChar = _mm256_set1_epi16(0x80);
+        const __m256i nonASCIIByte = _mm256_set1_epi8(static_cast<char>(0x80));
+        size_t i = 0;
+        for (; i + 32 <= p_Size; i += 32) {
+            const __m256i block1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_pChars + i));
+            const __m256i block2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_pChars + i + 16));
+            const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(_mm256_min_epu16(block1, nonASCIIChar),
+                                                                                _mm256_min_epu16(block2, nonASCIIChar)),
+                                                            0xD8);
+            const __m256i low = _mm256_shuffle_epi8(lowNibbles, _mm256_and_si256(packed, nibbleMask));
+            const __m256i high = _mm256_shuffle_epi8(highNibbles, _mm256_and_si256(_mm256_srli_epi16(packed, 4), nibbleMask));
+            unsigned int mask = ~static_cast<unsigned int>(_mm256_movemask_epi8(
+                _mm256_cmpeq_epi8(_mm256_and_si256(low, high), _mm256_setzero_si256())));
+            if (p_IncludeNonASCII) {
+                mask |= static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(packed, nonASCIIByte)));
+            }
+            if (mask != 0) {
+                p_rFound = true;
+                return i + LowestBitSet(mask);
+            }
+        }
+        return i;
+    }
+#endif // STRINGUTILS_USE_SIMD
+
+} // anonymous namespace
+
+std::atomic<StringUtils::SimdLevel> StringUtils::s_MaxSimdLevel(StringUtils::SimdLevel::AVX2);
+
+//
+// Returns the instruction set used by vectorized kernels. This is the best
+// instruction set supported by the processor, detected once on first use,
+// unless limited by a call to SetMaxSimdLevel.
+//
+// @return Instruction set to use for vectorized kernels.
+//
+StringUtils::SimdLevel StringUtils::GetSimdLevel() noexcept
+{
+#ifdef STRINGUTILS_USE_SIMD
+    static const SimdLevel s_DetectedSimdLevel = DetectSimdLevel();
+    return (std::min)(s_DetectedSimdLevel, s_MaxSimdLevel.load(std::memory_order_relaxed));
+#else
+    return SimdLevel::Scalar;
+#endif // STRINGUTILS_USE_SIMD
+}
+
+//
+// Limits the instruction set that can be used by vectorized kernels.
+// Used by tests to compare the results of all kernels with the scalar
+// code on the same processor. Defaults to SimdLevel::AVX2 (no limit).
+//
+// @param p_MaxLevel Best instruction set that can be used.
+//
+void StringUtils::SetMaxSimdLevel(const SimdLevel p_MaxLevel) noexcept
+{
+    s_MaxSimdLevel = p_MaxLevel;
+}
+
+//
+// Constructor.
+//
+// @param p_ASCIIChars ASCII characters that are part of the class.
+//                     Non-ASCII characters in this string are ignored.
+// @param p_IncludeNonASCII Whether all non-ASCII characters are part of the class.
+//
+StringUtils::CharClass::CharClass(const std::wstring_view p_ASCIIChars,
+                                  const bool p_IncludeNonASCII /*= false*/) noexcept
+    : m_LowNibbles(),
+      m_HighNibbles(),
+      m_IncludeNonASCII(p_IncludeNonASCII)
+{
+    for (size_t high = 0; high < 8; ++high) {
+        m_HighNibbles[high] = static_cast<uint8_t>(1 << high);
+    }
+    for (const wchar_t c : p_ASCIIChars) {
+        if (c < 0x80) {
+            m_LowNibbles[c & 0x0F] |= static_cast<uint8_t>(1 << (c >> 4));
+        }
+    }
+}
+
+//
+// Checks if a character is part of the class.
+//
+// @param p_Char Character to check.
+// @return true if character is part of the class.
+//
+bool StringUtils::CharClass::Contains(const wchar_t p_Char) const noexcept
+{
+    if (p_Char >= 0x80) {
+        return m_IncludeNonASCII;
+    }
+    return (m_LowNibbles[p_Char & 0x0F] & m_HighNibbles[p_Char >> 4]) != 0;
+}
+
+//
+// Constructor. Computes the shift table for the given pattern.
+//
+// @param p_Pattern Pattern to look for.
+//
+StringUtils::Searcher::Searcher(std::wstring p_Pattern) noexcept
+    : m_Pattern(std::move(p_Pattern)),
+      m_Shifts()
+{
+    // Characters are bucketed by their low byte; a bucket's shift is the
+    // smallest shift of all its characters, so it is always safe.
+    const size_t patternSize = m_Pattern.size();
+    std::fill(std::begin(m_Shifts), std::end(m_Shifts), patternSize);
+    for (size_t i = 0; i + 1 < patternSize; ++i) {
+        m_Shifts[m_Pattern[i] & 0xFF] = patternSize - 1 - i;
+    }
+}
+
+//
+// Returns the pattern this searcher looks for.
+//
+// @return Searcher pattern.
+//
+const std::wstring& StringUtils::Searcher::Pattern() const noexcept
+{
+    return m_Pattern;
+}
+
+//
+// Finds the first instance of our pattern in a string.
+//
+// @param p_String String to look into.
+// @param p_Pos Position where to start looking in p_String.
+// @return Position of pattern in p_String, or npos if not found.
+//         An empty pattern is found at p_Pos.
+//
+size_t StringUtils::Searcher::Find(const std::wstring_view p_String,
+                                   const size_t p_Pos /*= 0*/) const noexcept
+{
+    const size_t patternSize = m_Pattern.size();
+    if (patternSize <= 1 || p_Pos >= p_String.size()) {
+        // Shift table is useless for such small patterns.
+        return p_String.find(m_Pattern, p_Pos);
+    }
+
+    if (p_String.size() < patternSize) {
+        return std::wstring_view::npos;
+    }
+
+    const wchar_t* const pPattern = m_Pattern.data();
+    const wchar_t lastPatternChar = pPattern[patternSize - 1];
+    const wchar_t* const pString = p_String.data();
+    const size_t lastWindowPos = p_String.size() - patternSize;
+    for (size_t pos = p_Pos; pos <= lastWindowPos; ) {
+        const wchar_t lastChar = pString[pos + patternSize - 1];
+        if (lastChar == lastPatternChar && std::wmemcmp(pString + pos, pPattern, patternSize - 1) == 0) {
+            return pos;
+        }
+        pos += m_Shifts[lastChar & 0xFF];
+    }
+    return std::wstring_view::npos;
+}
+
+
+//
+// Converts a single character to uppercase.
+//
+// @param p_Char Character to convert.
+// @return Uppercase version of character.
+//
+wchar_t StringUtils::ToUppercase(const wchar_t p_Char) noexcept
+{
+    // ASCII characters are converted directly; towupper is only
+    // needed for other characters.
+    if (p_Char < 0x80) {
+        return (p_Char >= L'a' && p_Char <= L'z') ? static_cast<wchar_t>(p_Char - (L'a' - L'A')) : p_Char;
+    }
+    return static_cast<wchar_t>(std::towupper(static_cast<std::wint_t>(p_Char)));
+}
 
 //
 // Converts p_String to uppercase.
@@ -39,10 +539,162 @@ std::wstring StringUtils::ToUppercase(std::wstring p_String)
     std::transform(p_String.begin(),
                    p_String.end(),
                    p_String.begin(),
-                   [](auto c) { return static_cast<wchar_t>(std::towupper(static_cast<std::wint_t>(c))); });
+                   [](const wchar_t c) noexcept {
+                       return ToUppercase(c);
+                   });
     return p_String;
 }
 
+//
+// Sorts strings alphabetically, case-insensitively. Strings that
+// are equal when ignoring case keep their relative order.
+//
+// Uppercase sort keys are computed only once per string, then the
+// strings' indexes are sorted using the keys. Large vectors are
+// sorted in parallel.
+//
+// @param p_rvStrings Strings to sort (in-place).
+//
+void StringUtils::SortCaseInsensitively(PCC::WStringV& p_rvStrings)
+{
+    PCC::WStringV vKeys;
+    vKeys.reserve(p_rvStrings.size());
+    for (const auto& str : p_rvStrings) {
+        vKeys.emplace_back(ToUppercase(str));
+    }
+
+    std::vector<size_t> vIndexes(p_rvStrings.size());
+    std::iota(vIndexes.begin(), vIndexes.end(), 0);
+    const auto keyLess = [&](const size_t p_Index1, const size_t p_Index2) noexcept {
+        return vKeys[p_Index1] < vKeys[p_Index2];
+    };
+    if (vIndexes.size() >= PARALLEL_SORT_THRESHOLD) {
+        std::stable_sort(std::execution::par, vIndexes.begin(), vIndexes.end(), keyLess);
+    } else {
+        std::stable_sort(vIndexes.begin(), vIndexes.end(), keyLess);
+    }
+
+    PCC::WStringV vSorted;
+    vSorted.reserve(p_rvStrings.size());
+    for (const size_t index : vIndexes) {
+        vSorted.emplace_back(std::move(p_rvStrings[index]));
+    }
+    p_rvStrings = std::move(vSorted);
+}
+
+//
+// Replaces all instances of a character in a string with another character.
+// Uses vector instructions if supported by the processor.
+//
+// @param p_rString String to modify (in-place).
+// @param p_OldChar Character to replace.
+// @param p_NewChar Replacement character.
+//
+void StringUtils::ReplaceChar(std::wstring& p_rString,
+                              const wchar_t p_OldChar,
+                              const wchar_t p_NewChar) noexcept
+{
+    size_t i = 0;
+    if (!p_rString.empty()) {
+        wchar_t* const pChars = &*p_rString.begin();
+#ifdef STRINGUTILS_USE_SIMD
+        switch (GetSimdLevel()) {
+            case SimdLevel::AVX2: {
+                i = ReplaceCharAVX2(pChars, p_rString.size(), p_OldChar, p_NewChar);
+                break;
+            }
+            case SimdLevel::SSE2: {
+                i = ReplaceCharSSE2(pChars, p_rString.size(), p_OldChar, p_NewChar);
+                break;
+            }
+            default:
+                break;
+        }
+#endif // STRINGUTILS_USE_SIMD
+        std::replace(pChars + i, pChars + p_rString.size(), p_OldChar, p_NewChar);
+    }
+}
+
+//
+// Looks for the first occurrence of any of the given characters in a string.
+// Equivalent to std::wstring_view::find_first_of, but uses vector instructions
+// if supported by the processor. Meant for small sets of characters; for
+// larger sets, use a CharClass.
+//
+// @param p_String String to scan.
+// @param p_Chars Characters to look for.
+// @param p_Pos Position where to start looking.
+// @return Position of first character found, or std::wstring_view::npos if none found.
+//
+size_t StringUtils::FindFirstOf(const std::wstring_view p_String,
+                                const std::wstring_view p_Chars,
+                                const size_t p_Pos /*= 0*/) noexcept
+{
+    if (p_Pos >= p_String.size() || p_Chars.empty()) {
+        return std::wstring_view::npos;
+    }
+
+    const wchar_t* const pChars = p_String.data() + p_Pos;
+    const size_t size = p_String.size() - p_Pos;
+    size_t i = 0;
+#ifdef STRINGUTILS_USE_SIMD
+    bool found = false;
+    switch (GetSimdLevel()) {
+        case SimdLevel::AVX2: {
+            i = FindFirstOfAVX2(pChars, size, p_Chars, found);
+            break;
+        }
+        case SimdLevel::SSE2: {
+            i = FindFirstOfSSE2(pChars, size, p_Chars, found);
+            break;
+        }
+        default:
+            break;
+    }
+    if (found) {
+        return p_Pos + i;
+    }
+#endif // STRINGUTILS_USE_SIMD
+    return p_String.find_first_of(p_Chars, p_Pos + i);
+}
+
+//
+// Looks for the first character of a string that is part of a character class.
+// Uses vector instructions if supported by the processor.
+//
+// @param p_String String to scan.
+// @param p_CharClass Class of characters to look for.
+// @param p_Pos Position where to start looking.
+// @return Position of first character found, or std::wstring_view::npos if none found.
+//
+size_t StringUtils::FindFirstOf(const std::wstring_view p_String,
+                                const CharClass& p_CharClass,
+                                const size_t p_Pos /*= 0*/) noexcept
+{
+    if (p_Pos >= p_String.size()) {
+        return std::wstring_view::npos;
+    }
+
+    const wchar_t* const pChars = p_String.data() + p_Pos;
+    const size_t size = p_String.size() - p_Pos;
+    size_t i = 0;
+#ifdef STRINGUTILS_USE_SIMD
+    if (GetSimdLevel() == SimdLevel::AVX2) {
+        bool found = false;
+        i = FindFirstInClassAVX2(pChars, size, p_CharClass.m_LowNibbles, p_CharClass.m_HighNibbles,
+                                 p_CharClass.m_IncludeNonASCII, found);
+        if (found) {
+            return p_Pos + i;
+        }
+    }
+#endif // STRINGUTILS_USE_SIMD
+    for (; i < size; ++i) {
+        if (p_CharClass.Contains(pChars[i])) {
+            return p_Pos + i;
+        }
+    }
+    return std::wstring_view::npos;
+}
 
 //
 // Replaces all instance of p_OldValue in p_rString with p_NewValue.
@@ -55,54 +707,89 @@ void StringUtils::ReplaceAll(std::wstring& p_rString,
                              const std::wstring& p_OldValue,
                              const std::wstring& p_NewValue)
 {
-    std::wstring::size_type pos = 0;
-    std::wstring::size_type from = 0;
-    do {
-        // Look for the next instance of the old value.
-        pos = p_rString.find(p_OldValue, from);
-        if (pos != std::wstring::npos) {
-            // Replace this instance with our replacement value.
-            p_rString.replace(pos, p_OldValue.size(), p_NewValue);
+    ReplaceAllMatches(p_rString, p_OldValue.size(), p_NewValue,
+                      [&](const std::wstring_view p_String, const size_t p_Pos) {
+                          return p_String.find(p_OldValue, p_Pos);
+                      });
+}
 
-            // Start looking after the replacement next time.
-            from = pos + p_NewValue.size();
-        }
-    } while (pos != std::wstring::npos);
+//
+// Replaces all instance of a searcher's pattern in p_rString with p_NewValue.
+// Use this version when replacing the same value in many strings.
+//
+// @param p_rString String to modify (in-place).
+// @param p_OldValueSearcher Searcher for the old value to look for.
+// @param p_NewValue Replacement value.
+//
+void StringUtils::ReplaceAll(std::wstring& p_rString,
+                             const Searcher& p_OldValueSearcher,
+                             const std::wstring_view p_NewValue)
+{
+    ReplaceAllMatches(p_rString, p_OldValueSearcher.Pattern().size(), p_NewValue,
+                      [&](const std::wstring_view p_String, const size_t p_Pos) {
+                          return p_OldValueSearcher.Find(p_String, p_Pos);
+                      });
 }
 
 //
 // Splits the given string using the given separators into parts.
+// Empty parts are skipped.
 //
 // @param p_String String to split.
 // @param p_Separators Separators to use for splitting.
 // @return String parts.
 //
-PCC::WStringV StringUtils::Split(std::wstring p_String,
-                                 const std::wstring& p_Separators)
+PCC::WStringV StringUtils::Split(const std::wstring_view p_String,
+                                 const std::wstring_view p_Separators)
 {
     PCC::WStringV vParts;
-    if (!p_String.empty()) {
-        wchar_t* context = nullptr;
-        wchar_t* pCurToken = ::wcstok_s(&*p_String.begin(), p_Separators.c_str(), &context);
-        while (pCurToken != nullptr) {
-            vParts.emplace_back(pCurToken);
-            pCurToken = ::wcstok_s(nullptr, p_Separators.c_str(), &context);
-        }
+    for (const std::wstring_view part : SplitView(p_String, p_Separators)) {
+        vParts.emplace_back(part);
     }
     return vParts;
 }
 
 //
 // Splits the given string using the given separator into parts.
+// Empty parts are skipped.
 //
 // @param p_String String to split.
 // @param p_Separator Separator to use for splitting.
 // @return String parts.
 //
-PCC::WStringV StringUtils::Split(std::wstring p_String,
+PCC::WStringV StringUtils::Split(const std::wstring_view p_String,
                                  const wchar_t p_Separator)
 {
-    return Split(std::move(p_String), std::wstring(1, p_Separator));
+    return Split(p_String, std::wstring_view(&p_Separator, 1));
+}
+
+//
+// Returns a lazy range of the parts of a string split using separators.
+// Empty parts are skipped. The string must outlive the returned range.
+//
+// @param p_String String to split.
+// @param p_Separators Separators to use for splitting.
+// @return Range of string parts, as views on p_String.
+//
+StringUtils::SplitRange<std::wstring_view> StringUtils::SplitView(const std::wstring_view p_String,
+                                                                  const std::wstring_view p_Separators) noexcept
+{
+    return SplitRange<std::wstring_view>(p_String, p_Separators);
+}
+
+//
+// Returns a lazy range of the parts of a string split using separators,
+// along with the separators found before each part. Empty parts are skipped.
+// The string must outlive the returned range.
+//
+// @param p_String String to split.
+// @param p_Separators Separators to use for splitting.
+// @return Range of SplitPart values, as views on p_String.
+//
+StringUtils::SplitRange<StringUtils::SplitPart> StringUtils::SplitParts(const std::wstring_view p_String,
+                                                                        const std::wstring_view p_Separators) noexcept
+{
+    return SplitRange<SplitPart>(p_String, p_Separators);
 }
 
 //
@@ -125,41 +812,85 @@ void StringUtils::EncodeURICharacters(std::wstring& p_rString,
     //
     // https://pathcopycopy.codeplex.com/workitem/11374
 
-    if (p_EncodeParam != EncodeParam::None) {
-        // Choose function to identify characters to encode.
-        std::function<bool(wchar_t)> identifyFunc;
-        switch (p_EncodeParam) {
-            case EncodeParam::Whitespace: {
-                identifyFunc = [](const wchar_t p_Char) {
-                    const unsigned int val = static_cast<unsigned int>(p_Char);
-                    return val <= 0x1F || val == 0x20 || val == 0x7F;
-                };
-                break;
-            }
-            case EncodeParam::All: {
-                identifyFunc = [](const wchar_t p_Char) {
-                    const unsigned int val = static_cast<unsigned int>(p_Char);
-                    return val <= 0x1F || val == 0x20 || val == 0x7F || p_Char == L'<' || p_Char == L'>' ||
-                        p_Char == L'#' || p_Char == L'%' || p_Char == L'"' || p_Char == L'{' ||
-                        p_Char == L'}' || p_Char == L'|' || p_Char == L'\\' || p_Char == L'^' ||
-                        p_Char == L'[' || p_Char == L']' || p_Char == L'`' || p_Char == L'+';
-                };
-                break;
-            }
-            default:
-                assert(false);
+    //
+    // RFC3986 mode follows RFC 3986 instead: all characters that are not allowed
+    // in an URI path are encoded, and non-ASCII characters are first converted
+    // to UTF-8 so that each byte is encoded (e.g. %C3%A9 for U+00E9).
+
+    if (p_EncodeParam == EncodeParam::None) {
+        return;
+    }
+
+    // Choose class of characters to encode.
+    static const CharClass s_WhitespaceChars(GetControlChars() + L" ");
+    static const CharClass s_AllChars(GetControlChars() + L" <>#%\"{}|\\^[]`+");
+    static const CharClass s_RFC3986Chars(GetControlChars() + L" \"#%<>?[\\]^`{|}", true);
+    const CharClass* pCharsToEncode = nullptr;
+    switch (p_EncodeParam) {
+        case EncodeParam::Whitespace: {
+            pCharsToEncode = &s_WhitespaceChars;
+            break;
+        }
+        case EncodeParam::All: {
+            pCharsToEncode = &s_AllChars;
+            break;
         }
+        case EncodeParam::RFC3986: {
+            pCharsToEncode = &s_RFC3986Chars;
+            break;
+        }
+        default:
+            assert(false);
+            return;
+    }
+    const CharClass& charsToEncode = *pCharsToEncode;
+    const bool utf8 = p_EncodeParam == EncodeParam::RFC3986;
+
+    // Look for the first character to encode; if there is none, we're done.
+    const size_t firstPos = FindFirstOf(p_rString, charsToEncode);
+    if (firstPos == std::wstring::npos) {
+        return;
+    }
+
+    // Compute size of encoded string so that it is allocated only once.
+    // In modes other than RFC3986, only ASCII characters can be encoded.
+    size_t encodedSize = firstPos;
+    for (size_t i = firstPos; i < p_rString.size(); ++i) {
+        if (charsToEncode.Contains(p_rString[i])) {
+            encodedSize += 3 * (utf8 ? UTF8Size(p_rString, i) : 1);
+        } else {
+            ++encodedSize;
+        }
+    }
 
-        std::wstringstream wss;
-        wss << std::hex;
-        for (std::wstring::const_iterator it = p_rString.cbegin(); it != p_rString.cend(); ++it) {
-            const wchar_t curChar = *it;
-            if (identifyFunc(curChar)) {
-                wss << L"%" << static_cast<unsigned int>(curChar);
-            } else {
-                wss << curChar;
+    // Copy characters that do not need encoding and encode the others.
+    // RFC 3986 recommends using uppercase hex digits; other modes use
+    // lowercase digits, like previous versions did.
+    const wchar_t* const hexDigits = utf8 ? L"0123456789ABCDEF" : L"0123456789abcdef";
+    const auto appendEncodedByte = [&](std::wstring& p_rEncoded, const uint8_t p_Byte) {
+        p_rEncoded.push_back(L'%');
+        p_rEncoded.push_back(hexDigits[p_Byte >> 4]);
+        p_rEncoded.push_back(hexDigits[p_Byte & 0x0F]);
+    };
+    std::wstring encoded;
+    encoded.reserve(encodedSize);
+    size_t from = 0;
+    size_t pos = firstPos;
+    while (pos != std::wstring::npos) {
+        encoded.append(p_rString, from, pos - from);
+        if (utf8) {
+            uint8_t bytes[4] = { 0 };
+            const size_t numBytes = ToUTF8(p_rString, pos, bytes);
+            for (size_t i = 0; i < numBytes; ++i) {
+                appendEncodedByte(encoded, bytes[i]);
             }
+        } else {
+            appendEncodedByte(encoded, static_cast<uint8_t>(p_rString[pos]));
         }
-        p_rString = wss.str();
+        from = pos + 1;
+        pos = FindFirstOf(p_rString, charsToEncode, from);
     }
+    encoded.append(p_rString, from, std::wstring::npos);
+    assert(encoded.size() == encodedSize);
+    p_rString = std::move(encoded);
 }
@@ -0,0 +1,122 @@
+// Win32FileSystem.cpp
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdafx.h>
+#include <Win32FileSystem.h>
+#include <StHandle.h>
+
+
+namespace PCC
+{
+    //
+    // Returns the attributes of a file or folder.
+    //
+    // @param p_Path Path of file or folder.
+    // @return Attributes of file or folder, or INVALID_FILE_ATTRIBUTES.
+    //
+    DWORD Win32FileSystem::GetAttributes(const std::wstring& p_Path) const
+    {
+        return ::GetFileAttributesW(p_Path.c_str());
+    }
+
+    //
+    // Returns the final path of a file or folder, once all symlinks
+    // in the path have been followed.
+    //
+    // @param p_Path Path of file or folder.
+    // @param p_rFinalPath Where to store the final path.
+    // @return true if the final path could be determined.
+    //
+    bool Win32FileSystem::GetFinalPath(const std::wstring& p_Path,
+                                       std::wstring& p_rFinalPath) const
+    {
+        bool found = false;
+
+        // In order to get the final path, we need a handle.
+        DWORD flagsAndAttributes = FILE_ATTRIBUTE_NORMAL;
+        if ((GetAttributes(p_Path) & FILE_ATTRIBUTE_DIRECTORY) != 0) {
+            // Need this flag to open directory handles according to MSDN
+            flagsAndAttributes |= FILE_FLAG_BACKUP_SEMANTICS;
+        }
+        StHandle hFile = ::CreateFileW(p_Path.c_str(),
+                                       GENERIC_READ,
+                                       FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                       nullptr,
+                                       OPEN_EXISTING,
+                                       flagsAndAttributes,
+                                       nullptr);
+        if (hFile != nullptr) {
+            const auto bufferSize = ::GetFinalPathNameByHandleW(hFile, nullptr, 0, FILE_NAME_NORMALIZED | VOLUME_NAME_DOS);
+            if (bufferSize != 0) {
+                std::wstring finalPath(bufferSize + 1, L'\0');
+                const auto finalPathRes = ::GetFinalPathNameByHandleW(hFile,
+                                                                      &*finalPath.begin(),
+                                                                      bufferSize + 1,
+                                                                      FILE_NAME_NORMALIZED | VOLUME_NAME_DOS);
+                if (finalPathRes != 0) {
+                    p_rFinalPath = finalPath.c_str();
+                    found = true;
+                }
+            }
+        }
+
+        return found;
+    }
+
+    //
+    // Lists the names of the files and folders contained in a folder.
+    //
+    // @param p_FolderPath Path of folder.
+    // @param p_rvNames Where to add the names of the folder's content.
+    //
+    void Win32FileSystem::EnumerateFolder(const std::wstring& p_FolderPath,
+                                          std::vector<std::wstring>& p_rvNames) const
+    {
+        WIN32_FIND_DATAW findData;
+        HANDLE hFind = ::FindFirstFileW((p_FolderPath + L"\\*").c_str(), &findData);
+        if (hFind != INVALID_HANDLE_VALUE) {
+            try {
+                do {
+                    const std::wstring fileName = findData.cFileName;
+                    if (fileName != L"." && fileName != L"..") {
+                        p_rvNames.emplace_back(fileName);
+                    }
+                } while (::FindNextFileW(hFind, &findData));
+                ::FindClose(hFind);
+            } catch (...) {
+                ::FindClose(hFind);
+                throw;
+            }
+        }
+    }
+
+    //
+    // Returns the instance of the Win32 file system used by default.
+    //
+    // @return Win32 file system instance.
+    //
+    Win32FileSystem& Win32FileSystem::Instance() noexcept
+    {
+        static Win32FileSystem s_Instance;
+        return s_Instance;
+    }
+
+} // namespace PCC
@@ -1471,6 +1471,248 @@ namespace PathCopyCopy.Settings.Core.Plugins
         }
     }
     
+    /// <summary>
+    /// Pipeline element that performs multiple find & replace operations
+    /// in the path in a single pass.
+    /// </summary>
+    /// <remarks>
+    /// The path is scanned from left to right. When values to find overlap,
+    /// the one that starts first is replaced; if many start at the same
+    /// position, the longest one is replaced. Replacement values are never
+    /// scanned again.
+    /// </remarks>
+    public class MultiFindReplacePipelineElement : PipelineElement
+    {
+        /// <summary>
+        /// Version number used to identify encoded data.
+        /// </summary>
+        public const int InitialVersion = 1;
+
+        /// <summary>
+        /// Maximum data version understood by this code.
+        /// </summary>
+        public const int MaxVersion = InitialVersion;
+
+        /// <summary>
+        /// Code representing this pipeline element type.
+        /// </summary>
+        public const char CODE = '*';
+
+        /// <summary>
+        /// Code representing this pipeline element type.
+        /// </summary>
+        public override char Code
+        {
+            get {
+                return CODE;
+            }
+        }
+
+        /// <summary>
+        /// Pipeline element display value for the UI.
+        /// </summary>
+        public override string DisplayValue
+        {
+            get {
+                return Resources.PipelineElement_MultiFindReplace;
+            }
+        }
+
+        /// <summary>
+        /// Minimum version of Path Copy Copy required to use this pipeline element.
+        /// </summary>
+        public override Version RequiredVersion
+        {
+            get {
+                return new Version(21, 0, 0, 0);
+            }
+        }
+
+        /// <summary>
+        /// Pairs of values to look for in the path (keys) and
+        /// their replacement values (values).
+        /// </summary>
+        public List<KeyValuePair<string, string>> FindReplacePairs
+        {
+            get;
+        } = new List<KeyValuePair<string, string>>();
+        
+        /// <summary>
+        /// Default constructor.
+        /// </summary>
+        public MultiFindReplacePipelineElement()
+        {
+        }
+        
+        /// <summary>
+        /// Constructor with find/replace pairs.
+        /// </summary>
+        /// <param name="findReplacePairs">Pairs of values to look for
+        /// and their replacement values.</param>
+        public MultiFindReplacePipelineElement(IEnumerable<KeyValuePair<string, string>> findReplacePairs)
+        {
+            if (findReplacePairs == null) {
+                throw new ArgumentNullException(nameof(findReplacePairs));
+            }
+
+            FindReplacePairs.AddRange(findReplacePairs);
+        }
+        
+        /// <summary>
+        /// Encodes this pipeline element in a string.
+        /// </summary>
+        /// <returns>Encoded element data.</returns>
+        public override string Encode()
+        {
+            // First write currently-used version number.
+            StringBuilder encoder = new StringBuilder();
+            encoder.Append(EncodeInt(InitialVersion));
+
+            // Now encode number of pairs, followed by each old and new value.
+            encoder.Append(EncodeInt(FindReplacePairs.Count));
+            foreach (KeyValuePair<string, string> pair in FindReplacePairs) {
+                encoder.Append(EncodeString(pair.Key));
+                encoder.Append(EncodeString(pair.Value));
+            }
+
+            return encoder.ToString();
+        }
+    }
+    
+    /// <summary>
+    /// Pipeline element that rewrites the beginning of the path using
+    /// a table of prefixes and their replacement values.
+    /// </summary>
+    /// <remarks>
+    /// Only the longest prefix matching the path is replaced. Prefixes are
+    /// compared case-insensitively. The table can either be stored in the
+    /// element itself or in a separate UTF-8 file, with one tab-separated
+    /// prefix and replacement value per line.
+    /// </remarks>
+    public class PrefixMapPipelineElement : PipelineElement
+    {
+        /// <summary>
+        /// Version number used to identify encoded data.
+        /// </summary>
+        public const int InitialVersion = 1;
+
+        /// <summary>
+        /// Maximum data version understood by this code.
+        /// </summary>
+        public const int MaxVersion = InitialVersion;
+
+        /// <summary>
+        /// Code representing this pipeline element type.
+        /// </summary>
+        public const char CODE = 'p';
+
+        /// <summary>
+        /// Code representing this pipeline element type.
+        /// </summary>
+        public override char Code
+        {
+            get {
+                return CODE;
+            }
+        }
+
+        /// <summary>
+        /// Pipeline element display value for the UI.
+        /// </summary>
+        public override string DisplayValue
+        {
+            get {
+                return Resources.PipelineElement_PrefixMap;
+            }
+        }
+
+        /// <summary>
+        /// Minimum version of Path Copy Copy required to use this pipeline element.
+        /// </summary>
+        public override Version RequiredVersion
+        {
+            get {
+                return new Version(21, 0, 0, 0);
+            }
+        }
+
+        /// <summary>
+        /// Path of the file containing the table. If <c>null</c>, the
+        /// table is stored in <see cref="PrefixReplacementPairs"/>.
+        /// </summary>
+        public string TableFilePath
+        {
+            get;
+            set;
+        }
+
+        /// <summary>
+        /// Pairs of prefixes (keys) and their replacement values (values).
+        /// Only used if <see cref="TableFilePath"/> is <c>null</c>.
+        /// </summary>
+        public List<KeyValuePair<string, string>> PrefixReplacementPairs
+        {
+            get;
+        } = new List<KeyValuePair<string, string>>();
+        
+        /// <summary>
+        /// Default constructor.
+        /// </summary>
+        public PrefixMapPipelineElement()
+        {
+        }
+        
+        /// <summary>
+        /// Constructor with a table stored in a file.
+        /// </summary>
+        /// <param name="tableFilePath">Path of the file containing the table.</param>
+        public PrefixMapPipelineElement(string tableFilePath)
+        {
+            TableFilePath = tableFilePath ?? throw new ArgumentNullException(nameof(tableFilePath));
+        }
+        
+        /// <summary>
+        /// Constructor with a table stored in the element.
+        /// </summary>
+        /// <param name="prefixReplacementPairs">Pairs of prefixes and their
+        /// replacement values.</param>
+        public PrefixMapPipelineElement(IEnumerable<KeyValuePair<string, string>> prefixReplacementPairs)
+        {
+            if (prefixReplacementPairs == null) {
+                throw new ArgumentNullException(nameof(prefixReplacementPairs));
+            }
+
+            PrefixReplacementPairs.AddRange(prefixReplacementPairs);
+        }
+        
+        /// <summary>
+        /// Encodes this pipeline element in a string.
+        /// </summary>
+        /// <returns>Encoded element data.</returns>
+        public override string Encode()
+        {
+            // First write currently-used version number.
+            StringBuilder encoder = new StringBuilder();
+            encoder.Append(EncodeInt(InitialVersion));
+
+            // Now encode a flag telling whether table is stored in a file.
+            // If so, encode the file path; otherwise, encode number of
+            // entries followed by each prefix and replacement value.
+            encoder.Append(EncodeBool(TableFilePath != null));
+            if (TableFilePath != null) {
+                encoder.Append(EncodeString(TableFilePath));
+            } else {
+                encoder.Append(EncodeInt(PrefixReplacementPairs.Count));
+                foreach (KeyValuePair<string, string> pair in PrefixReplacementPairs) {
+                    encoder.Append(EncodeString(pair.Key));
+                    encoder.Append(EncodeString(pair.Value));
+                }
+            }
+
+            return encoder.ToString();
+        }
+    }
+    
     /// <summary>
     /// Pipeline element that performs find/replace operations using regex.
     /// </summary>
@@ -1811,6 +2053,59 @@ namespace PathCopyCopy.Settings.Core.Plugins
             return new CopyNPathPartsPipelineElementUserControl(this);
         }
     }
+    
+    /// <summary>
+    /// Pipeline element that normalizes the path by removing "." parts,
+    /// resolving ".." parts and removing duplicate and trailing separators.
+    /// The root of the path (drive, UNC server and share, etc.) is kept as-is.
+    /// </summary>
+    public class NormalizePathPipelineElement : PipelineElement
+    {
+        /// <summary>
+        /// Code representing this pipeline element type.
+        /// </summary>
+        public const char CODE = '=';
+
+        /// <summary>
+        /// Code representing this pipeline element type.
+        /// </summary>
+        public override char Code
+        {
+            get {
+                return CODE;
+            }
+        }
+
+        /// <summary>
+        /// Pipeline element display value for the UI.
+        /// </summary>
+        public override string DisplayValue
+        {
+            get {
+                return Resources.PipelineElement_NormalizePath;
+            }
+        }
+
+        /// <summary>
+        /// Minimum version of Path Copy Copy required to use this pipeline element.
+        /// </summary>
+        public override Version RequiredVersion
+        {
+            get {
+                return new Version(21, 0, 0, 0);
+            }
+        }
+
+        /// <summary>
+        /// Encodes this pipeline element in a string.
+        /// </summary>
+        /// <returns>Encoded element data.</returns>
+        public override string Encode()
+        {
+            // No other data to encode.
+            return string.Empty;
+        }
+    }
 
     /// <summary>
     /// Base class for pipeline elements that store a plugin ID.
@@ -3102,6 +3397,14 @@ namespace PathCopyCopy.Settings.Core.Plugins
                     element = DecodeFindReplaceElement(encodedElements, ref curChar);
                     break;
                 }
+                case MultiFindReplacePipelineElement.CODE: {
+                    element = DecodeMultiFindReplaceElement(encodedElements, ref curChar);
+                    break;
+                }
+                case PrefixMapPipelineElement.CODE: {
+                    element = DecodePrefixMapElement(encodedElements, ref curChar);
+                    break;
+                }
                 case RegexPipelineElement.CODE: {
                     element = DecodeRegexPipelineElement(encodedElements, ref curChar);
                     break;
@@ -3118,6 +3421,10 @@ namespace PathCopyCopy.Settings.Core.Plugins
                     element = DecodeCopyNPathPartsPipelineElement(encodedElements, ref curChar);
                     break;
                 }
+                case NormalizePathPipelineElement.CODE: {
+                    element = new NormalizePathPipelineElement();
+                    break;
+                }
                 case ApplyPluginPipelineElement.CODE:
                 case ApplyPipelinePluginPipelineElement.CODE: {
                     element = DecodeApplyPluginElement(elementCode, encodedElements, ref curChar);
@@ -3186,6 +3493,77 @@ namespace PathCopyCopy.Settings.Core.Plugins
             return new FindReplacePipelineElement(oldValue, newValue);
         }
         
+        /// <summary>
+        /// Decodes a <see cref="MultiFindReplacePipelineElement"/> from an
+        /// encoded element string.
+        /// </summary>
+        /// <param name="encodedElements">String of encoded elements data.</param>
+        /// <param name="curChar">Position where the element data is to be found
+        /// in the string (not counting the element code). Upon return, this will
+        /// point just after the element data.</param>
+        private static MultiFindReplacePipelineElement DecodeMultiFindReplaceElement(string encodedElements,
+            ref int curChar)
+        {
+            // First read version number and validate.
+            int version = DecodeInt(encodedElements, ref curChar);
+            if (version > MultiFindReplacePipelineElement.MaxVersion) {
+                throw new InvalidPipelineException();
+            }
+
+            // Read initial version data: number of pairs, followed by each old and new value.
+            int numPairs = DecodeInt(encodedElements, ref curChar);
+            if (numPairs < 0) {
+                throw new InvalidPipelineException();
+            }
+            List<KeyValuePair<string, string>> findReplacePairs = new List<KeyValuePair<string, string>>();
+            for (int i = 0; i < numPairs; ++i) {
+                string oldValue = DecodeString(encodedElements, ref curChar);
+                string newValue = DecodeString(encodedElements, ref curChar);
+                findReplacePairs.Add(new KeyValuePair<string, string>(oldValue, newValue));
+            }
+
+            // Create and return element object.
+            return new MultiFindReplacePipelineElement(findReplacePairs);
+        }
+        
+        /// <summary>
+        /// Decodes a <see cref="PrefixMapPipelineElement"/> from an encoded
+        /// element string.
+        /// </summary>
+        /// <param name="encodedElements">String of encoded elements data.</param>
+        /// <param name="curChar">Position where the element data is to be found
+        /// in the string (not counting the element code). Upon return, this will
+        /// point just after the element data.</param>
+        private static PrefixMapPipelineElement DecodePrefixMapElement(string encodedElements,
+            ref int curChar)
+        {
+            // First read version number and validate.
+            int version = DecodeInt(encodedElements, ref curChar);
+            if (version > PrefixMapPipelineElement.MaxVersion) {
+                throw new InvalidPipelineException();
+            }
+
+            // Read initial version data: a flag telling whether table is stored
+            // in a file. If so, the file path follows; otherwise, the number of
+            // entries follows, then each prefix and replacement value.
+            bool fromFile = DecodeBool(encodedElements, ref curChar);
+            if (fromFile) {
+                string tableFilePath = DecodeString(encodedElements, ref curChar);
+                return new PrefixMapPipelineElement(tableFilePath);
+            }
+            int numEntries = DecodeInt(encodedElements, ref curChar);
+            if (numEntries < 0) {
+                throw new InvalidPipelineException();
+            }
+            List<KeyValuePair<string, string>> prefixReplacementPairs = new List<KeyValuePair<string, string>>();
+            for (int i = 0; i < numEntries; ++i) {
+                string prefix = DecodeString(encodedElements, ref curChar);
+                string replacement = DecodeString(encodedElements, ref curChar);
+                prefixReplacementPairs.Add(new KeyValuePair<string, string>(prefix, replacement));
+            }
+            return new PrefixMapPipelineElement(prefixReplacementPairs);
+        }
+        
         /// <summary>
         /// Decodes a <see cref="RegexPipelineElement"/> from an encoded element
         /// string.
@@ -123,6 +123,9 @@ namespace PathCopyCopy.Settings.Core
         /// Name of registry value specifying whether to copy paths to the .lnk files themselves.
         private const string TrueLnkPathsValueName = "TrueLnkPaths";
 
+        /// Name of registry value specifying whether to copy paths in the order files were selected.
+        private const string PreserveSelectionOrderValueName = "PreserveSelectionOrder";
+
         /// Name of registry value containing the ID of the plugin to activate when Ctrl key is held down.
         private const string CtrlKeyPluginValueName = "CtrlKeyPlugin";
 
@@ -248,6 +251,9 @@ namespace PathCopyCopy.Settings.Core
         /// Default value of the "true .lnk paths" setting.
         private const int TrueLnkPathsDefaultValue = 0;
 
+        /// Default value of the "preserve selection order" setting.
+        private const int PreserveSelectionOrderDefaultValue = 0;
+
         /// Default value of the "disable software update" setting.
         private const int DisableSoftwareUpdateDefaultValue = 0;
 
@@ -513,6 +519,20 @@ namespace PathCopyCopy.Settings.Core
             }
         }
 
+        /// <summary>
+        /// Whether to copy paths in the order in which files were selected
+        /// instead of sorting them alphabetically.
+        /// </summary>
+        public bool PreserveSelectionOrder
+        {
+            get {
+                return ((int) GetUserOrGlobalValue(PreserveSelectionOrderValueName, PreserveSelectionOrderDefaultValue)) != 0;
+            }
+            set {
+                userKey.SetValue(PreserveSelectionOrderValueName, value ? 1 : 0);
+            }
+        }
+
         /// <summary>
         /// Whether software updates are disabled.
         /// </summary>
@@ -829,6 +829,33 @@ namespace PathCopyCopy.Settings.Properties {
             }
         }
         
+        /// <summary>
+        ///   Looks up a localized string similar to Multiple Find / Replace.
+        /// </summary>
+        internal static string PipelineElement_MultiFindReplace {
+            get {
+                return ResourceManager.GetString("PipelineElement_MultiFindReplace", resourceCulture);
+            }
+        }
+        
+        /// <summary>
+        ///   Looks up a localized string similar to Normalize Path.
+        /// </summary>
+        internal static string PipelineElement_NormalizePath {
+            get {
+                return ResourceManager.GetString("PipelineElement_NormalizePath", resourceCulture);
+            }
+        }
+        
+        /// <summary>
+        ///   Looks up a localized string similar to Remove "." parts, resolve ".." parts and remove duplicate and trailing separators in the path.
+        /// </summary>
+        internal static string PipelineElement_NormalizePath_HelpText {
+            get {
+                return ResourceManager.GetString("PipelineElement_NormalizePath_HelpText", resourceCulture);
+            }
+        }
+        
         /// <summary>
         ///   Looks up a localized string similar to Add Quotes If Needed.
         /// </summary>
@@ -883,6 +910,15 @@ namespace PathCopyCopy.Settings.Properties {
             }
         }
         
+        /// <summary>
+        ///   Looks up a localized string similar to Replace Path Prefix Using Table.
+        /// </summary>
+        internal static string PipelineElement_PrefixMap {
+            get {
+                return ResourceManager.GetString("PipelineElement_PrefixMap", resourceCulture);
+            }
+        }
+        
         /// <summary>
         ///   Looks up a localized string similar to Push Value to Stack.
         /// </summary>
@@ -176,6 +176,9 @@ namespace PathCopyCopy.Settings.UI.Forms
             AddNewElementMenuItem(Resources.PipelineElement_CopyNPathParts,
                 Resources.PipelineElement_CopyNPathParts_HelpText,
                 () => new CopyNPathPartsPipelineElement());
+            AddNewElementMenuItem(Resources.PipelineElement_NormalizePath,
+                Resources.PipelineElement_NormalizePath_HelpText,
+                () => new NormalizePathPipelineElement());
             AddNewElementMenuItem("-", null, null);
             AddNewElementMenuItem(Resources.PipelineElement_FollowSymlink,
                 Resources.PipelineElement_FollowSymlink_HelpText,
@@ -60,6 +60,7 @@
             this.PluginsDataGridBindingSource = new System.Windows.Forms.BindingSource(this.components);
             this.PluginsExplanationLbl = new System.Windows.Forms.Label();
             this.MiscOptionsPage = new System.Windows.Forms.TabPage();
+            this.PreserveSelectionOrderChk = new System.Windows.Forms.CheckBox();
             this.RecursiveCopyChk = new System.Windows.Forms.CheckBox();
             this.LanguageCombo = new System.Windows.Forms.ComboBox();
             this.LanguageComboBindingSource = new System.Windows.Forms.BindingSource(this.components);
@@ -339,6 +340,7 @@
             // MiscOptionsPage
             // 
             resources.ApplyResources(this.MiscOptionsPage, "MiscOptionsPage");
+            this.MiscOptionsPage.Controls.Add(this.PreserveSelectionOrderChk);
             this.MiscOptionsPage.Controls.Add(this.RecursiveCopyChk);
             this.MiscOptionsPage.Controls.Add(this.LanguageCombo);
             this.MiscOptionsPage.Controls.Add(this.LanguageLbl);
@@ -364,6 +366,13 @@
             this.MainToolTip.SetToolTip(this.MiscOptionsPage, resources.GetString("MiscOptionsPage.ToolTip"));
             this.MiscOptionsPage.UseVisualStyleBackColor = true;
             // 
+            // PreserveSelectionOrderChk
+            // 
+            resources.ApplyResources(this.PreserveSelectionOrderChk, "PreserveSelectionOrderChk");
+            this.PreserveSelectionOrderChk.Name = "PreserveSelectionOrderChk";
+            this.MainToolTip.SetToolTip(this.PreserveSelectionOrderChk, resources.GetString("PreserveSelectionOrderChk.ToolTip"));
+            this.PreserveSelectionOrderChk.UseVisualStyleBackColor = true;
+            // 
             // RecursiveCopyChk
             // 
             resources.ApplyResources(this.RecursiveCopyChk, "RecursiveCopyChk");
@@ -722,6 +731,7 @@
         private System.Windows.Forms.Label LanguageLbl;
         private System.Windows.Forms.BindingSource LanguageComboBindingSource;
         private System.Windows.Forms.CheckBox RecursiveCopyChk;
+        private System.Windows.Forms.CheckBox PreserveSelectionOrderChk;
     }
 }
 
@@ -268,6 +268,7 @@ namespace PathCopyCopy.Settings.UI.Forms
             DropRedundantWordsChk.Checked = Settings.DropRedundantWords;
             RecursiveCopyChk.Checked = Settings.CopyPathsRecursively;
             TrueLnkPathsChk.Checked = Settings.TrueLnkPaths;
+            PreserveSelectionOrderChk.Checked = Settings.PreserveSelectionOrder;
             EnableSoftwareUpdateChk.Checked = !Settings.DisableSoftwareUpdate;
 
             // Set binding list as data source for the combo box used to pick ctrl key plugin.
@@ -469,6 +470,9 @@ namespace PathCopyCopy.Settings.UI.Forms
             if (TrueLnkPathsChk.Checked != Settings.TrueLnkPaths) {
                 Settings.TrueLnkPaths = TrueLnkPathsChk.Checked;
             }
+            if (PreserveSelectionOrderChk.Checked != Settings.PreserveSelectionOrder) {
+                Settings.PreserveSelectionOrder = PreserveSelectionOrderChk.Checked;
+            }
             if (EnableSoftwareUpdateChk.Checked != (!Settings.DisableSoftwareUpdate)) {
                 Settings.DisableSoftwareUpdate = !EnableSoftwareUpdateChk.Checked;
             }
@@ -0,0 +1,95 @@
+// FakeFileSystem.h
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include "FileSystem.h"
+
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace PCC
+{
+    //
+    // FakeFileSystem
+    //
+    // File system implementation that keeps its files and folders in memory.
+    // Can be installed as the current file system (see StCurrentFileSystem)
+    // in order to run plugins and pipelines on paths that do not exist,
+    // for example to test or benchmark them without touching the disk.
+    //
+    // Like on Windows, paths are case-insensitive, both '\' and '/'
+    // can be used as separators and symlinks in a path's parents are
+    // followed when looking at the path. Adding a file or folder also
+    // adds its missing parent folders.
+    //
+    class FakeFileSystem final : public FileSystem
+    {
+    public:
+                        FakeFileSystem() = default;
+
+        void            AddFile(const std::wstring& p_Path,
+                                DWORD p_Attributes = FILE_ATTRIBUTE_NORMAL);
+        void            AddFolder(const std::wstring& p_Path,
+                                  DWORD p_Attributes = FILE_ATTRIBUTE_DIRECTORY);
+        void            AddSymlink(const std::wstring& p_Path,
+                                   const std::wstring& p_TargetPath,
+                                   bool p_ToFolder);
+        void            Clear() noexcept;
+
+        size_t          GetNumAttributeQueries() const noexcept;
+
+        virtual DWORD   GetAttributes(const std::wstring& p_Path) const override;
+        virtual bool    GetFinalPath(const std::wstring& p_Path,
+                                     std::wstring& p_rFinalPath) const override;
+        virtual void    EnumerateFolder(const std::wstring& p_FolderPath,
+                                        std::vector<std::wstring>& p_rvNames) const override;
+
+    private:
+        // Info about a file or folder in the fake file system.
+        struct Entry {
+            std::wstring    m_Name;                 // Name of file or folder, as it was added.
+            DWORD           m_Attributes = 0;       // File attributes.
+            std::wstring    m_TargetPath;           // For symlinks, path of target.
+        };
+        typedef std::map<std::wstring, Entry> EntryM;
+
+        EntryM          m_mEntries;                     // Files and folders, by normalized path.
+        mutable size_t  m_NumAttributeQueries = 0;      // Number of calls to GetAttributes.
+
+        void            AddEntry(const std::wstring& p_Path,
+                                 DWORD p_Attributes,
+                                 const std::wstring& p_TargetPath);
+        bool            ResolvePath(const std::wstring& p_Path,
+                                    bool p_FollowLast,
+                                    std::wstring& p_rResolvedPath) const;
+        const Entry*    FindEntry(const std::wstring& p_Path) const;
+
+        static std::wstring
+                        GetName(std::wstring_view p_Path);
+        static std::wstring
+                        NormalizePath(std::wstring_view p_Path);
+    };
+
+} // namespace PCC
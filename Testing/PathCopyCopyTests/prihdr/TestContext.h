@@ -0,0 +1,99 @@
+// TestContext.h
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+
+namespace PCC
+{
+    namespace Tests
+    {
+        //
+        // TestContext
+        //
+        // Object passed to tests and benchmarks run by TestRunner. Tests use
+        // it to perform checks; a failed check is recorded and reported but
+        // does not stop the test. Benchmarks use it to measure code and
+        // record its throughput.
+        //
+        class TestContext final
+        {
+        public:
+            explicit        TestContext(std::wstring_view p_Name);
+                            TestContext(const TestContext&) = delete;
+            TestContext&    operator=(const TestContext&) = delete;
+
+            bool            Check(bool p_Condition,
+                                  std::wstring_view p_What);
+            template<typename T, typename U>
+            bool            CheckEqual(const T& p_Expected,
+                                       const U& p_Actual,
+                                       std::wstring_view p_What);
+
+            void            Measure(std::wstring_view p_Case,
+                                    size_t p_ItemsPerRun,
+                                    const std::function<void()>& p_Run);
+
+            size_t          GetNumChecks() const noexcept;
+            size_t          GetNumFailures() const noexcept;
+            const std::wstring&
+                            GetOutput() const noexcept;
+
+        private:
+            const std::wstring
+                            m_Name;                 // Name of test or benchmark.
+            size_t          m_NumChecks = 0;        // Number of checks performed.
+            size_t          m_NumFailures = 0;      // Number of checks that failed.
+            std::wstring    m_Output;               // Failure messages or measures, one per line.
+        };
+
+        //
+        // Checks that two values are equal. If they are not, both values
+        // are included in the failure message.
+        //
+        // @param p_Expected Expected value.
+        // @param p_Actual Actual value.
+        // @param p_What Description of the check.
+        // @return true if values are equal.
+        //
+        template<typename T, typename U>
+        bool TestContext::CheckEqual(const T& p_Expected,
+                                     const U& p_Actual,
+                                     const std::wstring_view p_What)
+        {
+            if (p_Expected == p_Actual) {
+                return Check(true, p_What);
+            }
+
+            std::wostringstream wos;
+            wos << p_What << L": expected [" << p_Expected << L"], got [" << p_Actual << L"]";
+            return Check(false, wos.str());
+        }
+
+    } // namespace Tests
+
+} // namespace PCC
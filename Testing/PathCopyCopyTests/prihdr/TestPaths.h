@@ -0,0 +1,56 @@
+// TestPaths.h
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <PathCopyCopyPrivateTypes.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+
+namespace PCC
+{
+    namespace Tests
+    {
+        //
+        // TestPaths
+        //
+        // Utility class that produces paths used by tests and benchmarks.
+        //
+        class TestPaths final
+        {
+        public:
+                            TestPaths() = delete;
+                            ~TestPaths() = delete;
+
+            static WStringV MakeCorpus(size_t p_NumPaths,
+                                       uint32_t p_Seed = 42);
+            static const WStringV&
+                            EdgeCases();
+            static std::wstring
+                            Describe(std::wstring_view p_String);
+        };
+
+    } // namespace Tests
+
+} // namespace PCC
@@ -0,0 +1,290 @@
+// FakeFileSystem.cpp
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdafx.h>
+#include <FakeFileSystem.h>
+#include <PathView.h>
+#include <StringUtils.h>
+
+
+namespace
+{
+    constexpr size_t        MAX_SYMLINKS_TO_FOLLOW      = 32;               // Max number of symlinks to follow in a path, to avoid loops.
+    const wchar_t* const    FINAL_PATH_PREFIX           = L"\\\\?\\";       // Prefix of paths returned by GetFinalPath.
+    const wchar_t* const    FINAL_UNC_PATH_PREFIX       = L"\\\\?\\UNC";    // Prefix of UNC paths returned by GetFinalPath.
+
+} // anonymous namespace
+
+namespace PCC
+{
+    //
+    // Adds a file to the file system. If the file already exists,
+    // its attributes are replaced.
+    //
+    // @param p_Path Path of file.
+    // @param p_Attributes File attributes.
+    //
+    void FakeFileSystem::AddFile(const std::wstring& p_Path,
+                                 const DWORD p_Attributes)
+    {
+        AddEntry(p_Path, p_Attributes, std::wstring());
+    }
+
+    //
+    // Adds a folder to the file system. If the folder already exists,
+    // its attributes are replaced.
+    //
+    // @param p_Path Path of folder.
+    // @param p_Attributes Folder attributes; FILE_ATTRIBUTE_DIRECTORY
+    //                     will be added if missing.
+    //
+    void FakeFileSystem::AddFolder(const std::wstring& p_Path,
+                                   const DWORD p_Attributes)
+    {
+        AddEntry(p_Path, p_Attributes | FILE_ATTRIBUTE_DIRECTORY, std::wstring());
+    }
+
+    //
+    // Adds a symlink to the file system. The target does not need to exist.
+    //
+    // @param p_Path Path of symlink.
+    // @param p_TargetPath Path of symlink's target.
+    // @param p_ToFolder Whether the symlink points to a folder.
+    //
+    void FakeFileSystem::AddSymlink(const std::wstring& p_Path,
+                                    const std::wstring& p_TargetPath,
+                                    const bool p_ToFolder)
+    {
+        const DWORD attributes = FILE_ATTRIBUTE_REPARSE_POINT | (p_ToFolder ? FILE_ATTRIBUTE_DIRECTORY : 0);
+        AddEntry(p_Path, attributes, p_TargetPath);
+    }
+
+    //
+    // Removes all files and folders from the file system.
+    //
+    void FakeFileSystem::Clear() noexcept
+    {
+        m_mEntries.clear();
+    }
+
+    //
+    // Returns the number of times GetAttributes has been called. Useful to
+    // see how many times the file system would have been hit on Windows.
+    //
+    // @return Number of calls to GetAttributes.
+    //
+    size_t FakeFileSystem::GetNumAttributeQueries() const noexcept
+    {
+        return m_NumAttributeQueries;
+    }
+
+    //
+    // Returns the attributes of a file or folder. Like on Windows, symlinks
+    // in the path's parents are followed, but not a symlink at the end.
+    //
+    // @param p_Path Path of file or folder.
+    // @return Attributes of file or folder, or INVALID_FILE_ATTRIBUTES.
+    //
+    DWORD FakeFileSystem::GetAttributes(const std::wstring& p_Path) const
+    {
+        ++m_NumAttributeQueries;
+        std::wstring resolvedPath;
+        const Entry* const pEntry = ResolvePath(p_Path, false, resolvedPath) ? FindEntry(resolvedPath) : nullptr;
+        return pEntry != nullptr ? pEntry->m_Attributes : INVALID_FILE_ATTRIBUTES;
+    }
+
+    //
+    // Returns the final path of a file or folder, once all symlinks in
+    // the path have been followed. Like on Windows, the final path is
+    // returned with a "\\?\" or "\\?\UNC" prefix.
+    //
+    // @param p_Path Path of file or folder.
+    // @param p_rFinalPath Where to store the final path.
+    // @return true if the final path could be determined.
+    //
+    bool FakeFileSystem::GetFinalPath(const std::wstring& p_Path,
+                                      std::wstring& p_rFinalPath) const
+    {
+        std::wstring resolvedPath;
+        const bool resolved = ResolvePath(p_Path, true, resolvedPath);
+        if (resolved) {
+            const PathView pathView(resolvedPath);
+            if (pathView.GetRootKind() == PathView::RootKind::UNC) {
+                p_rFinalPath = FINAL_UNC_PATH_PREFIX + resolvedPath.substr(1);
+            } else {
+                p_rFinalPath = FINAL_PATH_PREFIX + resolvedPath;
+            }
+        }
+        return resolved;
+    }
+
+    //
+    // Lists the names of the files and folders contained in a folder.
+    //
+    // @param p_FolderPath Path of folder.
+    // @param p_rvNames Where to add the names of the folder's content.
+    //
+    void FakeFileSystem::EnumerateFolder(const std::wstring& p_FolderPath,
+                                         std::vector<std::wstring>& p_rvNames) const
+    {
+        // Entries are sorted by normalized path, so the folder's content
+        // follows it, along with the content of its subfolders. For a root
+        // like "C:\", the prefix is the root itself, so skip it.
+        std::wstring resolvedPath;
+        if (!ResolvePath(p_FolderPath, true, resolvedPath)) {
+            return;
+        }
+        std::wstring contentPrefix = NormalizePath(resolvedPath);
+        if (contentPrefix.empty() || contentPrefix.back() != L'\\') {
+            contentPrefix += L'\\';
+        }
+        for (auto it = m_mEntries.lower_bound(contentPrefix);
+             it != m_mEntries.end() && it->first.compare(0, contentPrefix.size(), contentPrefix) == 0;
+             ++it) {
+            if (it->first.size() > contentPrefix.size() && it->first.find(L'\\', contentPrefix.size()) == std::wstring::npos) {
+                p_rvNames.emplace_back(it->second.m_Name);
+            }
+        }
+    }
+
+    //
+    // Adds an entry to the file system, along with its missing parents.
+    //
+    // @param p_Path Path of entry.
+    // @param p_Attributes Entry attributes.
+    // @param p_TargetPath Target path, for symlinks; otherwise empty.
+    //
+    void FakeFileSystem::AddEntry(const std::wstring& p_Path,
+                                  const DWORD p_Attributes,
+                                  const std::wstring& p_TargetPath)
+    {
+        for (const std::wstring_view parent : PathView::Parents(p_Path)) {
+            const std::wstring parentKey = NormalizePath(parent);
+            if (m_mEntries.find(parentKey) == m_mEntries.end()) {
+                Entry& rParent = m_mEntries[parentKey];
+                rParent.m_Name = GetName(parent);
+                rParent.m_Attributes = FILE_ATTRIBUTE_DIRECTORY;
+            }
+        }
+
+        const std::wstring key = NormalizePath(p_Path);
+        Entry& rEntry = m_mEntries[key];
+        rEntry.m_Name = GetName(p_Path);
+        rEntry.m_Attributes = p_Attributes;
+        rEntry.m_TargetPath = p_TargetPath;
+    }
+
+    //
+    // Follows the symlinks found in a path to get the path of the actual
+    // file or folder it points to.
+    //
+    // @param p_Path Path to resolve.
+    // @param p_FollowLast Whether to follow a symlink at the end of the path.
+    //                     If false, only symlinks in its parents are followed.
+    // @param p_rResolvedPath Where to store the resolved path.
+    // @return true if the path could be resolved, false if it does not exist
+    //         or if there are too many symlinks to follow.
+    //
+    bool FakeFileSystem::ResolvePath(const std::wstring& p_Path,
+                                     const bool p_FollowLast,
+                                     std::wstring& p_rResolvedPath) const
+    {
+        p_rResolvedPath = p_Path;
+        std::wstring prefix;
+        std::vector<size_t> vPrefixSizes;
+        for (size_t symlinksFollowed = 0; symlinksFollowed <= MAX_SYMLINKS_TO_FOLLOW; ++symlinksFollowed) {
+            // Look at each part of the path, starting with the root, until we
+            // find one that does not exist or that is a symlink to follow.
+            vPrefixSizes.clear();
+            vPrefixSizes.push_back(p_rResolvedPath.size());
+            for (const std::wstring_view parent : PathView::Parents(p_rResolvedPath)) {
+                vPrefixSizes.push_back(parent.size());
+            }
+            const Entry* pSymlink = nullptr;
+            size_t symlinkSize = 0;
+            for (auto it = vPrefixSizes.crbegin(); pSymlink == nullptr && it != vPrefixSizes.crend(); ++it) {
+                prefix.assign(p_rResolvedPath, 0, *it);
+                const Entry* const pEntry = FindEntry(prefix);
+                if (pEntry == nullptr) {
+                    return false;
+                }
+                if (!pEntry->m_TargetPath.empty() && (p_FollowLast || *it != p_rResolvedPath.size())) {
+                    pSymlink = pEntry;
+                    symlinkSize = *it;
+                }
+            }
+            if (pSymlink == nullptr) {
+                return true;
+            }
+            p_rResolvedPath.replace(0, symlinkSize, pSymlink->m_TargetPath);
+        }
+
+        // Too many symlinks, probably a loop.
+        return false;
+    }
+
+    //
+    // Finds the entry for a file or folder.
+    //
+    // @param p_Path Path of file or folder.
+    // @return Pointer to entry, or nullptr if not found.
+    //
+    auto FakeFileSystem::FindEntry(const std::wstring& p_Path) const -> const Entry*
+    {
+        const auto it = m_mEntries.find(NormalizePath(p_Path));
+        return it != m_mEntries.end() ? &it->second : nullptr;
+    }
+
+    //
+    // Returns the name of a file or folder, e.g. the last part of its path.
+    // If the path is a root, like "C:\", returns the entire path.
+    //
+    // @param p_Path Path of file or folder.
+    // @return Name of file or folder.
+    //
+    std::wstring FakeFileSystem::GetName(const std::wstring_view p_Path)
+    {
+        const size_t lastSepPos = p_Path.find_last_of(L"\\/");
+        const bool hasName = lastSepPos != std::wstring_view::npos && lastSepPos + 1 < p_Path.size();
+        return std::wstring(hasName ? p_Path.substr(lastSepPos + 1) : p_Path);
+    }
+
+    //
+    // Normalizes a path so that it can be used as a key in the map
+    // of entries: separators are converted to '\', trailing separators
+    // are removed (except for a root like "C:\") and the path is
+    // converted to uppercase so that lookups are case-insensitive.
+    //
+    // @param p_Path Path to normalize.
+    // @return Normalized path.
+    //
+    std::wstring FakeFileSystem::NormalizePath(const std::wstring_view p_Path)
+    {
+        std::wstring normalized = StringUtils::ToUppercase(std::wstring(p_Path));
+        StringUtils::ReplaceChar(normalized, L'/', L'\\');
+        const size_t rootSize = PathView::GetRootSize(normalized);
+        while (normalized.size() > rootSize && normalized.back() == L'\\') {
+            normalized.pop_back();
+        }
+        return normalized;
+    }
+
+} // namespace PCC
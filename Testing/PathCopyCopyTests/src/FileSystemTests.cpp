@@ -0,0 +1,249 @@
+// FileSystemTests.cpp
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdafx.h>
+#include <FileSystemTests.h>
+#include <CachedFileSystem.h>
+#include <FakeFileSystem.h>
+#include <PluginUtils.h>
+#include <StCurrentFileSystem.h>
+#include <TestContext.h>
+
+#include <string>
+#include <vector>
+
+
+namespace
+{
+    // Number of files selected in the simulated menu operation.
+    constexpr size_t    NUM_SELECTED_FILES      = 20;
+
+    // Number of plugins previewed in the simulated menu operation.
+    constexpr size_t    NUM_PREVIEWED_PLUGINS   = 12;
+
+    //
+    // Path checked with PluginUtils::IsDirectory.
+    //
+    struct IsDirectoryCase {
+        const wchar_t*  m_pPath;            // Path to check.
+        bool            m_Expected;         // Whether path is expected to be a directory.
+    };
+
+    // Paths checked with PluginUtils::IsDirectory.
+    const IsDirectoryCase   IS_DIRECTORY_CASES[] = {
+        { L"C:\\",                              true    },
+        { L"C:\\Users",                         true    },
+        { L"c:\\USERS\\Me\\docs",               true    },
+        { L"C:/Users/me/Docs/",                 true    },
+        { L"C:\\Users\\me\\Docs\\Sub",          true    },
+        { L"C:\\Users\\me\\Docs\\a.txt",        false   },
+        { L"C:\\Users\\me\\Docs\\missing",      false   },
+        { L"C:\\Users\\me\\Link",               true    },
+        { L"C:\\Users\\me\\Link\\x",            true    },
+        { L"C:\\Users\\me\\Link\\x\\y.txt",     false   },
+        { L"\\\\srv\\share",                    true    },
+        { L"\\\\srv\\share\\real.txt",          false   },
+    };
+
+    //
+    // Path followed with PluginUtils::FollowSymlinkIfRequired.
+    //
+    struct FollowSymlinkCase {
+        const wchar_t*  m_pPath;            // Path to follow.
+        bool            m_ExpectedSymlink;  // Whether path or one of its parents is expected to be a symlink.
+        const wchar_t*  m_pExpectedPath;    // Expected path after following symlinks.
+    };
+
+    // Paths followed with PluginUtils::FollowSymlinkIfRequired.
+    const FollowSymlinkCase FOLLOW_SYMLINK_CASES[] = {
+        { L"C:\\Users\\me\\Docs\\a.txt",            false,  L"C:\\Users\\me\\Docs\\a.txt"   },
+        { L"C:\\Users\\me\\Docs\\missing.txt",      false,  L"C:\\Users\\me\\Docs\\missing.txt" },
+        { L"C:\\Users\\me\\Link",                   true,   L"D:\\Target"                   },
+        { L"C:\\Users\\me\\Link\\x\\y.txt",         true,   L"D:\\Target\\x\\y.txt"         },
+        { L"c:\\users\\ME\\link\\x\\y.txt",         true,   L"D:\\Target\\x\\y.txt"         },
+        { L"C:\\Users\\me\\Link\\x\\ylink.txt",     true,   L"\\\\srv\\share\\real.txt"     },
+        { L"C:\\Users\\me\\Docs\\share.lnk\\c.txt", true,   L"\\\\srv\\share\\c.txt"        },
+        { L"C:\\loop1\\z.txt",                      true,   L"C:\\loop1\\z.txt"             },
+    };
+
+    //
+    // Adds the files, folders and symlinks used by tests to a fake file system.
+    //
+    // @param p_rFileSystem File system to fill.
+    //
+    void AddTestFiles(PCC::FakeFileSystem& p_rFileSystem)
+    {
+        p_rFileSystem.AddFile(L"C:\\Users\\me\\Docs\\a.txt");
+        p_rFileSystem.AddFolder(L"C:\\Users\\me\\Docs\\Sub");
+        p_rFileSystem.AddSymlink(L"C:\\Users\\me\\Link", L"D:\\Target", true);
+        p_rFileSystem.AddFile(L"D:\\Target\\x\\y.txt");
+        p_rFileSystem.AddSymlink(L"D:\\Target\\x\\ylink.txt", L"\\\\srv\\share\\real.txt", false);
+        p_rFileSystem.AddSymlink(L"C:\\Users\\me\\Docs\\share.lnk", L"\\\\srv\\share", true);
+        p_rFileSystem.AddFile(L"\\\\srv\\share\\real.txt");
+        p_rFileSystem.AddFile(L"\\\\srv\\share\\c.txt");
+        p_rFileSystem.AddSymlink(L"C:\\loop1", L"C:\\loop2", true);
+        p_rFileSystem.AddSymlink(L"C:\\loop2", L"C:\\loop1", true);
+    }
+
+    //
+    // Result of a simulated menu operation.
+    //
+    struct OperationResult {
+        std::vector<std::wstring>   m_vPaths;           // Paths of selected files, after following symlinks.
+        std::vector<bool>           m_vDirectories;     // Whether each path is a directory.
+        size_t                      m_NumSymlinks = 0;  // Number of paths that pointed to symlinks.
+    };
+
+    //
+    // Simulates the file system queries performed when showing the contextual
+    // menu for some files then invoking a plugin: files and folders are
+    // checked, plugins are previewed on the first file, then paths are
+    // computed for all files.
+    //
+    // @param p_vFiles Paths of selected files.
+    // @return Result of the operation.
+    //
+    OperationResult SimulateMenuOperation(const std::vector<std::wstring>& p_vFiles)
+    {
+        OperationResult result;
+        for (const auto& file : p_vFiles) {
+            PCC::PluginUtils::IsDirectory(file);
+        }
+        for (size_t i = 0; i < NUM_PREVIEWED_PLUGINS; ++i) {
+            std::wstring path(p_vFiles.front());
+            PCC::PluginUtils::FollowSymlinkIfRequired(path);
+            PCC::PluginUtils::IsDirectory(path);
+        }
+        for (const auto& file : p_vFiles) {
+            std::wstring path(file);
+            if (PCC::PluginUtils::FollowSymlinkIfRequired(path)) {
+                ++result.m_NumSymlinks;
+            }
+            result.m_vDirectories.push_back(PCC::PluginUtils::IsDirectory(path));
+            result.m_vPaths.push_back(std::move(path));
+        }
+        return result;
+    }
+
+} // anonymous namespace
+
+namespace PCC
+{
+    namespace Tests
+    {
+        //
+        // Tests PluginUtils::IsDirectory and PluginUtils::FollowSymlinkIfRequired
+        // on a fake file system installed as the current one, including paths
+        // with symlinks in their parents, symlinks to UNC paths (whose final
+        // path prefixes must be removed) and symlink loops.
+        //
+        // @param p_rContext Context used to perform checks.
+        //
+        void TestFileSystemPluginUtils(TestContext& p_rContext)
+        {
+            FakeFileSystem fileSystem;
+            AddTestFiles(fileSystem);
+            {
+                StCurrentFileSystem currentFileSystem(fileSystem);
+                p_rContext.Check(&FileSystem::Current() == &fileSystem, L"Fake file system is current");
+
+                for (const auto& isDirectoryCase : IS_DIRECTORY_CASES) {
+                    p_rContext.CheckEqual(isDirectoryCase.m_Expected,
+                                          PluginUtils::IsDirectory(isDirectoryCase.m_pPath),
+                                          std::wstring(L"IsDirectory(") + isDirectoryCase.m_pPath + L")");
+                }
+
+                for (const auto& followCase : FOLLOW_SYMLINK_CASES) {
+                    std::wstring path(followCase.m_pPath);
+                    const bool symlink = PluginUtils::FollowSymlinkIfRequired(path);
+                    const std::wstring what = std::wstring(L"FollowSymlinkIfRequired(") + followCase.m_pPath + L")";
+                    p_rContext.CheckEqual(followCase.m_ExpectedSymlink, symlink, what);
+                    p_rContext.CheckEqual(std::wstring(followCase.m_pExpectedPath), path, what + L" path");
+                }
+
+                const size_t numQueries = fileSystem.GetNumAttributeQueries();
+                p_rContext.Check(numQueries > 0, L"Fake file system was queried");
+                {
+                    StCurrentFileSystem nestedFileSystem(fileSystem);
+                }
+                p_rContext.Check(&FileSystem::Current() == &fileSystem, L"Nested file system restored");
+            }
+            p_rContext.Check(&FileSystem::Current() != &fileSystem, L"Previous file system restored");
+        }
+
+        //
+        // Tests that a CachedFileSystem installed as the current one returns
+        // the same results as the file system it wraps for a simulated menu
+        // operation, while querying it less often.
+        //
+        // @param p_rContext Context used to perform checks.
+        //
+        void TestFileSystemCached(TestContext& p_rContext)
+        {
+            std::vector<std::wstring> vFiles;
+            FakeFileSystem fileSystem;
+            AddTestFiles(fileSystem);
+            for (size_t i = 0; i < NUM_SELECTED_FILES; ++i) {
+                const std::wstring fileName = L"file" + std::to_wstring(i) + L".txt";
+                fileSystem.AddFile(L"D:\\Target\\x\\" + fileName);
+                vFiles.push_back(L"C:\\Users\\me\\Link\\x\\" + fileName);
+            }
+            vFiles.emplace_back(L"C:\\Users\\me\\Docs\\a.txt");
+            vFiles.emplace_back(L"C:\\Users\\me\\Docs\\Sub");
+            vFiles.emplace_back(L"C:\\Users\\me\\Docs\\share.lnk\\c.txt");
+
+            OperationResult expected;
+            {
+                StCurrentFileSystem currentFileSystem(fileSystem);
+                expected = SimulateMenuOperation(vFiles);
+            }
+            const size_t numUncachedQueries = fileSystem.GetNumAttributeQueries();
+            p_rContext.CheckEqual(NUM_SELECTED_FILES + 1, expected.m_NumSymlinks, L"Symlinks followed without cache");
+
+            CachedFileSystem cachedFileSystem(fileSystem);
+            for (int pass = 0; pass < 2; ++pass) {
+                const std::wstring passName = L"Pass " + std::to_wstring(pass + 1) + L": ";
+                const size_t numQueriesBefore = fileSystem.GetNumAttributeQueries();
+                OperationResult actual;
+                {
+                    StCurrentFileSystem currentFileSystem(cachedFileSystem);
+                    actual = SimulateMenuOperation(vFiles);
+                }
+                const size_t numCachedQueries = fileSystem.GetNumAttributeQueries() - numQueriesBefore;
+
+                p_rContext.Check(expected.m_vPaths == actual.m_vPaths, passName + L"Same paths");
+                p_rContext.Check(expected.m_vDirectories == actual.m_vDirectories, passName + L"Same directories");
+                p_rContext.CheckEqual(expected.m_NumSymlinks, actual.m_NumSymlinks, passName + L"Same number of symlinks");
+                p_rContext.Check(numCachedQueries < numUncachedQueries / 2, passName + L"Fewer queries (" +
+                                 std::to_wstring(numCachedQueries) + L" vs " + std::to_wstring(numUncachedQueries) + L")");
+
+                const auto& stats = cachedFileSystem.GetReparsePointStats();
+                p_rContext.Check(stats.m_NumPartHits > stats.m_NumPartMisses, passName + L"Reparse point parents hit");
+                p_rContext.Check(stats.m_NumTargetHits > 0, passName + L"Reparse point targets hit");
+
+                // Clear cache between operations, like the contextual menu does.
+                cachedFileSystem.Clear();
+            }
+        }
+
+    } // namespace Tests
+
+} // namespace PCC
@@ -0,0 +1,137 @@
+// NetworkShareIndexTests.cpp
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdafx.h>
+#include <NetworkShareIndexTests.h>
+#include <NetworkShareIndex.h>
+#include <TestContext.h>
+#include <TestPaths.h>
+
+
+namespace
+{
+    // Info about a path looked up in the test share index.
+    struct FindCase {
+        const wchar_t*  m_pPath;            // Path to look for.
+        bool            m_UseHiddenShares;  // Whether to consider hidden shares.
+        const wchar_t*  m_pShareName;       // Name of share expected to be found, or nullptr if none.
+    };
+
+    // Cases looked up in the share index built by MakeTestShares.
+    const FindCase      FIND_CASES[] = {
+        // Nested shares: the share with the longest path wins.
+        { L"C:\\Docs\\file.txt",                false,  L"Docs" },
+        { L"C:\\Docs\\Sub\\file.txt",           false,  L"Sub" },
+        { L"C:\\Docs\\Sub",                     false,  L"Sub" },
+        { L"C:\\Docs\\Sub\\",                   false,  L"Sub" },
+        { L"C:\\Docs\\Subway\\file.txt",        false,  L"Docs" },
+
+        // Hidden shares are only used when asked to.
+        { L"C:\\Windows\\notepad.exe",          false,  nullptr },
+        { L"C:\\Windows\\notepad.exe",          true,   L"C$" },
+        { L"C:\\Docs\\file.txt",                true,   L"Docs" },
+        { L"C:\\Admin\\file.txt",               false,  L"Admin" },
+        { L"C:\\Admin\\file.txt",               true,   L"Admin$" },
+        { L"D:\\Data\\file.txt",                false,  L"Data" },
+        { L"D:\\Data\\file.txt",                true,   L"Data" },
+        { L"D:\\Other\\file.txt",               true,   L"D$" },
+
+        // Paths are compared case-insensitively.
+        { L"c:\\docs\\FILE.TXT",                false,  L"Docs" },
+        { L"C:\\DOCS\\sub\\file.txt",           false,  L"Sub" },
+        { L"d:\\data",                          false,  L"Data" },
+
+        // Share paths must match entire path parts.
+        { L"C:\\Foo",                           false,  L"Foo" },
+        { L"C:\\Foo\\x",                        false,  L"Foo" },
+        { L"C:\\FooBar\\x",                     false,  nullptr },
+        { L"C:\\Fo",                            false,  nullptr },
+        { L"C:\\Doc",                           false,  nullptr },
+        { L"C:\\DocsAndMore",                   false,  nullptr },
+        { L"C:\\FooBar\\x",                     true,   L"C$" },
+
+        // Share paths with a trailing separator.
+        { L"E:\\Music\\song.mp3",               false,  L"Music" },
+        { L"E:\\Music",                         false,  nullptr },
+        { L"E:\\Musical\\song.mp3",             false,  nullptr },
+
+        // Paths not in a share.
+        { L"F:\\file.txt",                      true,   nullptr },
+        { L"\\\\server\\share\\file.txt",       true,   nullptr },
+        { L"",                                  true,   nullptr },
+    };
+
+    //
+    // Returns shares used to test NetworkShareIndex::Find. Some paths
+    // are shared both as a hidden and as a visible share.
+    //
+    // @return Test shares.
+    //
+    PCC::NetworkShareIndex::ShareV MakeTestShares()
+    {
+        return {
+            { L"C$",        L"C:\\" },
+            { L"Admin$",    L"C:\\Admin" },
+            { L"Admin",     L"C:\\Admin" },
+            { L"Docs",      L"C:\\Docs" },
+            { L"Sub",       L"C:\\Docs\\Sub" },
+            { L"Foo",       L"C:\\Foo" },
+            { L"Data",      L"D:\\Data" },
+            { L"Data$",     L"D:\\Data" },
+            { L"D$",        L"D:\\" },
+            { L"Music",     L"E:\\Music\\" },
+        };
+    }
+
+} // anonymous namespace
+
+namespace PCC
+{
+    namespace Tests
+    {
+        //
+        // Tests that NetworkShareIndex::Find returns the share with the
+        // longest path containing a path, ignoring case and hidden shares
+        // if needed, and that share paths only match entire path parts.
+        //
+        // @param p_rContext Context used to perform checks.
+        //
+        void TestNetworkShareIndexFind(TestContext& p_rContext)
+        {
+            const NetworkShareIndex emptyIndex;
+            p_rContext.Check(emptyIndex.Find(L"C:\\Docs\\file.txt", true) == nullptr,
+                             L"Path found in empty share index");
+
+            const NetworkShareIndex index(MakeTestShares());
+            p_rContext.CheckEqual(MakeTestShares().size(), index.GetNumShares(), L"Number of shares in index");
+            for (const auto& findCase : FIND_CASES) {
+                const auto* const pShare = index.Find(findCase.m_pPath, findCase.m_UseHiddenShares);
+                const std::wstring what = L"Share found for " + TestPaths::Describe(findCase.m_pPath) +
+                                          (findCase.m_UseHiddenShares ? L" (with hidden shares)" : L"");
+                p_rContext.CheckEqual(std::wstring(findCase.m_pShareName != nullptr ? findCase.m_pShareName : L"(none)"),
+                                      std::wstring(pShare != nullptr ? pShare->m_Name : L"(none)"),
+                                      what);
+            }
+        }
+
+    } // namespace Tests
+
+} // namespace PCC
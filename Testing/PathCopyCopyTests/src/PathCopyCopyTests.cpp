@@ -0,0 +1,74 @@
+// PathCopyCopyTests.cpp
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdafx.h>
+#include <StCoInitialize.h>
+#include <TestRunner.h>
+
+#include <iostream>
+#include <string>
+
+
+//
+// Main program entry point. Runs the self-tests of Path Copy Copy and
+// writes their report to the standard output. If the first argument is
+// /benchmarks, runs the benchmarks instead. The last argument can specify
+// a filter: only tests or benchmarks whose name starts with it are run.
+// Call like this:
+//
+// PathCopyCopyTests.exe [/benchmarks] [filter]
+//
+// @param argc Number of command-line arguments received
+// @param argv Array of command-line arguments
+// @return Number of tests that failed, or -1 if COM could not be initialized
+//
+int wmain(int argc, wchar_t* argv[])
+{
+    // Initialize COM like the shell extension does.
+    StCoInitialize initCom;
+    if (FAILED(initCom.GetInitResult())) {
+        std::wcout << L"ERROR! Could not initialize COM: 0x" << std::hex << initCom.GetInitResult() << std::endl;
+        return -1;
+    }
+
+    const gsl::span<wchar_t*> args(argv, argc);
+    bool benchmarks = false;
+    std::wstring filter;
+    if (!args.empty()) {
+        for (const std::wstring arg : args.subspan(1)) {
+            if (arg == L"/benchmarks") {
+                benchmarks = true;
+            } else {
+                filter = arg;
+            }
+        }
+    }
+
+    int retVal = 0;
+    if (benchmarks) {
+        std::wcout << PCC::Tests::TestRunner::RunBenchmarks(filter);
+    } else {
+        size_t numFailedTests = 0;
+        std::wcout << PCC::Tests::TestRunner::RunTests(filter, numFailedTests);
+        retVal = static_cast<int>(numFailedTests);
+    }
+    return retVal;
+}
@@ -0,0 +1,298 @@
+// PipelineElementTests.cpp
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdafx.h>
+#include <PipelineElementTests.h>
+#include <PluginPipelineElements.h>
+#include <TestContext.h>
+#include <TestPaths.h>
+
+#include <random>
+#include <utility>
+
+
+namespace
+{
+    // Paths normalized by NormalizePathPipelineElement, with the expected results.
+    const std::pair<const wchar_t*, const wchar_t*> NORMALIZE_PATH_CASES[] = {
+        // Drive-relative paths keep their leading ".." parts.
+        { L"C:..\\foo",                             L"C:..\\foo" },
+        { L"C:..\\..\\foo",                         L"C:..\\..\\foo" },
+        { L"C:a\\..\\..\\foo",                      L"C:..\\foo" },
+        { L"C:a\\..",                               L"C:" },
+        { L"C:\\..\\foo",                           L"C:\\foo" },
+        { L"C:\\folder\\..\\..\\..",                L"C:\\" },
+
+        // ".." parts never go above UNC or prefixed roots.
+        { L"\\\\server\\share\\..\\x",              L"\\\\server\\share\\x" },
+        { L"\\\\server\\share\\a\\..\\..\\x",       L"\\\\server\\share\\x" },
+        { L"\\\\?\\C:\\a\\..\\b",                   L"\\\\?\\C:\\b" },
+        { L"\\\\?\\C:\\..\\..\\b",                  L"\\\\?\\C:\\b" },
+        { L"\\\\?\\UNC\\server\\share\\..\\b",      L"\\\\?\\UNC\\server\\share\\b" },
+        { L"\\\\.\\device\\a\\..\\..\\b",           L"\\\\.\\device\\b" },
+        { L"\\a\\..\\..\\b",                        L"\\b" },
+
+        // Relative paths keep the ".." parts that cannot be resolved.
+        { L"a\\..\\..\\b",                          L"..\\b" },
+        { L"..\\a\\..\\..\\b",                      L"..\\..\\b" },
+        { L"a\\b\\..\\..\\..\\..\\c",               L"..\\..\\c" },
+        { L"a\\..b\\..\\c..",                       L"a\\c.." },
+
+        // Duplicate and trailing separators are removed.
+        { L"C:\\folder\\\\\\sub\\\\file.txt",       L"C:\\folder\\sub\\file.txt" },
+        { L"C:\\folder\\sub\\",                     L"C:\\folder\\sub" },
+        { L"C:\\folder\\sub\\\\\\",                 L"C:\\folder\\sub" },
+        { L"\\\\server\\share\\\\folder\\",         L"\\\\server\\share\\folder" },
+        { L"C:\\.\\",                               L"C:\\" },
+
+        // Separators are converted to the first one found in the path.
+        { L"C:/folder\\sub/file.txt",               L"C:/folder/sub/file.txt" },
+        { L"folder/sub\\.\\file.txt",               L"folder/sub/file.txt" },
+        { L"\\\\server\\share/folder\\file",        L"\\\\server\\share\\folder\\file" },
+        { L"/\\server/share\\..\\x",                L"//server/share/x" },
+
+        // Relative paths that are entirely removed point to the current folder.
+        { L"a\\..",                                 L"." },
+        { L".\\",                                   L"." },
+        { L".\\.\\.",                               L"." },
+        { L"a\\b\\..\\..\\",                        L"." },
+        { L"a/./..",                                L"." },
+
+        // Paths without separators are not modified.
+        { L"..",                                    L".." },
+        { L".",                                     L"." },
+        { L"file.txt",                              L"file.txt" },
+        { L"",                                      L"" },
+    };
+
+    // Fragments inserted in paths to give NormalizePathPipelineElement something to do.
+    const wchar_t* const    NORMALIZE_PATH_FRAGMENTS[] = {
+        L"\\.", L"\\..", L"\\", L"\\sub\\..", L"/",
+    };
+
+    // Info about a path modified by MultiFindReplacePipelineElement.
+    struct MultiFindReplaceCase {
+        PCC::WStringPairV   m_vFindReplacePairs;    // Values to find and their replacement.
+        const wchar_t*      m_pPath;                // Path to modify.
+        const wchar_t*      m_pExpected;            // Expected result.
+    };
+
+    // Paths modified by MultiFindReplacePipelineElement, with the expected results.
+    const MultiFindReplaceCase  MULTI_FIND_REPLACE_CASES[] = {
+        // Overlapping values: the leftmost match wins, then the longest one.
+        { { { L"abcd", L"1" }, { L"bc", L"2" } },                     L"abce",            L"a2e" },
+        { { { L"abcd", L"1" }, { L"bc", L"2" } },                     L"abcd",            L"1" },
+        { { { L"ab", L"1" }, { L"abc", L"2" }, { L"bcd", L"3" } },    L"abcd",            L"2d" },
+        { { { L"ab", L"1" }, { L"abc", L"2" }, { L"bcd", L"3" } },    L"abd",             L"1d" },
+        { { { L"ab", L"1" }, { L"abc", L"2" }, { L"bcd", L"3" } },    L"xbcdab",          L"x31" },
+        { { { L"b", L"1" }, { L"abc", L"2" } },                       L"abd",             L"a1d" },
+        { { { L"aa", L"1" } },                                        L"aaa",             L"1a" },
+
+        // Adjacent matches are all replaced; replacement values are not scanned.
+        { { { L"ab", L"1" }, { L"cd", L"2" } },                       L"abcd",            L"12" },
+        { { { L"a", L"b" }, { L"b", L"a" } },                         L"abab",            L"baba" },
+        { { { L"\\", L"/" } },                                        L"C:\\a\\\\b\\",    L"C:/a//b/" },
+        { { { L"x", L"xx" } },                                        L"xyx",             L"xxyxx" },
+
+        // Duplicate values use their first replacement; empty values are ignored.
+        { { { L"ab", L"1" }, { L"ab", L"2" } },                       L"abab",            L"11" },
+        { { { L"", L"1" }, { L"b", L"2" }, { L"b", L"3" } },          L"abc",             L"a2c" },
+
+        // Values are compared case-sensitively.
+        { { { L"ab", L"1" } },                                        L"AbaB",            L"AbaB" },
+
+        // Paths without any character that can start a value are not modified.
+        { { { L"ab", L"1" }, { L"cd", L"2" } },                       L"xyz\\xyz",        L"xyz\\xyz" },
+        { { { L"\u00E9t\u00E9", L"summer" } },                        L"\u00E8t\u00E8",   L"\u00E8t\u00E8" },
+        { { { L"\u00E9t\u00E9", L"summer" } },                        L"\u00E9t\u00E9s",  L"summers" },
+        { { { L"ab", L"1" } },                                        L"",                L"" },
+        { { },                                                        L"abc",             L"abc" },
+    };
+
+    // Table of prefixes used to test PrefixMapPipelineElement.
+    const PCC::WStringPairV PREFIX_MAP_TABLE = {
+        { L"D:\\Projects",                          L"R:" },
+        { L"D:\\Projects\\X",                       L"P:\\X" },
+        { L"D:\\Projects\\Xyz",                     L"Q:" },
+        { L"C:\\Old\\",                             L"D:\\New\\" },
+        { L"e:/mixed/slashes",                      L"M:" },
+        { L"d:\\projects\\x",                       L"ignored" },
+    };
+
+    // Paths modified by PrefixMapPipelineElement using PREFIX_MAP_TABLE, with the expected results.
+    const std::pair<const wchar_t*, const wchar_t*> PREFIX_MAP_CASES[] = {
+        // Prefixes only match entire path parts; the longest one wins.
+        { L"D:\\Projects\\X\\file.txt",             L"P:\\X\\file.txt" },
+        { L"D:\\Projects\\Xyz\\file.txt",           L"Q:\\file.txt" },
+        { L"D:\\Projects\\Xy\\file.txt",            L"R:\\Xy\\file.txt" },
+        { L"D:\\Projects\\Xyzzy\\file.txt",         L"R:\\Xyzzy\\file.txt" },
+        { L"D:\\Projects\\X",                       L"P:\\X" },
+        { L"D:\\Projects\\X\\",                     L"P:\\X\\" },
+        { L"D:\\ProjectsOld\\X\\file.txt",          L"D:\\ProjectsOld\\X\\file.txt" },
+
+        // Prefixes ending with a separator only match when the path has one.
+        { L"C:\\Old\\file.txt",                     L"D:\\New\\file.txt" },
+        { L"C:\\Old",                               L"C:\\Old" },
+        { L"C:\\Older\\file.txt",                   L"C:\\Older\\file.txt" },
+
+        // Prefixes ignore case; duplicate prefixes use their first replacement.
+        { L"d:\\projects\\x\\file.txt",             L"P:\\X\\file.txt" },
+        { L"D:\\PROJECTS\\XYZ",                     L"Q:" },
+
+        // Forward slashes and backslashes match each other.
+        { L"D:/Projects/X/file.txt",                L"P:\\X/file.txt" },
+        { L"C:/Old/file.txt",                       L"D:\\New\\file.txt" },
+        { L"E:\\Mixed\\Slashes\\file.txt",          L"M:\\file.txt" },
+        { L"E:\\Mixed/Slashesque",                  L"E:\\Mixed/Slashesque" },
+
+        // Paths without a matching prefix are not modified.
+        { L"F:\\Projects\\X\\file.txt",             L"F:\\Projects\\X\\file.txt" },
+        { L"D:\\Proj",                              L"D:\\Proj" },
+        { L"",                                      L"" },
+    };
+
+    //
+    // Inserts fragments that need normalizing at random separators
+    // of paths, like "." and ".." parts and duplicate separators.
+    //
+    // @param p_vPaths Paths to modify.
+    // @return Paths containing parts to normalize.
+    //
+    PCC::WStringV MakeUnnormalizedPaths(const PCC::WStringV& p_vPaths)
+    {
+        std::mt19937 engine(42);
+        PCC::WStringV vUnnormalized;
+        vUnnormalized.reserve(p_vPaths.size());
+        for (const auto& path : p_vPaths) {
+            std::wstring unnormalized;
+            unnormalized.reserve(path.size() * 2);
+            for (const wchar_t c : path) {
+                if (c == L'\\' && unnormalized.size() > 2 && engine() % 3 == 0) {
+                    unnormalized += NORMALIZE_PATH_FRAGMENTS[engine() % std::size(NORMALIZE_PATH_FRAGMENTS)];
+                }
+                unnormalized.push_back(c);
+            }
+            vUnnormalized.push_back(std::move(unnormalized));
+        }
+        return vUnnormalized;
+    }
+
+} // anonymous namespace
+
+namespace PCC
+{
+    namespace Tests
+    {
+        //
+        // Tests that NormalizePathPipelineElement resolves "." and ".." parts,
+        // removes duplicate and trailing separators and keeps path roots.
+        // Also checks that normalizing a normalized path does not change it.
+        //
+        // @param p_rContext Context used to perform checks.
+        //
+        void TestElementsNormalizePath(TestContext& p_rContext)
+        {
+            const NormalizePathPipelineElement element;
+            for (const auto& normalizeCase : NORMALIZE_PATH_CASES) {
+                std::wstring path(normalizeCase.first);
+                element.ModifyPath(path, nullptr);
+                p_rContext.CheckEqual(std::wstring(normalizeCase.second), path,
+                                      L"Normalized " + TestPaths::Describe(normalizeCase.first));
+
+                std::wstring normalizedAgain(path);
+                element.ModifyPath(normalizedAgain, nullptr);
+                p_rContext.CheckEqual(path, normalizedAgain,
+                                      L"Normalized twice " + TestPaths::Describe(normalizeCase.first));
+            }
+        }
+
+        //
+        // Tests that MultiFindReplacePipelineElement replaces values using
+        // the leftmost-longest rule, with overlapping, adjacent and duplicate
+        // values to find.
+        //
+        // @param p_rContext Context used to perform checks.
+        //
+        void TestElementsMultiFindReplace(TestContext& p_rContext)
+        {
+            for (const auto& multiFindReplaceCase : MULTI_FIND_REPLACE_CASES) {
+                const MultiFindReplacePipelineElement element(multiFindReplaceCase.m_vFindReplacePairs);
+                std::wstring path(multiFindReplaceCase.m_pPath);
+                element.ModifyPath(path, nullptr);
+
+                std::wstring what(L"Replaced");
+                for (const auto& findReplacePair : multiFindReplaceCase.m_vFindReplacePairs) {
+                    what += L" \"" + findReplacePair.first + L"\"->\"" + findReplacePair.second + L"\"";
+                }
+                what += L" in " + TestPaths::Describe(multiFindReplaceCase.m_pPath);
+                p_rContext.CheckEqual(std::wstring(multiFindReplaceCase.m_pExpected), path, what);
+            }
+        }
+
+        //
+        // Tests that PrefixMapPipelineElement replaces the longest prefix
+        // matching entire parts of a path, ignoring case and the kind of
+        // separators used.
+        //
+        // @param p_rContext Context used to perform checks.
+        //
+        void TestElementsPrefixMap(TestContext& p_rContext)
+        {
+            const PrefixMapPipelineElement element(PREFIX_MAP_TABLE);
+            for (const auto& prefixMapCase : PREFIX_MAP_CASES) {
+                std::wstring path(prefixMapCase.first);
+                element.ModifyPath(path, nullptr);
+                p_rContext.CheckEqual(std::wstring(prefixMapCase.second), path,
+                                      L"Prefix mapped " + TestPaths::Describe(prefixMapCase.first));
+            }
+        }
+
+        //
+        // Measures NormalizePathPipelineElement on a corpus of paths that are
+        // already normalized and on the same paths with "." and ".." parts
+        // and duplicate separators inserted.
+        //
+        // @param p_rContext Context used to measure code.
+        //
+        void BenchmarkElementsNormalizePath(TestContext& p_rContext)
+        {
+            const NormalizePathPipelineElement element;
+            const WStringV vPaths = TestPaths::MakeCorpus(1000);
+            const WStringV vUnnormalizedPaths = MakeUnnormalizedPaths(vPaths);
+
+            WStringV vResults;
+            p_rContext.Measure(L"NormalizePath / normalized paths", vPaths.size(), [&]() {
+                vResults = vPaths;
+                for (auto& path : vResults) {
+                    element.ModifyPath(path, nullptr);
+                }
+            });
+            p_rContext.Measure(L"NormalizePath / paths to normalize", vUnnormalizedPaths.size(), [&]() {
+                vResults = vUnnormalizedPaths;
+                for (auto& path : vResults) {
+                    element.ModifyPath(path, nullptr);
+                }
+            });
+        }
+
+    } // namespace Tests
+
+} // namespace PCC
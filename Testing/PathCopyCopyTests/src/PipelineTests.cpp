@@ -0,0 +1,563 @@
+// PipelineTests.cpp
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdafx.h>
+#include <PipelineTests.h>
+#include <AllPluginsProvider.h>
+#include <PipelinePlugin.h>
+#include <PluginPipeline.h>
+#include <PluginPipelineDecoder.h>
+#include <PluginPipelineElements.h>
+#include <PluginPipelineOptimizer.h>
+#include <TestContext.h>
+#include <TestPaths.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+
+namespace
+{
+    // ID of pipeline plugins created by tests.
+    const GUID  TEST_PLUGIN_ID = { 0x5a1e7e57, 0x3c2b, 0x4f0e, { 0x9d, 0x61, 0x0b, 0x7e, 0x2c, 0x44, 0x18, 0xa3 } };
+
+    // IDs of nested pipeline plugins created by inlining tests, from outermost to innermost.
+    const GUID  NESTED_PLUGIN_IDS[] = {
+        { 0x2f0c6d1a, 0x7b3e, 0x4c55, { 0x8a, 0x02, 0x61, 0xd4, 0x9e, 0x13, 0x5b, 0x70 } },
+        { 0x2f0c6d1a, 0x7b3e, 0x4c55, { 0x8a, 0x02, 0x61, 0xd4, 0x9e, 0x13, 0x5b, 0x71 } },
+        { 0x2f0c6d1a, 0x7b3e, 0x4c55, { 0x8a, 0x02, 0x61, 0xd4, 0x9e, 0x13, 0x5b, 0x72 } },
+    };
+
+    // Pipeline used by tests, with a description.
+    struct TestPipeline {
+        const wchar_t*  m_pDescription;     // Description of pipeline, used in reports.
+        std::wstring    m_EncodedElements;  // Pipeline elements, encoded like the settings application does.
+        size_t          m_NumOptimizedElements; // Number of elements left once pipeline is optimized.
+    };
+    typedef std::vector<TestPipeline> TestPipelineV;
+
+    //
+    // Pipeline element that counts the number of times it is asked to
+    // modify pipeline options. It also sets the paths separator so that
+    // options computed with it can be checked.
+    //
+    class CountingOptionsPipelineElement final : public PCC::PipelineElement
+    {
+    public:
+        void            ModifyOptions(PCC::PipelineOptions& p_rOptions) const override
+        {
+            ++m_NumCalls;
+            p_rOptions.SetPathsSeparator(L"|");
+        }
+
+        size_t          GetNumCalls() const noexcept
+        {
+            return m_NumCalls;
+        }
+
+    private:
+        mutable size_t  m_NumCalls = 0;     // Number of calls to ModifyOptions.
+    };
+
+    //
+    // Pipeline element that records the stack it was last called with,
+    // without modifying the path. Used to find out whether a nested
+    // pipeline was inlined in its parent's program, in which case both
+    // run with the same stack.
+    //
+    class StackRecordingPipelineElement final : public PCC::PipelineElement
+    {
+    public:
+        void            ModifyPath(std::wstring& /*p_rPath*/,
+                                   PCC::PipelineStack& p_rStack,
+                                   const PCC::PluginProvider* /*p_pPluginProvider*/) const override
+        {
+            m_pLastStack = &p_rStack;
+        }
+
+        const PCC::PipelineStack*
+                        GetLastStack() const noexcept
+        {
+            return m_pLastStack;
+        }
+
+    private:
+        mutable const PCC::PipelineStack*
+                        m_pLastStack = nullptr; // Stack passed to the last call to ModifyPath.
+    };
+    typedef std::shared_ptr<StackRecordingPipelineElement> StackRecordingPipelineElementSP;
+
+    //
+    // Encodes an integer value like the settings application does.
+    //
+    // @param p_Value Value to encode.
+    // @return Encoded value.
+    //
+    std::wstring EncodeLong(const long p_Value)
+    {
+        std::wostringstream wos;
+        wos << std::setw(4) << std::setfill(L'0') << p_Value;
+        return wos.str();
+    }
+
+    //
+    // Encodes a string value like the settings application does.
+    //
+    // @param p_Value Value to encode.
+    // @return Encoded value.
+    //
+    std::wstring EncodeString(const std::wstring_view p_Value)
+    {
+        return EncodeLong(static_cast<long>(p_Value.size())) + std::wstring(p_Value);
+    }
+
+    //
+    // Writes a prefix map table file like users would.
+    //
+    // @param p_FilePath Path of file to write.
+    // @param p_Content Content of file, one "prefix<TAB>replacement" entry per line.
+    //
+    void WritePrefixMapFile(const std::filesystem::path& p_FilePath,
+                            const std::string_view p_Content)
+    {
+        std::ofstream file(p_FilePath, std::ios::out | std::ios::binary | std::ios::trunc);
+        file.write(p_Content.data(), static_cast<std::streamsize>(p_Content.size()));
+    }
+
+    //
+    // Returns the pipelines used by tests and benchmarks. They use elements
+    // that are compiled into specific instructions as well as elements that
+    // are called directly, with or without the stack. Each rewrite rule of
+    // PipelineOptimizer is triggered by at least one pipeline.
+    //
+    // @return Test pipelines.
+    //
+    const TestPipelineV& GetTestPipelines()
+    {
+        static const TestPipelineV s_vPipelines = {
+            {
+                L"Find/replace, remove extension, slashes, quotes",
+                L"04" L"?" + EncodeString(L"Users") + EncodeString(L"home") + L"." L"\\" L"\"",
+                4,
+            },
+            {
+                L"Push, regex, pop at end",
+                L"03" L"u" + EncodeLong(1)
+                    + L"^" + EncodeLong(1) + EncodeString(L"\\\\") + EncodeString(L"/") + L"1"
+                    + L"o" + EncodeLong(5),
+                3,
+            },
+            {
+                L"Copy first parts, email links",
+                L"02" L"n" + EncodeLong(3) + L"1" + L"<",
+                2,
+            },
+            {
+                L"Remove extension, consecutive slash conversions",
+                L"04" L"." L"/" L"\\" L"/",
+                2,
+            },
+            {
+                L"Remove extension, push fixed string, pop at start",
+                L"03" L"." L"u" + EncodeLong(4) + EncodeString(L"file:///") + L"o" + EncodeLong(4),
+                2,
+            },
+            {
+                L"Remove extension, push fixed string, pop at end",
+                L"03" L"." L"u" + EncodeLong(4) + EncodeString(L";") + L"o" + EncodeLong(5),
+                2,
+            },
+            {
+                L"Push fixed string, pop entire path, then pure elements",
+                L"05" L"u" + EncodeLong(4) + EncodeString(L"C:\\Fixed Path\\file.txt") + L"o" + EncodeLong(1)
+                    + L"." L"\\" L"q",
+                1,
+            },
+            {
+                L"Pure elements, then push fixed string, pop entire path",
+                L"04" L"?" + EncodeString(L"Users") + EncodeString(L"home") + L"\\"
+                    + L"u" + EncodeLong(4) + EncodeString(L"fixed") + L"o" + EncodeLong(1),
+                1,
+            },
+            {
+                L"Push path, push fixed string, pop entire path, pop at end",
+                L"04" L"u" + EncodeLong(1) + L"u" + EncodeLong(4) + EncodeString(L"fixed:")
+                    + L"o" + EncodeLong(1) + L"o" + EncodeLong(5),
+                3,
+            },
+            {
+                L"Remove extension, push path, pop nowhere",
+                L"03" L"." L"u" + EncodeLong(1) + L"o" + EncodeLong(6),
+                1,
+            },
+            {
+                L"Push path, duplicate, pop nowhere, pop at end",
+                L"04" L"u" + EncodeLong(1) + L"d" L"o" + EncodeLong(6) + L"o" + EncodeLong(5),
+                2,
+            },
+            {
+                L"Push path, push fixed string, swap twice, pop at start, pop nowhere",
+                L"06" L"u" + EncodeLong(1) + L"u" + EncodeLong(4) + EncodeString(L"prefix:")
+                    + L"w" L"w" L"o" + EncodeLong(4) + L"o" + EncodeLong(6),
+                3,
+            },
+            {
+                L"Optional quotes twice, quotes, email links",
+                L"04" L"q" L"q" L"\"" L"<",
+                2,
+            },
+            {
+                L"Remove extension, email links, quotes, optional quotes",
+                L"04" L"." L"<" L"\"" L"q",
+                3,
+            },
+            {
+                L"Push space, pop at start, optional quotes",
+                L"03" L"u" + EncodeLong(4) + EncodeString(L" ") + L"o" + EncodeLong(4) + L"q",
+                1,
+            },
+        };
+        return s_vPipelines;
+    }
+
+    //
+    // Creates three nested pipeline plugins, each applying the next one.
+    // Nested plugins use the stack: they push values that they pop after
+    // applying the next plugin, try to pop values that they did not push
+    // and leave values on the stack, so that results differ if a nested
+    // pipeline can access the values of its parent.
+    //
+    // @param p_rsspPlugins Set where to add plugins.
+    // @param p_rvspRecorders Where to store the element recording the stack
+    //                        used by each plugin, from outermost to innermost.
+    // @return Outermost plugin.
+    //
+    PCC::PluginSP MakeNestedPipelinePlugins(PCC::PluginSPS& p_rsspPlugins,
+                                            std::vector<StackRecordingPipelineElementSP>& p_rvspRecorders)
+    {
+        p_rvspRecorders.clear();
+        for (size_t i = 0; i < std::size(NESTED_PLUGIN_IDS); ++i) {
+            p_rvspRecorders.emplace_back(std::make_shared<StackRecordingPipelineElement>());
+        }
+
+        const PCC::PipelineElementSPV vspOuterElements = {
+            p_rvspRecorders[0],
+            std::make_shared<PCC::PushToStackPipelineElement>(L"A:"),
+            std::make_shared<PCC::ApplyPipelinePluginPipelineElement>(NESTED_PLUGIN_IDS[1]),
+            std::make_shared<PCC::PopFromStackPipelineElement>(PCC::PopFromStackLocation::Start),
+            std::make_shared<PCC::QuotesPipelineElement>(),
+        };
+        const PCC::PipelineElementSPV vspMiddleElements = {
+            p_rvspRecorders[1],
+            std::make_shared<PCC::PushToStackPipelineElement>(),
+            std::make_shared<PCC::PushToStackPipelineElement>(L"B|"),
+            std::make_shared<PCC::ApplyPipelinePluginPipelineElement>(NESTED_PLUGIN_IDS[2]),
+            std::make_shared<PCC::PopFromStackPipelineElement>(PCC::PopFromStackLocation::Start),
+            std::make_shared<PCC::PopFromStackPipelineElement>(PCC::PopFromStackLocation::End),
+        };
+        const PCC::PipelineElementSPV vspInnerElements = {
+            p_rvspRecorders[2],
+            std::make_shared<PCC::PopFromStackPipelineElement>(PCC::PopFromStackLocation::End),
+            std::make_shared<PCC::PushToStackPipelineElement>(),
+            std::make_shared<PCC::BackToForwardSlashesPipelineElement>(),
+            std::make_shared<PCC::PopFromStackPipelineElement>(PCC::PopFromStackLocation::End),
+            std::make_shared<PCC::PushToStackPipelineElement>(L"[^\\\\/]+$", false, 0),
+        };
+
+        const PCC::PluginSP spOuterPlugin = std::make_shared<PCC::Plugins::PipelinePlugin>(
+            NESTED_PLUGIN_IDS[0], L"Outer", std::make_shared<PCC::Pipeline>(vspOuterElements));
+        p_rsspPlugins.emplace(spOuterPlugin);
+        p_rsspPlugins.emplace(std::make_shared<PCC::Plugins::PipelinePlugin>(
+            NESTED_PLUGIN_IDS[1], L"Middle", std::make_shared<PCC::Pipeline>(vspMiddleElements)));
+        p_rsspPlugins.emplace(std::make_shared<PCC::Plugins::PipelinePlugin>(
+            NESTED_PLUGIN_IDS[2], L"Inner", std::make_shared<PCC::Pipeline>(vspInnerElements)));
+        return spOuterPlugin;
+    }
+
+    //
+    // Returns paths used by tests: a corpus of realistic paths followed by edge cases.
+    //
+    // @return Test paths.
+    //
+    PCC::WStringV GetTestPaths()
+    {
+        PCC::WStringV vPaths = PCC::Tests::TestPaths::MakeCorpus(500);
+        const auto& vEdgeCases = PCC::Tests::TestPaths::EdgeCases();
+        vPaths.insert(vPaths.end(), vEdgeCases.cbegin(), vEdgeCases.cend());
+        return vPaths;
+    }
+
+} // anonymous namespace
+
+namespace PCC
+{
+    namespace Tests
+    {
+        //
+        // Tests that getting the paths of a batch of files with a pipeline
+        // plugin returns the same paths as getting them one by one.
+        //
+        // @param p_rContext Context used to perform checks.
+        //
+        void TestPipelineGetPaths(TestContext& p_rContext)
+        {
+            const WStringV vPaths = GetTestPaths();
+            for (const auto& pipeline : GetTestPipelines()) {
+                const Plugins::PipelinePlugin plugin(TEST_PLUGIN_ID, pipeline.m_pDescription,
+                                                     L"", false, pipeline.m_EncodedElements);
+                p_rContext.Check(plugin.GetPipeline() != nullptr,
+                                 std::wstring(L"Pipeline is valid: ") + pipeline.m_pDescription);
+
+                WStringV vBatch(vPaths);
+                plugin.GetPaths(gsl::make_span(vBatch));
+                for (size_t i = 0; i < vPaths.size(); ++i) {
+                    p_rContext.CheckEqual(plugin.GetPath(vPaths[i]), vBatch[i],
+                                          std::wstring(pipeline.m_pDescription) + L": " + vPaths[i]);
+                }
+            }
+        }
+
+        //
+        // Tests that a pipeline plugin computes its pipeline options once,
+        // no matter how many of its methods that depend on them are called.
+        //
+        // @param p_rContext Context used to perform checks.
+        //
+        void TestPipelinePluginOptions(TestContext& p_rContext)
+        {
+            const auto spCountingElement = std::make_shared<CountingOptionsPipelineElement>();
+            const auto spPipeline = std::make_shared<Pipeline>(PipelineElementSPV { spCountingElement });
+            const Plugins::PipelinePlugin plugin(TEST_PLUGIN_ID, L"Options", spPipeline);
+            for (int i = 0; i < 10; ++i) {
+                p_rContext.CheckEqual(std::wstring(L"|"), plugin.PathsSeparator(), L"Paths separator");
+                p_rContext.Check(!plugin.CopyPathsRecursively(), L"Copy paths recursively");
+                p_rContext.Check(plugin.ShowForFiles(), L"Show for files");
+                p_rContext.Check(plugin.ShowForFolders(), L"Show for folders");
+                p_rContext.Check(plugin.Action() != nullptr, L"Action");
+                p_rContext.CheckEqual(std::wstring(L"C:\\file.txt"), plugin.GetPath(L"C:\\file.txt"), L"Path");
+            }
+            p_rContext.CheckEqual(size_t(1), spCountingElement->GetNumCalls(), L"Number of calls to ModifyOptions");
+        }
+
+        //
+        // Tests that a pipeline using a prefix map stored in a file sees
+        // changes made to the file, even if the decoded pipeline is cached.
+        //
+        // @param p_rContext Context used to perform checks.
+        //
+        void TestPipelinePrefixMapFile(TestContext& p_rContext)
+        {
+            const auto filePath = std::filesystem::temp_directory_path() / L"PathCopyCopyTests_PrefixMap.txt";
+            auto removeFile = gsl::finally([&]() noexcept {
+                std::error_code errorCode;
+                std::filesystem::remove(filePath, errorCode);
+            });
+            const std::wstring encodedElements = L"01" L"p" + EncodeLong(1) + L"1" + EncodeString(filePath.wstring());
+
+            WritePrefixMapFile(filePath, "C:\\Old\\\tD:\\First\\\r\n");
+            {
+                const Plugins::PipelinePlugin plugin(TEST_PLUGIN_ID, L"Prefix map", L"", false, encodedElements);
+                p_rContext.CheckEqual(std::wstring(L"D:\\First\\file.txt"), plugin.GetPath(L"C:\\Old\\file.txt"),
+                                      L"Path with initial table");
+            }
+
+            // Make sure the write time changes, even on file systems with a coarse resolution.
+            const auto initialWriteTime = std::filesystem::last_write_time(filePath);
+            WritePrefixMapFile(filePath, "C:\\Old\\\tD:\\Second\\\r\n");
+            std::filesystem::last_write_time(filePath, initialWriteTime + std::chrono::hours(1));
+            {
+                const Plugins::PipelinePlugin plugin(TEST_PLUGIN_ID, L"Prefix map", L"", false, encodedElements);
+                p_rContext.CheckEqual(std::wstring(L"D:\\Second\\file.txt"), plugin.GetPath(L"C:\\Old\\file.txt"),
+                                      L"Path with modified table");
+            }
+        }
+
+        //
+        // Tests that elements looking at the structure of the path see
+        // the current path, even when the previous instruction modified it
+        // in-place without changing its size (the structure is cached
+        // during a pipeline run). Results are compared with those of
+        // elements called without a stack, which parse the path each time.
+        //
+        // @param p_rContext Context used to perform checks.
+        //
+        void TestPipelinePathViewCache(TestContext& p_rContext)
+        {
+            const std::vector<std::pair<const wchar_t*, PipelineElementSPV>> vPipelines = {
+                {
+                    L"Remove extension, slashes, copy last parts",
+                    {
+                        std::make_shared<RemoveFileExtPipelineElement>(),
+                        std::make_shared<BackToForwardSlashesPipelineElement>(),
+                        std::make_shared<CopyNPathPartsPipelineElement>(2, false),
+                    },
+                },
+                {
+                    L"Remove extension, find/replace of same size, remove extension",
+                    {
+                        std::make_shared<RemoveFileExtPipelineElement>(),
+                        std::make_shared<FindReplacePipelineElement>(L"\\", L"."),
+                        std::make_shared<RemoveFileExtPipelineElement>(),
+                    },
+                },
+            };
+
+            const WStringV vPaths = GetTestPaths();
+            for (const auto& pipeline : vPipelines) {
+                const Pipeline optimizedPipeline(pipeline.second);
+                for (const auto& path : vPaths) {
+                    std::wstring expected(path);
+                    for (const auto& spElement : pipeline.second) {
+                        spElement->ModifyPath(expected, nullptr);
+                    }
+                    std::wstring actual(path);
+                    optimizedPipeline.ModifyPath(actual, nullptr);
+                    p_rContext.CheckEqual(expected, actual, std::wstring(pipeline.first) + L": " + path);
+                }
+            }
+        }
+
+        //
+        // Tests that the optimizer applies its rewrite rules to the test
+        // pipelines by checking the number of elements left in each.
+        // Whether optimized pipelines still return the same paths is
+        // checked by TestPipelineVerification.
+        //
+        // @param p_rContext Context used to perform checks.
+        //
+        void TestPipelineOptimizer(TestContext& p_rContext)
+        {
+            for (const auto& pipeline : GetTestPipelines()) {
+                const auto vspElements = PipelineDecoder::DecodePipeline(pipeline.m_EncodedElements);
+                p_rContext.CheckEqual(pipeline.m_NumOptimizedElements, PipelineOptimizer::Optimize(vspElements).size(),
+                                      std::wstring(pipeline.m_pDescription) + L": number of optimized elements");
+            }
+        }
+
+        //
+        // Tests that optimized pipelines return the same paths as calling
+        // their elements directly, using the pipeline's verification mode.
+        // The test pipelines trigger all rewrite rules of the optimizer.
+        //
+        // @param p_rContext Context used to perform checks.
+        //
+        void TestPipelineVerification(TestContext& p_rContext)
+        {
+            const bool previousMode = Pipeline::GetVerificationMode();
+            Pipeline::SetVerificationMode(true);
+            auto restoreMode = gsl::finally([&]() noexcept {
+                Pipeline::SetVerificationMode(previousMode);
+            });
+
+            const WStringV vPaths = GetTestPaths();
+            for (const auto& pipeline : GetTestPipelines()) {
+                const Plugins::PipelinePlugin plugin(TEST_PLUGIN_ID, pipeline.m_pDescription,
+                                                     L"", false, pipeline.m_EncodedElements);
+                const uint64_t failuresBefore = Pipeline::GetNumVerificationFailures();
+                WStringV vResults(vPaths);
+                plugin.GetPaths(gsl::make_span(vResults));
+                p_rContext.CheckEqual(uint64_t(0), Pipeline::GetNumVerificationFailures() - failuresBefore,
+                                      std::wstring(pipeline.m_pDescription) + L": verification failures");
+            }
+        }
+
+        //
+        // Tests that pipeline plugins applied by a pipeline are inlined in
+        // its program when bound, with three levels of nesting. Each nested
+        // pipeline must run in its own stack frame: it cannot see values
+        // pushed by its parent and values it leaves on the stack are dropped.
+        // If the innermost plugin is bound to another provider, it cannot
+        // be inlined and must be applied through the plugin instead.
+        // Results are compared with calling elements directly using
+        // the pipeline's verification mode.
+        //
+        // @param p_rContext Context used to perform checks.
+        //
+        void TestPipelineInlining(TestContext& p_rContext)
+        {
+            const bool previousMode = Pipeline::GetVerificationMode();
+            auto restoreMode = gsl::finally([&]() noexcept {
+                Pipeline::SetVerificationMode(previousMode);
+            });
+
+            const WStringV vPaths = GetTestPaths();
+            for (const bool innerOnOtherProvider : { false, true }) {
+                const std::wstring what(innerOnOtherProvider ? L"Inner plugin bound to another provider" : L"All plugins inlined");
+                PluginSPS sspPlugins;
+                std::vector<StackRecordingPipelineElementSP> vspRecorders;
+                const PluginSP spOuterPlugin = MakeNestedPipelinePlugins(sspPlugins, vspRecorders);
+                const AllPluginsProvider pluginProvider(sspPlugins);
+                const AllPluginsProvider otherPluginProvider(sspPlugins);
+                for (const auto& spPlugin : sspPlugins) {
+                    const bool useOtherProvider = innerOnOtherProvider && ::IsEqualGUID(spPlugin->Id(), NESTED_PLUGIN_IDS[2]) != FALSE;
+                    spPlugin->SetPluginProvider(useOtherProvider ? &otherPluginProvider : &pluginProvider);
+                }
+
+                Pipeline::SetVerificationMode(false);
+                p_rContext.CheckEqual(std::wstring(L"\"A:B|C:/folder/file.txtC:\\folder\\file.txtC:\\folder\\file.txt\""),
+                                      spOuterPlugin->GetPath(L"C:\\folder\\file.txt"), what + L": path");
+                p_rContext.Check(vspRecorders[1]->GetLastStack() == vspRecorders[0]->GetLastStack(),
+                                 what + L": middle plugin inlined");
+                p_rContext.CheckEqual(!innerOnOtherProvider, vspRecorders[2]->GetLastStack() == vspRecorders[0]->GetLastStack(),
+                                      what + L": inner plugin inlined");
+
+                Pipeline::SetVerificationMode(true);
+                const uint64_t failuresBefore = Pipeline::GetNumVerificationFailures();
+                WStringV vResults(vPaths);
+                spOuterPlugin->GetPaths(gsl::make_span(vResults));
+                p_rContext.CheckEqual(uint64_t(0), Pipeline::GetNumVerificationFailures() - failuresBefore,
+                                      what + L": verification failures");
+            }
+        }
+
+        //
+        // Measures the number of paths per second computed by pipeline
+        // plugins when paths are fetched one by one with GetPath and
+        // when they are fetched in a batch with GetPaths.
+        //
+        // @param p_rContext Context used to measure code.
+        //
+        void BenchmarkPipelineGetPaths(TestContext& p_rContext)
+        {
+            const WStringV vPaths = TestPaths::MakeCorpus(1000);
+
+            for (const auto& pipeline : GetTestPipelines()) {
+                const Plugins::PipelinePlugin plugin(TEST_PLUGIN_ID, pipeline.m_pDescription,
+                                                     L"", false, pipeline.m_EncodedElements);
+                WStringV vResults(vPaths.size());
+                p_rContext.Measure(std::wstring(pipeline.m_pDescription) + L" / GetPath loop", vPaths.size(), [&]() {
+                    for (size_t i = 0; i < vPaths.size(); ++i) {
+                        vResults[i] = plugin.GetPath(vPaths[i]);
+                    }
+                });
+                p_rContext.Measure(std::wstring(pipeline.m_pDescription) + L" / GetPaths", vPaths.size(), [&]() {
+                    vResults = vPaths;
+                    plugin.GetPaths(gsl::make_span(vResults));
+                });
+            }
+        }
+
+    } // namespace Tests
+
+} // namespace PCC
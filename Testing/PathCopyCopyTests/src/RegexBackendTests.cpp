@@ -0,0 +1,98 @@
+// RegexBackendTests.cpp
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdafx.h>
+#include <RegexBackendTests.h>
+#include <RegexBackend.h>
+#include <TestContext.h>
+#include <TestPaths.h>
+
+
+namespace
+{
+    // Regexes searched in test paths, with and without ignoring case.
+    const wchar_t* const    TEST_REGEXES[] = {
+        L"^([A-Za-z]):\\\\(.*)$",
+        L"\\.([^.\\\\]+)$",
+        L"(x)|(\\\\)",
+        L"^(\\\\\\\\)?([^\\\\]*)\\\\?(\\w+)?",
+        L"(a*)(b)?",
+        L"",
+    };
+
+    // Format strings used to compare replacements.
+    const wchar_t* const    REPLACE_FORMATS[] = {
+        L"[$&]", L"$1-$2", L"$`|$'", L"$$x$0", L"<$3>",
+    };
+
+} // anonymous namespace
+
+namespace PCC
+{
+    namespace Tests
+    {
+        //
+        // Tests that StdRegexBackend reports the same matches and
+        // replacements as using std::regex directly, including the
+        // position of groups that did not participate in a match.
+        //
+        // @param p_rContext Context used to perform checks.
+        //
+        void TestRegexBackendSearch(TestContext& p_rContext)
+        {
+            const auto& vPaths = TestPaths::EdgeCases();
+            for (const wchar_t* const pRegex : TEST_REGEXES) {
+                for (const bool ignoreCase : { false, true }) {
+                    const auto upBackend = RegexBackend::Create(pRegex, ignoreCase);
+                    const std::wregex regex(pRegex, ignoreCase ? std::regex_constants::ECMAScript | std::regex_constants::icase
+                                                               : std::regex_constants::ECMAScript);
+                    for (const auto& path : vPaths) {
+                        const std::wstring description = TestPaths::Describe(pRegex) + (ignoreCase ? L" (icase)" : L"")
+                                                       + L" in " + TestPaths::Describe(path);
+
+                        std::wsmatch expectedMatch;
+                        RegexMatch actualMatch;
+                        const bool found = std::regex_search(path, expectedMatch, regex);
+                        p_rContext.CheckEqual(found, upBackend->Search(path, actualMatch), L"Search of " + description);
+                        for (size_t group = 0; found && group < expectedMatch.size(); ++group) {
+                            const bool matched = expectedMatch[group].matched;
+                            p_rContext.CheckEqual(matched, actualMatch.Matched(group), L"Group matched in " + description);
+                            p_rContext.CheckEqual(matched ? static_cast<size_t>(expectedMatch.position(group)) : 0,
+                                                  actualMatch.Position(group), L"Group position in " + description);
+                            p_rContext.CheckEqual(matched ? static_cast<size_t>(expectedMatch.length(group)) : 0,
+                                                  actualMatch.Length(group), L"Group length in " + description);
+                        }
+                        p_rContext.Check(!actualMatch.Matched(found ? expectedMatch.size() : 0),
+                                         L"No extra group in " + description);
+
+                        for (const wchar_t* const pFormat : REPLACE_FORMATS) {
+                            p_rContext.CheckEqual(TestPaths::Describe(std::regex_replace(path, regex, pFormat)),
+                                                  TestPaths::Describe(upBackend->Replace(path, pFormat)),
+                                                  L"Replace with " + TestPaths::Describe(pFormat) + L" of " + description);
+                        }
+                    }
+                }
+            }
+        }
+
+    } // namespace Tests
+
+} // namespace PCC
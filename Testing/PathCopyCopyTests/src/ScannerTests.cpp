@@ -0,0 +1,232 @@
+// ScannerTests.cpp
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdafx.h>
+#include <ScannerTests.h>
+#include <LaunchExecutablePathAction.h>
+#include <PluginPipelineElements.h>
+#include <PluginUtils.h>
+#include <TestContext.h>
+#include <TestPaths.h>
+
+#include <regex>
+#include <string_view>
+
+
+namespace
+{
+    // Maximum number of fragments concatenated to generate strings.
+    constexpr size_t    MAX_FRAGMENTS           = 4;
+
+    // Fragments used to generate paths for RemoveFileExtPipelineElement.
+    const std::wstring_view REMOVE_FILE_EXT_FRAGMENTS[] = {
+        L"C:", L"\\", L"/", L".", L"..", L"a", L"ext", L" ", L"\r", L"\n", L"\u2028", L"\u2029",
+    };
+
+    // Fragments used to generate paths for PluginUtils::GetHiddenDriveShareFilePath.
+    const std::wstring_view HIDDEN_DRIVE_SHARE_FRAGMENTS[] = {
+        L"C", L"z", L"1", L"\u00C9", L":", L"\\", L"/", L"\\\\", L".", L"a", L"\r", L"\n", L"\u2028", L"\u2029",
+    };
+
+    // Fragments used to generate arguments for LaunchExecutablePathAction.
+    const std::wstring_view FILES_PLACEHOLDER_FRAGMENTS[] = {
+        L"%FILES%", L"%files%", L"%FiLeS%", L"%FILE", L"S%", L"%", L" ", L"-a", L"\n", L"\u2028",
+        L"\u017F", L"\u0131", L"\u212A",
+    };
+
+    // Files inserted in arguments by tests.
+    const wchar_t* const    FILES_PLACEHOLDER_FILES = L"\"C:\\folder\\file.txt\" $1 $& %FILES%";
+
+    //
+    // Reference implementation of RemoveFileExtPipelineElement::ModifyPath:
+    // the regex it used before it was replaced by a scanner.
+    //
+    // @param p_Path Path to modify.
+    // @return Path without its extension.
+    //
+    std::wstring OriginalRemoveFileExt(const std::wstring& p_Path)
+    {
+        static const std::wregex s_ExtRegex(L"^(.*[^\\\\/])(?:\\.[^\\\\/.]+)$", std::regex_constants::ECMAScript);
+        return std::regex_replace(p_Path, s_ExtRegex, L"$1");
+    }
+
+    //
+    // Reference implementation of PluginUtils::GetHiddenDriveShareFilePath:
+    // the regex it used before it was replaced by a scanner.
+    //
+    // @param p_rFilePath Path to convert (in-place).
+    // @return true if path was converted.
+    //
+    bool OriginalGetHiddenDriveShareFilePath(std::wstring& p_rFilePath)
+    {
+        static const std::wregex s_HiddenDriveShareRegex(L"^([A-Za-z])\\:((\\\\|/).*)$", std::regex_constants::ECMAScript);
+        const std::wstring replaced = std::regex_replace(p_rFilePath, s_HiddenDriveShareRegex, L"$1$$$2");
+        if (replaced.empty()) {
+            return false;
+        }
+        p_rFilePath = L"\\\\" + PCC::PluginUtils::GetLocalComputerName() + L"\\" + replaced;
+        return true;
+    }
+
+    //
+    // Reference implementation of LaunchExecutablePathAction::InsertFilesInArguments:
+    // the regex it used before it was replaced by a scanner.
+    //
+    // @param p_Arguments Arguments to pass to the executable.
+    // @param p_Files Files to insert.
+    // @return Arguments containing the files.
+    //
+    std::wstring OriginalInsertFilesInArguments(const std::wstring& p_Arguments,
+                                                const std::wstring& p_Files)
+    {
+        static const std::wregex s_PlaceholderRegex(L"%FILES%", std::regex_constants::ECMAScript | std::regex_constants::icase);
+        std::wsmatch match;
+        if (std::regex_search(p_Arguments, match, s_PlaceholderRegex)) {
+            return match.prefix().str() + p_Files + match.suffix().str();
+        }
+        auto arguments{p_Arguments};
+        if (arguments.empty() || arguments.back() != L' ') {
+            arguments += L' ';
+        }
+        return arguments + p_Files;
+    }
+
+    //
+    // Generates strings used to compare a scanner with the regex it replaced:
+    // every combination of up to MAX_FRAGMENTS fragments, followed by the
+    // edge cases and a corpus of realistic paths.
+    //
+    // @param p_Fragments Fragments to combine.
+    // @return Generated strings.
+    //
+    template<size_t N>
+    PCC::WStringV GenerateStrings(const std::wstring_view (&p_Fragments)[N])
+    {
+        PCC::WStringV vStrings = { std::wstring() };
+        size_t prevLevelBegin = 0;
+        for (size_t numFragments = 1; numFragments <= MAX_FRAGMENTS; ++numFragments) {
+            const size_t prevLevelEnd = vStrings.size();
+            for (size_t i = prevLevelBegin; i < prevLevelEnd; ++i) {
+                for (const auto& fragment : p_Fragments) {
+                    vStrings.emplace_back(vStrings[i]).append(fragment);
+                }
+            }
+            prevLevelBegin = prevLevelEnd;
+        }
+
+        const auto& vEdgeCases = PCC::Tests::TestPaths::EdgeCases();
+        vStrings.insert(vStrings.end(), vEdgeCases.cbegin(), vEdgeCases.cend());
+        const auto vCorpus = PCC::Tests::TestPaths::MakeCorpus(500);
+        vStrings.insert(vStrings.end(), vCorpus.cbegin(), vCorpus.cend());
+        return vStrings;
+    }
+
+    //
+    // Compares the result of a scanner with the result of the regex it replaced
+    // for a string. Only mismatches are reported with the string, to keep
+    // the report short.
+    //
+    // @param p_rContext Context used to perform checks.
+    // @param p_pWhat Name of code tested.
+    // @param p_String String that was processed.
+    // @param p_Expected Result of the regex.
+    // @param p_Actual Result of the scanner.
+    //
+    void CheckScanner(PCC::Tests::TestContext& p_rContext,
+                      const wchar_t* const p_pWhat,
+                      const std::wstring& p_String,
+                      const std::wstring& p_Expected,
+                      const std::wstring& p_Actual)
+    {
+        if (p_Actual == p_Expected) {
+            p_rContext.Check(true, p_pWhat);
+        } else {
+            p_rContext.CheckEqual(PCC::Tests::TestPaths::Describe(p_Expected), PCC::Tests::TestPaths::Describe(p_Actual),
+                                  std::wstring(p_pWhat) + L" of " + PCC::Tests::TestPaths::Describe(p_String));
+        }
+    }
+
+} // anonymous namespace
+
+namespace PCC
+{
+    namespace Tests
+    {
+        //
+        // Tests that RemoveFileExtPipelineElement removes extensions like
+        // the regex it used before, including for dotfiles, paths ending
+        // with a dot and paths containing line terminators.
+        //
+        // @param p_rContext Context used to perform checks.
+        //
+        void TestScannersRemoveFileExt(TestContext& p_rContext)
+        {
+            const RemoveFileExtPipelineElement element;
+            for (const auto& path : GenerateStrings(REMOVE_FILE_EXT_FRAGMENTS)) {
+                std::wstring actual(path);
+                element.ModifyPath(actual, nullptr);
+                CheckScanner(p_rContext, L"RemoveFileExt", path, OriginalRemoveFileExt(path), actual);
+            }
+        }
+
+        //
+        // Tests that PluginUtils::GetHiddenDriveShareFilePath converts paths
+        // like the regex it used before, including for drives without a
+        // separator ("C:") and paths containing line terminators.
+        //
+        // @param p_rContext Context used to perform checks.
+        //
+        void TestScannersHiddenDriveShare(TestContext& p_rContext)
+        {
+            for (const auto& path : GenerateStrings(HIDDEN_DRIVE_SHARE_FRAGMENTS)) {
+                std::wstring expected(path);
+                const bool expectedConverted = OriginalGetHiddenDriveShareFilePath(expected);
+                std::wstring actual(path);
+                const bool actualConverted = PluginUtils::GetHiddenDriveShareFilePath(actual);
+                CheckScanner(p_rContext, L"GetHiddenDriveShareFilePath", path, expected, actual);
+                if (actualConverted != expectedConverted) {
+                    p_rContext.CheckEqual(expectedConverted, actualConverted,
+                                          L"GetHiddenDriveShareFilePath result for " + TestPaths::Describe(path));
+                }
+            }
+        }
+
+        //
+        // Tests that LaunchExecutablePathAction inserts files in arguments
+        // like the regex it used before, including when the placeholder's
+        // case differs or when arguments contain non-ASCII letters that
+        // have ASCII case variants.
+        //
+        // @param p_rContext Context used to perform checks.
+        //
+        void TestScannersFilesPlaceholder(TestContext& p_rContext)
+        {
+            const std::wstring files(FILES_PLACEHOLDER_FILES);
+            for (const auto& arguments : GenerateStrings(FILES_PLACEHOLDER_FRAGMENTS)) {
+                CheckScanner(p_rContext, L"InsertFilesInArguments", arguments,
+                             OriginalInsertFilesInArguments(arguments, files),
+                             Actions::LaunchExecutablePathAction::InsertFilesInArguments(arguments, files));
+            }
+        }
+
+    } // namespace Tests
+
+} // namespace PCC
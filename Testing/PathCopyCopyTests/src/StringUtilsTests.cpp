@@ -0,0 +1,624 @@
+// StringUtilsTests.cpp
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdafx.h>
+#include <StringUtilsTests.h>
+#include <StringUtils.h>
+#include <TestContext.h>
+#include <TestPaths.h>
+
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+
+namespace
+{
+    using SimdLevel = StringUtils::SimdLevel;
+
+    // Instruction sets that can be tested, from worst to best.
+    const SimdLevel     SIMD_LEVELS[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 };
+
+    // Characters placed in generated strings to test kernels. Some of them share
+    // a low byte with ASCII characters looked for, or would be confused with
+    // ASCII characters if saturated or truncated while packing them to bytes.
+    const wchar_t       TRICKY_CHARS[] = {
+        L'\\', L'/', L':', L'%', L' ', L'\0', L'\x7F', L'\x80', L'\xFF', L'\x100',
+        L'\x15C', L'\x5C00', L'\x5C5C', L'\x2F2F', L'\x8080', L'\x2028', L'\xD83D', L'\xFFFF',
+    };
+
+    // Maximum length of generated strings. Long enough to cover a full
+    // 256-bit block, the tail after it and a second block.
+    constexpr size_t    MAX_GENERATED_LENGTH    = 40;
+
+    // Sets of characters looked for with FindFirstOf.
+    const std::wstring_view CHAR_SETS[] = {
+        L"\\",
+        L"\\/",
+        L"\\/:*?\"<>|",
+        L"\x15C",
+        std::wstring_view(L"\0", 1),
+    };
+
+    // Character classes looked for with FindFirstOf, with the ASCII characters
+    // they contain so that a reference implementation can be used.
+    struct TestCharClass {
+        std::wstring        m_ASCIIChars;       // ASCII characters in class.
+        bool                m_IncludeNonASCII;  // Whether non-ASCII characters are in class.
+        StringUtils::CharClass
+                            m_CharClass;        // Class to test.
+
+                            TestCharClass(const std::wstring& p_ASCIIChars,
+                                          const bool p_IncludeNonASCII)
+                                : m_ASCIIChars(p_ASCIIChars),
+                                  m_IncludeNonASCII(p_IncludeNonASCII),
+                                  m_CharClass(p_ASCIIChars, p_IncludeNonASCII)
+                            {
+                            }
+    };
+    typedef std::vector<TestCharClass> TestCharClassV;
+
+    // Pairs of characters replaced with ReplaceChar.
+    const std::pair<wchar_t, wchar_t> REPLACED_CHARS[] = {
+        { L'\\', L'/' },
+        { L'/', L'\\' },
+        { L'\x15C', L'/' },
+        { L'\\', L'\x2028' },
+        { L'\0', L'x' },
+    };
+
+    //
+    // Returns all ASCII control characters.
+    //
+    // @return String containing characters 0x00-0x1F and 0x7F.
+    //
+    std::wstring GetControlChars()
+    {
+        std::wstring controlChars;
+        for (wchar_t c = 0x00; c <= 0x1F; ++c) {
+            controlChars.push_back(c);
+        }
+        controlChars.push_back(L'\x7F');
+        return controlChars;
+    }
+
+    //
+    // Returns the character classes to test. Includes the classes used
+    // by StringUtils::EncodeURICharacters, as well as classes covering
+    // the edges of the ASCII range.
+    //
+    // @return Character classes.
+    //
+    const TestCharClassV& GetTestCharClasses()
+    {
+        static const TestCharClassV s_vClasses = {
+            { L"\\/", false },
+            { L"\\/", true },
+            { L"", true },
+            { GetControlChars() + L" ", false },
+            { GetControlChars() + L" <>#%\"{}|\\^[]`+", false },
+            { GetControlChars() + L" \"#%<>?[\\]^`{|}", true },
+            { L"\x01\x10\x20\x30\x40\x50\x60\x70\x7F", false },
+            { L"0123456789ABCDEFabcdef", false },
+        };
+        return s_vClasses;
+    }
+
+    //
+    // Returns the strings used to compare kernels: the edge cases, a corpus
+    // of paths, and generated strings with each tricky character at each
+    // position, so that the vector blocks and the scalar tail are covered.
+    //
+    // @return Strings to use in tests.
+    //
+    PCC::WStringV GetKernelTestStrings()
+    {
+        PCC::WStringV vStrings = PCC::Tests::TestPaths::EdgeCases();
+        const PCC::WStringV vCorpus = PCC::Tests::TestPaths::MakeCorpus(200);
+        vStrings.insert(vStrings.end(), vCorpus.cbegin(), vCorpus.cend());
+        for (size_t length = 1; length <= MAX_GENERATED_LENGTH; ++length) {
+            for (const wchar_t tricky : TRICKY_CHARS) {
+                for (size_t pos = 0; pos < length; ++pos) {
+                    std::wstring generated(length, L'a');
+                    generated[pos] = tricky;
+                    vStrings.push_back(std::move(generated));
+                }
+            }
+        }
+        return vStrings;
+    }
+
+    //
+    // Returns the name of an instruction set, for use in reports.
+    //
+    // @param p_Level Instruction set.
+    // @return Name of instruction set.
+    //
+    const wchar_t* GetSimdLevelName(const SimdLevel p_Level) noexcept
+    {
+        switch (p_Level) {
+            case SimdLevel::SSE2:   return L"SSE2";
+            case SimdLevel::AVX2:   return L"AVX2";
+            default:                return L"Scalar";
+        }
+    }
+
+    //
+    // Reference implementation of StringUtils::FindFirstOf for a character class.
+    //
+    // @param p_String String to scan.
+    // @param p_CharClass Class of characters to look for.
+    // @param p_Pos Position where to start looking.
+    // @return Position of first character found, or std::wstring_view::npos if none found.
+    //
+    size_t ReferenceFindFirstInClass(const std::wstring_view p_String,
+                                     const TestCharClass& p_CharClass,
+                                     const size_t p_Pos)
+    {
+        for (size_t i = p_Pos; i < p_String.size(); ++i) {
+            const wchar_t c = p_String[i];
+            if (c < 0x80 ? p_CharClass.m_ASCIIChars.find(c) != std::wstring::npos
+                         : p_CharClass.m_IncludeNonASCII) {
+                return i;
+            }
+        }
+        return std::wstring_view::npos;
+    }
+
+    //
+    // Compares the result of a kernel with the expected result and records
+    // a check. The failure message is only built if the check fails, since
+    // kernels are checked for many strings.
+    //
+    // @param p_rContext Test context.
+    // @param p_Expected Expected result.
+    // @param p_Actual Result of kernel.
+    // @param p_Level Instruction set used by kernel.
+    // @param p_Kernel Name of kernel.
+    // @param p_String String the kernel was called with.
+    // @param p_Pos Position where the kernel started.
+    //
+    template<typename T>
+    void CheckKernel(PCC::Tests::TestContext& p_rContext,
+                     const T& p_Expected,
+                     const T& p_Actual,
+                     const SimdLevel p_Level,
+                     const wchar_t* const p_pKernel,
+                     const std::wstring_view p_String,
+                     const size_t p_Pos)
+    {
+        if (p_Expected == p_Actual) {
+            p_rContext.Check(true, p_pKernel);
+        } else {
+            std::wostringstream wos;
+            wos << p_pKernel << L" (" << GetSimdLevelName(p_Level) << L") on " << PCC::Tests::TestPaths::Describe(p_String)
+                << L" from " << p_Pos;
+            p_rContext.CheckEqual(p_Expected, p_Actual, wos.str());
+        }
+    }
+
+    //
+    // Limits the instruction set used by StringUtils for the lifetime of the object.
+    //
+    class SimdLevelLimiter final
+    {
+    public:
+        explicit        SimdLevelLimiter(const SimdLevel p_MaxLevel) noexcept
+        {
+            StringUtils::SetMaxSimdLevel(p_MaxLevel);
+        }
+                        SimdLevelLimiter(const SimdLevelLimiter&) = delete;
+        SimdLevelLimiter&
+                        operator=(const SimdLevelLimiter&) = delete;
+                        ~SimdLevelLimiter()
+        {
+            StringUtils::SetMaxSimdLevel(SimdLevel::AVX2);
+        }
+    };
+
+    // Replacements tested with ReplaceAll: value to look for and replacement.
+    const std::pair<const wchar_t*, const wchar_t*> REPLACE_ALL_CASES[] = {
+        { L"\\", L"/" },
+        { L"\\", L"\\\\" },
+        { L"\\\\", L"\\" },
+        { L"a", L"" },
+        { L"aa", L"b" },
+        { L"Program Files", L"PF" },
+        { L"\\Program Files\\", L"\\Program Files (x86)\\" },
+        { L"..", L"." },
+        { L"%FILES%", L"\"C:\\folder\\file.txt\"" },
+        { L"\u4F1A\u8B70", L"Meeting" },
+        { L"\u015C\u4E5C", L"\\" },
+        { L"no such folder at all", L"x" },
+    };
+
+    //
+    // Implementation of StringUtils::ReplaceAll before it was changed to build
+    // its result in a single pass. Used as a reference in tests and benchmarks.
+    //
+    // @param p_rString String to modify (in-place).
+    // @param p_OldValue Old value to look for.
+    // @param p_NewValue Replacement value.
+    //
+    void OriginalReplaceAll(std::wstring& p_rString,
+                            const std::wstring& p_OldValue,
+                            const std::wstring& p_NewValue)
+    {
+        std::wstring::size_type pos = 0;
+        std::wstring::size_type from = 0;
+        do {
+            pos = p_rString.find(p_OldValue, from);
+            if (pos != std::wstring::npos) {
+                p_rString.replace(pos, p_OldValue.size(), p_NewValue);
+                from = pos + p_NewValue.size();
+            }
+        } while (pos != std::wstring::npos);
+    }
+
+    //
+    // Boyer-Moore-Horspool searcher using a shift table with one entry per
+    // possible UTF-16 code unit, instead of one per low byte like
+    // StringUtils::Searcher. Used by benchmarks to measure what the smaller
+    // table costs in shifts and saves in construction.
+    //
+    class FullTableSearcher final
+    {
+    public:
+        explicit        FullTableSearcher(std::wstring p_Pattern)
+                            : m_Pattern(std::move(p_Pattern)),
+                              m_vShifts(0x10000, m_Pattern.size())
+        {
+            const size_t patternSize = m_Pattern.size();
+            for (size_t i = 0; i + 1 < patternSize; ++i) {
+                m_vShifts[static_cast<uint16_t>(m_Pattern[i])] = patternSize - 1 - i;
+            }
+        }
+
+        size_t          Find(const std::wstring_view p_String,
+                             const size_t p_Pos = 0) const noexcept
+        {
+            const size_t patternSize = m_Pattern.size();
+            if (patternSize <= 1 || p_Pos >= p_String.size()) {
+                return p_String.find(m_Pattern, p_Pos);
+            }
+            if (p_String.size() < patternSize) {
+                return std::wstring_view::npos;
+            }
+            const wchar_t lastPatternChar = m_Pattern[patternSize - 1];
+            const size_t lastWindowPos = p_String.size() - patternSize;
+            for (size_t pos = p_Pos; pos <= lastWindowPos; ) {
+                const wchar_t lastChar = p_String[pos + patternSize - 1];
+                if (lastChar == lastPatternChar && p_String.compare(pos, patternSize - 1, m_Pattern, 0, patternSize - 1) == 0) {
+                    return pos;
+                }
+                pos += m_vShifts[static_cast<uint16_t>(lastChar)];
+            }
+            return std::wstring_view::npos;
+        }
+
+        const std::wstring&
+                        Pattern() const noexcept
+        {
+            return m_Pattern;
+        }
+
+    private:
+        std::wstring    m_Pattern;          // Pattern to look for.
+        std::vector<size_t>
+                        m_vShifts;          // Shift to use for each possible last character in window.
+    };
+
+    //
+    // Counts the instances of a pattern in a string using a searcher.
+    //
+    // @param p_Searcher Searcher to use; either a StringUtils::Searcher or a FullTableSearcher.
+    // @param p_String String to look into.
+    // @return Number of non-overlapping instances found.
+    //
+    template<typename Searcher>
+    size_t CountMatches(const Searcher& p_Searcher,
+                        const std::wstring_view p_String) noexcept
+    {
+        size_t count = 0;
+        const size_t patternSize = (std::max)(p_Searcher.Pattern().size(), size_t(1));
+        for (size_t pos = p_Searcher.Find(p_String); pos != std::wstring_view::npos; pos = p_Searcher.Find(p_String, pos + patternSize)) {
+            ++count;
+        }
+        return count;
+    }
+
+    //
+    // Produces a text of random CJK ideographs, with a pattern inserted at
+    // regular intervals. Ideographs from a 512-character block share low bytes
+    // in pairs, so a shift table keyed on the low byte gives smaller shifts.
+    //
+    // @param p_Size Size of text.
+    // @param p_Pattern Pattern to insert in text.
+    // @param p_Interval Number of characters between instances of pattern.
+    // @return Generated text.
+    //
+    std::wstring MakeCJKText(const size_t p_Size,
+                             const std::wstring_view p_Pattern,
+                             const size_t p_Interval)
+    {
+        std::mt19937 generator(42);
+        std::wstring text;
+        text.reserve(p_Size);
+        size_t sinceLastPattern = 0;
+        while (text.size() < p_Size) {
+            if (sinceLastPattern >= p_Interval && text.size() + p_Pattern.size() <= p_Size) {
+                text += p_Pattern;
+                sinceLastPattern = 0;
+            } else {
+                text.push_back(static_cast<wchar_t>(0x4E00 + (generator() % 0x200)));
+                ++sinceLastPattern;
+            }
+        }
+        return text;
+    }
+
+} // anonymous namespace
+
+namespace PCC
+{
+    namespace Tests
+    {
+        //
+        // Checks that the vectorized kernels used by StringUtils::ReplaceChar
+        // and StringUtils::FindFirstOf return the same results as reference
+        // scalar implementations, for each instruction set supported by the
+        // processor. Instruction sets that are not supported are skipped.
+        //
+        // @param p_rContext Test context.
+        //
+        void TestStringUtilsKernels(TestContext& p_rContext)
+        {
+            const WStringV vStrings = GetKernelTestStrings();
+
+            for (const SimdLevel level : SIMD_LEVELS) {
+                const SimdLevelLimiter limiter(level);
+                if (StringUtils::GetSimdLevel() != level) {
+                    continue;
+                }
+
+                for (const auto& str : vStrings) {
+                    for (const auto& replaced : REPLACED_CHARS) {
+                        std::wstring expected(str);
+                        std::replace(expected.begin(), expected.end(), replaced.first, replaced.second);
+                        std::wstring actual(str);
+                        StringUtils::ReplaceChar(actual, replaced.first, replaced.second);
+                        CheckKernel(p_rContext, expected, actual, level, L"ReplaceChar", str, 0);
+                    }
+
+                    // Look from the start and from each position near the end,
+                    // so that the start of the scanned range is not aligned.
+                    for (size_t pos = 0; pos <= str.size(); pos = (pos == 0 && str.size() > 20 ? str.size() - 20 : pos + 1)) {
+                        for (const auto& chars : CHAR_SETS) {
+                            CheckKernel(p_rContext, std::wstring_view(str).find_first_of(chars, pos),
+                                        StringUtils::FindFirstOf(str, chars, pos),
+                                        level, L"FindFirstOf(chars)", str, pos);
+                        }
+                        for (const auto& charClass : GetTestCharClasses()) {
+                            CheckKernel(p_rContext, ReferenceFindFirstInClass(str, charClass, pos),
+                                        StringUtils::FindFirstOf(str, charClass.m_CharClass, pos),
+                                        level, L"FindFirstOf(CharClass)", str, pos);
+                        }
+                    }
+                }
+            }
+        }
+
+        //
+        // Checks that both overloads of StringUtils::ReplaceAll give the same
+        // results as the original implementation, and that StringUtils::Searcher
+        // finds the same instances as std::wstring_view::find from any position.
+        //
+        // @param p_rContext Test context.
+        //
+        void TestStringUtilsReplaceAll(TestContext& p_rContext)
+        {
+            WStringV vStrings = TestPaths::EdgeCases();
+            const WStringV vCorpus = TestPaths::MakeCorpus(200);
+            vStrings.insert(vStrings.end(), vCorpus.cbegin(), vCorpus.cend());
+            vStrings.emplace_back(L"aaaaa");
+            vStrings.emplace_back(L"\\\\\\");
+            vStrings.emplace_back(L"\u015C\u4E5C\\\u015C\u4E5C\u4E5C");
+            vStrings.emplace_back(MakeCJKText(1000, L"\u4F1A\u8B70", 50));
+
+            for (const auto& replaceAllCase : REPLACE_ALL_CASES) {
+                const std::wstring oldValue(replaceAllCase.first);
+                const std::wstring newValue(replaceAllCase.second);
+                const StringUtils::Searcher searcher(oldValue);
+                for (const auto& str : vStrings) {
+                    std::wstring expected(str);
+                    OriginalReplaceAll(expected, oldValue, newValue);
+                    std::wstring actual(str);
+                    StringUtils::ReplaceAll(actual, oldValue, newValue);
+                    std::wstring actualWithSearcher(str);
+                    StringUtils::ReplaceAll(actualWithSearcher, searcher, newValue);
+                    if (actual != expected || actualWithSearcher != expected) {
+                        const std::wstring what = L"ReplaceAll of " + TestPaths::Describe(oldValue) + L" in " + TestPaths::Describe(str);
+                        p_rContext.CheckEqual(TestPaths::Describe(expected), TestPaths::Describe(actual), what);
+                        p_rContext.CheckEqual(TestPaths::Describe(expected), TestPaths::Describe(actualWithSearcher), what + L" with Searcher");
+                    } else {
+                        p_rContext.Check(true, L"ReplaceAll");
+                    }
+
+                    for (size_t pos = 0; pos <= str.size(); ++pos) {
+                        const size_t expectedPos = std::wstring_view(str).find(oldValue, pos);
+                        const size_t actualPos = searcher.Find(str, pos);
+                        if (expectedPos != actualPos) {
+                            p_rContext.CheckEqual(expectedPos, actualPos, L"Searcher::Find in " + TestPaths::Describe(str) + L" for "
+                                                                          + TestPaths::Describe(oldValue) + L" from " + std::to_wstring(pos));
+                        } else {
+                            p_rContext.Check(true, L"Searcher::Find");
+                        }
+                    }
+                }
+            }
+        }
+
+        //
+        // Measures the throughput of StringUtils::ReplaceChar and
+        // StringUtils::FindFirstOf on a corpus of deep paths, for each
+        // instruction set supported by the processor.
+        //
+        // @param p_rContext Test context.
+        //
+        void BenchmarkStringUtilsKernels(TestContext& p_rContext)
+        {
+            const WStringV vPaths = TestPaths::MakeCorpus(1000);
+            const StringUtils::CharClass rfc3986Chars(GetControlChars() + L" \"#%<>?[\\]^`{|}", true);
+
+            for (const SimdLevel level : SIMD_LEVELS) {
+                const SimdLevelLimiter limiter(level);
+                if (StringUtils::GetSimdLevel() != level) {
+                    continue;
+                }
+                const std::wstring levelName(GetSimdLevelName(level));
+
+                WStringV vResults(vPaths);
+                p_rContext.Measure(L"ReplaceChar / " + levelName, vPaths.size(), [&]() {
+                    for (auto& path : vResults) {
+                        StringUtils::ReplaceChar(path, L'\\', L'/');
+                        StringUtils::ReplaceChar(path, L'/', L'\\');
+                    }
+                });
+
+                size_t numFound = 0;
+                p_rContext.Measure(L"FindFirstOf(chars) / " + levelName, vPaths.size(), [&]() {
+                    for (const auto& path : vPaths) {
+                        for (size_t pos = StringUtils::FindFirstOf(path, L"\\/");
+                             pos != std::wstring_view::npos;
+                             pos = StringUtils::FindFirstOf(path, L"\\/", pos + 1)) {
+                            ++numFound;
+                        }
+                    }
+                });
+                p_rContext.Measure(L"FindFirstOf(CharClass) / " + levelName, vPaths.size(), [&]() {
+                    for (const auto& path : vPaths) {
+                        for (size_t pos = StringUtils::FindFirstOf(path, rfc3986Chars);
+                             pos != std::wstring_view::npos;
+                             pos = StringUtils::FindFirstOf(path, rfc3986Chars, pos + 1)) {
+                            ++numFound;
+                        }
+                    }
+                });
+            }
+        }
+
+        //
+        // Measures StringUtils::ReplaceAll, with and without a Searcher, against
+        // the original implementation. Also compares StringUtils::Searcher with
+        // a searcher using a full 64K-entry shift table, both to search and to
+        // construct, since a searcher is constructed for each find/replace element.
+        //
+        // @param p_rContext Test context.
+        //
+        void BenchmarkStringUtilsReplaceAll(TestContext& p_rContext)
+        {
+            struct ReplaceAllBenchmark {
+                const wchar_t*  m_pCase;        // Name of benchmark case.
+                WStringV        m_vStrings;     // Strings to modify.
+                std::wstring    m_OldValue;     // Value to replace.
+                std::wstring    m_NewValue;     // Replacement value.
+            };
+            const WStringV vPaths = TestPaths::MakeCorpus(1000);
+            std::wstring text;
+            for (const auto& path : vPaths) {
+                text += path;
+                text += L"\r\n";
+            }
+            const ReplaceAllBenchmark benchmarks[] = {
+                { L"Paths, folder", vPaths, L"\\Program Files\\", L"\\PF\\" },
+                { L"Paths, no match", vPaths, L"\\No Such Folder\\", L"\\" },
+                { L"Paths, separator", vPaths, L"\\", L"/" },
+                { L"Paths, CJK folder", vPaths, L"\u4F1A\u8B70\u8CC7\u6599", L"Meetings" },
+                { L"Text, folder", { text }, L"Folder with spaces", L"F" },
+                { L"Text, separator", { text }, L"\\", L"\\\\" },
+                { L"CJK text, CJK pattern", { MakeCJKText(text.size(), L"\u4F1A\u8B70\u8CC7\u6599\u4E00\u4E8C", 500) },
+                  L"\u4F1A\u8B70\u8CC7\u6599\u4E00\u4E8C", L"Meetings" },
+            };
+
+            for (const auto& benchmark : benchmarks) {
+                const std::wstring name(benchmark.m_pCase);
+                const size_t numStrings = benchmark.m_vStrings.size();
+                WStringV vResults;
+                p_rContext.Measure(name + L" / original ReplaceAll", numStrings, [&]() {
+                    vResults = benchmark.m_vStrings;
+                    for (auto& str : vResults) {
+                        OriginalReplaceAll(str, benchmark.m_OldValue, benchmark.m_NewValue);
+                    }
+                });
+                p_rContext.Measure(name + L" / ReplaceAll", numStrings, [&]() {
+                    vResults = benchmark.m_vStrings;
+                    for (auto& str : vResults) {
+                        StringUtils::ReplaceAll(str, benchmark.m_OldValue, benchmark.m_NewValue);
+                    }
+                });
+                const StringUtils::Searcher searcher(benchmark.m_OldValue);
+                p_rContext.Measure(name + L" / ReplaceAll with Searcher", numStrings, [&]() {
+                    vResults = benchmark.m_vStrings;
+                    for (auto& str : vResults) {
+                        StringUtils::ReplaceAll(str, searcher, benchmark.m_NewValue);
+                    }
+                });
+
+                size_t numMatches = 0;
+                p_rContext.Measure(name + L" / find", numStrings, [&]() {
+                    for (const auto& str : benchmark.m_vStrings) {
+                        for (size_t pos = str.find(benchmark.m_OldValue); pos != std::wstring::npos;
+                             pos = str.find(benchmark.m_OldValue, pos + benchmark.m_OldValue.size())) {
+                            ++numMatches;
+                        }
+                    }
+                });
+                p_rContext.Measure(name + L" / Searcher::Find, 256 shifts", numStrings, [&]() {
+                    for (const auto& str : benchmark.m_vStrings) {
+                        numMatches += CountMatches(searcher, str);
+                    }
+                });
+                const FullTableSearcher fullTableSearcher(benchmark.m_OldValue);
+                p_rContext.Measure(name + L" / Searcher::Find, 64K shifts", numStrings, [&]() {
+                    for (const auto& str : benchmark.m_vStrings) {
+                        numMatches += CountMatches(fullTableSearcher, str);
+                    }
+                });
+            }
+
+            // Construction is paid once per find/replace element, each time a pipeline is decoded.
+            const std::wstring pattern(L"\\Program Files\\");
+            size_t numConstructed = 0;
+            p_rContext.Measure(L"Searcher construction / 256 shifts", 1, [&]() {
+                const StringUtils::Searcher searcher(pattern);
+                numConstructed += searcher.Pattern().size();
+            });
+            p_rContext.Measure(L"Searcher construction / 64K shifts", 1, [&]() {
+                const FullTableSearcher searcher(pattern);
+                numConstructed += searcher.Pattern().size();
+            });
+        }
+
+    } // namespace Tests
+
+} // namespace PCC
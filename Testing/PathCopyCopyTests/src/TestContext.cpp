@@ -0,0 +1,166 @@
+// TestContext.cpp
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdafx.h>
+#include <TestContext.h>
+
+#include <chrono>
+#include <iomanip>
+
+
+namespace
+{
+    // Maximum number of failure messages recorded for a test. Other failures are only counted.
+    constexpr size_t    MAX_FAILURE_MESSAGES    = 20;
+
+    // Minimum time during which code is run when measured.
+    constexpr auto      MIN_MEASURE_TIME        = std::chrono::milliseconds(250);
+
+    //
+    // Escapes control characters in a message so that each
+    // message fits on one line of a report.
+    //
+    // @param p_Message Message to escape.
+    // @return Escaped message.
+    //
+    std::wstring EscapeMessage(const std::wstring_view p_Message)
+    {
+        std::wostringstream wos;
+        for (const wchar_t c : p_Message) {
+            if (c < L' ' || c == L'\x7F' || c == L'\x2028' || c == L'\x2029') {
+                wos << L"\\x" << std::hex << std::setw(4) << std::setfill(L'0')
+                    << static_cast<unsigned int>(c) << std::dec;
+            } else {
+                wos << c;
+            }
+        }
+        return wos.str();
+    }
+
+} // anonymous namespace
+
+namespace PCC
+{
+    namespace Tests
+    {
+        //
+        // Constructor.
+        //
+        // @param p_Name Name of test or benchmark using this context.
+        //
+        TestContext::TestContext(const std::wstring_view p_Name)
+            : m_Name(p_Name),
+              m_NumChecks(0),
+              m_NumFailures(0),
+              m_Output()
+        {
+        }
+
+        //
+        // Performs a check. If the check fails, it is recorded
+        // with its description.
+        //
+        // @param p_Condition Condition to check.
+        // @param p_What Description of the check.
+        // @return Value of p_Condition.
+        //
+        bool TestContext::Check(const bool p_Condition,
+                                const std::wstring_view p_What)
+        {
+            ++m_NumChecks;
+            if (!p_Condition && ++m_NumFailures <= MAX_FAILURE_MESSAGES) {
+                m_Output += L'\t';
+                m_Output += EscapeMessage(p_What);
+                m_Output += L'\n';
+            }
+            return p_Condition;
+        }
+
+        //
+        // Measures the throughput of some code. The code is run once to warm
+        // up caches, then repeatedly until enough time has elapsed to get a
+        // stable measure. A line is then recorded with the benchmark's name,
+        // the case measured, the number of runs, the number of items
+        // processed per second and the average time spent per item.
+        //
+        // @param p_Case Description of the case measured.
+        // @param p_ItemsPerRun Number of items processed each time code is run.
+        // @param p_Run Code to measure.
+        //
+        void TestContext::Measure(const std::wstring_view p_Case,
+                                  const size_t p_ItemsPerRun,
+                                  const std::function<void()>& p_Run)
+        {
+            p_Run();
+
+            size_t runs = 0;
+            const auto start = std::chrono::steady_clock::now();
+            std::chrono::steady_clock::duration elapsed {};
+            do {
+                p_Run();
+                ++runs;
+                elapsed = std::chrono::steady_clock::now() - start;
+            } while (elapsed < MIN_MEASURE_TIME);
+
+            const double seconds = std::chrono::duration<double>(elapsed).count();
+            const double items = static_cast<double>(runs) * static_cast<double>(p_ItemsPerRun);
+            std::wostringstream wos;
+            wos << m_Name << L'\t' << p_Case << L'\t' << runs << L'\t'
+                << std::fixed << std::setprecision(0) << (items / seconds) << L'\t'
+                << std::setprecision(1) << (seconds * 1e9 / items) << std::endl;
+            m_Output += wos.str();
+        }
+
+        //
+        // Returns the number of checks performed so far.
+        //
+        // @return Number of checks.
+        //
+        size_t TestContext::GetNumChecks() const noexcept
+        {
+            return m_NumChecks;
+        }
+
+        //
+        // Returns the number of checks that failed so far.
+        //
+        // @return Number of failed checks.
+        //
+        size_t TestContext::GetNumFailures() const noexcept
+        {
+            return m_NumFailures;
+        }
+
+        //
+        // Returns the output recorded so far. For tests, this contains
+        // a line for each failed check, prefixed with a tab. For benchmarks,
+        // this contains a line for each measure, with values separated by tabs.
+        //
+        // @return Recorded output.
+        //
+        const std::wstring& TestContext::GetOutput() const noexcept
+        {
+            return m_Output;
+        }
+
+    } // namespace Tests
+
+} // namespace PCC
@@ -0,0 +1,209 @@
+// TestPaths.cpp
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdafx.h>
+#include <TestPaths.h>
+
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+
+namespace
+{
+    // Roots used for paths in a corpus.
+    const wchar_t* const    CORPUS_ROOTS[] = {
+        L"C:\\",
+        L"D:\\",
+        L"C:\\Users\\jdoe\\",
+        L"\\\\fileserver\\Shared Documents\\",
+        L"\\\\?\\C:\\",
+    };
+
+    // Folder names used for paths in a corpus.
+    const wchar_t* const    CORPUS_FOLDERS[] = {
+        L"Program Files",
+        L"Program Files (x86)",
+        L"Windows",
+        L"System32",
+        L"Users",
+        L"AppData",
+        L"Local",
+        L"Documents",
+        L"Projects",
+        L"src",
+        L"node_modules",
+        L"@babel",
+        L"build",
+        L"x64",
+        L"Release",
+        L".git",
+        L"obj",
+        L"Backup 2021.03",
+        L"Folder with spaces",
+        L"R&D",
+        L"100% done",
+        L"Documents partag\u00E9s",
+        L"R\u00E9sum\u00E9s \u00E9t\u00E9",
+        L"\u4F1A\u8B70\u8CC7\u6599",
+        L"\u0414\u043E\u043A\u0443\u043C\u0435\u043D\u0442\u044B",
+        L"PROGRA~1",
+    };
+
+    // File names used for paths in a corpus.
+    const wchar_t* const    CORPUS_FILES[] = {
+        L"readme.md",
+        L"index.js",
+        L"Report Q3.docx",
+        L"archive.tar.gz",
+        L"Makefile",
+        L".gitignore",
+        L"photo_0001.JPG",
+        L"budget (final) v2.xlsx",
+        L"notes.",
+        L"\u8B70\u4E8B\u9332.txt",
+        L"setup.exe",
+    };
+
+} // anonymous namespace
+
+namespace PCC
+{
+    namespace Tests
+    {
+        //
+        // Produces a corpus of realistic paths. Paths use a mix of drive
+        // and UNC roots and contain between 2 and 15 folders, with names
+        // that include spaces, dots, special characters and non-ASCII
+        // characters. Paths are random but the same seed always produces
+        // the same paths.
+        //
+        // @param p_NumPaths Number of paths to produce.
+        // @param p_Seed Seed used to produce paths.
+        // @return Paths in corpus.
+        //
+        WStringV TestPaths::MakeCorpus(const size_t p_NumPaths,
+                                       const uint32_t p_Seed /*= 42*/)
+        {
+            std::mt19937 generator(p_Seed);
+            const auto pick = [&](const auto& p_Values) {
+                return p_Values[generator() % std::size(p_Values)];
+            };
+
+            WStringV vPaths;
+            vPaths.reserve(p_NumPaths);
+            for (size_t i = 0; i < p_NumPaths; ++i) {
+                std::wstring path(pick(CORPUS_ROOTS));
+                const size_t numFolders = 2 + (generator() % 14);
+                for (size_t j = 0; j < numFolders; ++j) {
+                    path += pick(CORPUS_FOLDERS);
+                    path += L'\\';
+                }
+                path += pick(CORPUS_FILES);
+                vPaths.emplace_back(std::move(path));
+            }
+            return vPaths;
+        }
+
+        //
+        // Returns paths that are edge cases for code parsing paths:
+        // empty paths, roots, paths without separators, paths with
+        // forward slashes or trailing separators, dotfiles, line
+        // terminators, surrogate pairs, etc.
+        //
+        // @return Edge case paths.
+        //
+        const WStringV& TestPaths::EdgeCases()
+        {
+            static const WStringV s_vEdgeCases = {
+                L"",
+                L"C:",
+                L"C:\\",
+                L"C:/",
+                L"C:file.txt",
+                L"c:\\file.txt",
+                L"\\",
+                L"\\\\",
+                L"\\\\server",
+                L"\\\\server\\share",
+                L"\\\\server\\share\\",
+                L"\\\\server\\share\\folder\\file.txt",
+                L"\\\\?\\C:\\folder\\file.txt",
+                L"\\\\?\\UNC\\server\\share\\file.txt",
+                L"file",
+                L"file.txt",
+                L".gitignore",
+                L"C:\\folder\\.gitignore",
+                L"C:\\folder\\.config\\settings",
+                L"C:\\folder.d\\file",
+                L"C:\\folder\\file.",
+                L"C:\\folder\\file..txt",
+                L"C:\\folder\\file.tar.gz",
+                L"C:\\folder\\",
+                L"C:\\folder\\\\file.txt",
+                L"C:/folder/file.txt",
+                L"C:\\folder/sub\\file.txt",
+                L"C:\\folder\\file.txt\\",
+                L"C:\\Program Files\\App\\app.exe",
+                L"C:\\folder\\line\nbreak.txt",
+                L"C:\\folder\\line\r\nbreak.txt",
+                L"C:\\folder\nsub\\file.txt",
+                L"C:\\folder\\file.txt\n",
+                L"C:\\folder\\sep\u2028arator.txt",
+                L"C:\\folder\\sep\u2029arator.txt",
+                L"C:\\folder\\\u00E9t\u00E9.txt",
+                L"C:\\folder\\\U0001F600.txt",
+                L"C:\\folder\\\xD83D.txt",
+                L"C:\\%FILES%\\file.txt",
+                L"%FILES%",
+                L"%files%",
+                L"%FILES",
+                L"%%FILES%%",
+            };
+            return s_vEdgeCases;
+        }
+
+        //
+        // Returns a printable representation of a string, for use in failure
+        // messages. Non-ASCII and control characters are escaped.
+        //
+        // @param p_String String to describe.
+        // @return Printable string.
+        //
+        std::wstring TestPaths::Describe(const std::wstring_view p_String)
+        {
+            std::wostringstream wos;
+            wos << L'"';
+            for (const wchar_t c : p_String) {
+                if (c >= L' ' && c < L'\x7F') {
+                    wos << c;
+                } else {
+                    wos << L"\\x" << std::hex << std::setw(4) << std::setfill(L'0')
+                        << static_cast<unsigned int>(c) << std::dec;
+                }
+            }
+            wos << L'"';
+            return wos.str();
+        }
+
+    } // namespace Tests
+
+} // namespace PCC
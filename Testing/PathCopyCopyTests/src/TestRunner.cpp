@@ -0,0 +1,165 @@
+// TestRunner.cpp
+// (c) 2011-2021, Charles Lechasseur
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdafx.h>
+#include <TestRunner.h>
+#include <TestContext.h>
+#include <FileSystemTests.h>
+#include <NetworkShareIndexTests.h>
+#include <PipelineElementTests.h>
+#include <PipelineTests.h>
+#include <RegexBackendTests.h>
+#include <ScannerTests.h>
+#include <StringUtilsTests.h>
+
+#include <sstream>
+
+
+namespace
+{
+    // Function implementing a test or benchmark.
+    typedef void (*TestFunc)(PCC::Tests::TestContext&);
+
+    // Info about a test or benchmark.
+    struct TestInfo {
+        const wchar_t*  m_pName;        // Name of test or benchmark, used to filter them.
+        TestFunc        m_pFunc;        // Function implementing test or benchmark.
+    };
+
+    // List of all self-tests.
+    const TestInfo      TESTS[] = {
+        { L"Elements.MultiFindReplace",     &PCC::Tests::TestElementsMultiFindReplace },
+        { L"Elements.NormalizePath",        &PCC::Tests::TestElementsNormalizePath },
+        { L"Elements.PrefixMap",            &PCC::Tests::TestElementsPrefixMap },
+        { L"FileSystem.Cached",             &PCC::Tests::TestFileSystemCached },
+        { L"FileSystem.PluginUtils",        &PCC::Tests::TestFileSystemPluginUtils },
+        { L"NetworkShareIndex.Find",        &PCC::Tests::TestNetworkShareIndexFind },
+        { L"Pipeline.GetPaths",             &PCC::Tests::TestPipelineGetPaths },
+        { L"Pipeline.Optimizer",            &PCC::Tests::TestPipelineOptimizer },
+        { L"Pipeline.Verification",         &PCC::Tests::TestPipelineVerification },
+        { L"Pipeline.Inlining",             &PCC::Tests::TestPipelineInlining },
+        { L"Pipeline.PrefixMapFile",        &PCC::Tests::TestPipelinePrefixMapFile },
+        { L"Pipeline.PathViewCache",        &PCC::Tests::TestPipelinePathViewCache },
+        { L"PipelinePlugin.Options",        &PCC::Tests::TestPipelinePluginOptions },
+        { L"Regex.BackendSearch",           &PCC::Tests::TestRegexBackendSearch },
+        { L"Scanners.FilesPlaceholder",     &PCC::Tests::TestScannersFilesPlaceholder },
+        { L"Scanners.HiddenDriveShare",     &PCC::Tests::TestScannersHiddenDriveShare },
+        { L"Scanners.RemoveFileExt",        &PCC::Tests::TestScannersRemoveFileExt },
+        { L"StringUtils.Kernels",           &PCC::Tests::TestStringUtilsKernels },
+        { L"StringUtils.ReplaceAll",        &PCC::Tests::TestStringUtilsReplaceAll },
+    };
+
+    // List of all benchmarks.
+    const TestInfo      BENCHMARKS[] = {
+        { L"Elements.NormalizePath",        &PCC::Tests::BenchmarkElementsNormalizePath },
+        { L"Pipeline.GetPaths",             &PCC::Tests::BenchmarkPipelineGetPaths },
+        { L"StringUtils.Kernels",           &PCC::Tests::BenchmarkStringUtilsKernels },
+        { L"StringUtils.ReplaceAll",        &PCC::Tests::BenchmarkStringUtilsReplaceAll },
+    };
+
+    //
+    // Checks if a test or benchmark should be run.
+    //
+    // @param p_Info Info about test or benchmark.
+    // @param p_Filter Filter specifying which tests to run: only those
+    //                 whose name starts with this are run. Empty to run all.
+    // @return true if test or benchmark should be run.
+    //
+    bool ShouldRun(const TestInfo& p_Info,
+                   const std::wstring_view p_Filter)
+    {
+        return std::wstring_view(p_Info.m_pName).substr(0, p_Filter.size()) == p_Filter;
+    }
+
+} // anonymous namespace
+
+namespace PCC
+{
+    namespace Tests
+    {
+        //
+        // Runs self-tests and returns a report of their results. The report
+        // contains a header line followed by one line per test, with values
+        // separated by tabs. Each failed check of a test is reported on its
+        // own line following the test's line, prefixed with a tab.
+        //
+        // A test that throws an exception is considered to have failed.
+        //
+        // @param p_Filter Only tests whose name starts with this are run.
+        //                 Pass an empty string to run all tests.
+        // @param p_rNumFailedTests Where to store the number of tests that failed.
+        // @return Tests report.
+        //
+        std::wstring TestRunner::RunTests(const std::wstring_view p_Filter,
+                                          size_t& p_rNumFailedTests)
+        {
+            p_rNumFailedTests = 0;
+            std::wostringstream wos;
+            wos << L"Test\tResult\tChecks\tFailures" << std::endl;
+            for (const auto& info : TESTS) {
+                if (ShouldRun(info, p_Filter)) {
+                    TestContext context(info.m_pName);
+                    try {
+                        info.m_pFunc(context);
+                    } catch (const std::exception& e) {
+                        context.Check(false, std::wstring(L"Exception thrown: ") + ATL::CStringW(e.what()).GetString());
+                    }
+
+                    const bool failed = context.GetNumFailures() != 0;
+                    if (failed) {
+                        ++p_rNumFailedTests;
+                    }
+                    wos << info.m_pName << L'\t'
+                        << (failed ? L"FAIL" : L"PASS") << L'\t'
+                        << context.GetNumChecks() << L'\t'
+                        << context.GetNumFailures() << std::endl
+                        << context.GetOutput();
+                }
+            }
+            return wos.str();
+        }
+
+        //
+        // Runs benchmarks and returns a report of their results. The report
+        // contains a header line followed by one line per case measured by
+        // benchmarks, with values separated by tabs. See TestContext::Measure.
+        //
+        // @param p_Filter Only benchmarks whose name starts with this are run.
+        //                 Pass an empty string to run all benchmarks.
+        // @return Benchmarks report.
+        //
+        std::wstring TestRunner::RunBenchmarks(const std::wstring_view p_Filter)
+        {
+            std::wostringstream wos;
+            wos << L"Benchmark\tCase\tRuns\tItemsPerSecond\tNanosecondsPerItem" << std::endl;
+            for (const auto& info : BENCHMARKS) {
+                if (ShouldRun(info, p_Filter)) {
+                    TestContext context(info.m_pName);
+                    info.m_pFunc(context);
+                    wos << context.GetOutput();
+                }
+            }
+            return wos.str();
+        }
+
+    } // namespace Tests
+
+} // namespace PCC